@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "dlog.h"
+#include "rm_sched.h"
+
+/***************************** Important Notes *********************************
+ * 1) tasks.cpp picks TASK1_PRIORITY and PERIODIC_TASK_PRIORITY by hand. Here
+ * the periodic tasks only say how often they run, by when each job must be
+ * done and how long it may take, and common/rm_sched.h gives them rate
+ * monotonic priorities: the shorter the deadline, the higher.
+ *
+ * 2) Each task is admitted by xRmTaskCreate() only if all deadlines can still
+ * be met. "Control", "Sensor" and "Logger" use 20% of the CPU each, budget
+ * over period, printed as 600000 ppm once all three are in. Logger's 15 ms
+ * deadline is shorter than its 20 ms period, so from then on admission is
+ * decided by the response time analysis, not the utilisation bound: Logger
+ * finishes within 8 ms. "Bulk" takes the utilisation to 900000 ppm, and its
+ * jobs still finish within 35 ms of a 40 ms deadline. "Extra" would take it
+ * to 1200000 ppm, more than the core, and is refused.
+ *
+ * 3) The jobs burn CPU for a fixed time, and every main_SENSOR_SPIKE_EVERY th
+ * job of "Sensor" runs past its budget. The fault hook logs each budget
+ * overrun and deadline miss as it happens; the reporters print the per task
+ * counts (rm lines) and release lateness (jit lines) every second.
+ *
+ * 4) Budgets are measured exactly only with run time stats, so this example
+ * is always built with them (Ch3_tasks/CMakeLists.txt). Without them a job
+ * preempted by one above it counts the preemption too (note 4 in
+ * rm_sched.h), and "Bulk" would flag overruns on almost every job.
+ *
+ * 5) The admission test assumes nothing runs above the periodic tasks, but
+ * the reporters normally do, and their USB printf() every second would eat
+ * into Bulk's 5 ms of slack. This example is built with
+ * EXAMPLE_REPORTER_PRIORITY=1, below rmBASE_PRIORITY, so they print in the
+ * 10% of the CPU the tasks leave, as does the dlog task.
+ *******************************************************************************/
+
+#define main_SENSOR_SPIKE_EVERY     100
+
+typedef struct
+{
+    uint32_t ulWorkUs;
+    uint32_t ulSpikeUs;         /* Every main_SENSOR_SPIKE_EVERY th job, 0 for none */
+    uint32_t ulJobs;
+} Job_t;
+
+static Job_t xControlJob = { 600, 0, 0 };
+static Job_t xSensorJob = { 1500, 2500, 0 };
+static Job_t xLoggerJob = { 3000, 0, 0 };
+static Job_t xBulkJob = { 10000, 0, 0 };
+static Job_t xExtraJob = { 3000, 0, 0 };
+
+static RmTask_t xControl, xSensor, xLogger, xBulk, xExtra;
+
+/* Busy, not blocked: the job holds the CPU the whole time, like real work */
+static void prvBurnUs( uint32_t ulUs )
+{
+    const uint64_t ullEnd = time_us_64() + ulUs;
+
+    while( time_us_64() < ullEnd )
+    {
+        tight_loop_contents();
+    }
+}
+
+static void prvJob(void *pvParameters)
+{
+    Job_t *job = (Job_t*)pvParameters;
+
+    job->ulJobs++;
+    if (job->ulSpikeUs != 0 && (job->ulJobs % main_SENSOR_SPIKE_EVERY) == 0)
+    {
+        prvBurnUs(job->ulSpikeUs);
+    }
+    else
+    {
+        prvBurnUs(job->ulWorkUs);
+    }
+}
+
+/* In the faulty task, right after its job */
+static void prvFaultHook(RmTask_t *task, RmFault_t fault, uint32_t us)
+{
+    if (fault == eRmDeadlineMiss)
+    {
+        DLOG("%s missed its deadline, done %u us after release\n", pcRmTaskGetName(task), us);
+    }
+    else
+    {
+        DLOG("%s overran its budget, ran %u us\n", pcRmTaskGetName(task), us);
+    }
+}
+
+static void prvCreate(RmTask_t *task, const RmTaskParams_t *params)
+{
+    if (xRmTaskCreate(task, params) == pdPASS)
+    {
+        printf("%s admitted at priority %u, utilisation now %u ppm\r\n", params->pcName,
+               (unsigned)uxRmTaskGetPriority(task), (unsigned)ulRmGetUtilisationPpm());
+    }
+    else
+    {
+        printf("%s refused, the set would miss deadlines\r\n", params->pcName);
+    }
+}
+
+int main()
+{
+    stdio_init_all();
+    while(!stdio_usb_connected()){tight_loop_contents();}
+
+    sleep_ms(1000);
+
+    /*                name       job   parameters    stack                     period              deadline            budget  hook */
+    RmTaskParams_t control = { "Control", prvJob, &xControlJob, configMINIMAL_STACK_SIZE, pdMS_TO_TICKS(5),  0,                  1000,  prvFaultHook };
+    RmTaskParams_t sensor  = { "Sensor",  prvJob, &xSensorJob,  configMINIMAL_STACK_SIZE, pdMS_TO_TICKS(10), 0,                  2000,  prvFaultHook };
+    RmTaskParams_t logger  = { "Logger",  prvJob, &xLoggerJob,  configMINIMAL_STACK_SIZE, pdMS_TO_TICKS(20), pdMS_TO_TICKS(15),  4000,  prvFaultHook };
+    RmTaskParams_t bulk    = { "Bulk",    prvJob, &xBulkJob,    configMINIMAL_STACK_SIZE, pdMS_TO_TICKS(40), 0,                  12000, prvFaultHook };
+    RmTaskParams_t extra   = { "Extra",   prvJob, &xExtraJob,   configMINIMAL_STACK_SIZE, pdMS_TO_TICKS(10), 0,                  3000,  prvFaultHook };
+
+    /* In any order, the priorities are rearranged as tasks are added */
+    prvCreate(&xLogger, &logger);
+    prvCreate(&xControl, &control);
+    prvCreate(&xSensor, &sensor);
+    prvCreate(&xBulk, &bulk);
+    prvCreate(&xExtra, &extra);
+
+    vRmStartReporter(pdMS_TO_TICKS(1000));
+    vPeriodicTaskStartReporter(pdMS_TO_TICKS(1000));
+    vDlogStartTask(tskIDLE_PRIORITY + 1, NULL);
+
+    vTaskStartScheduler();
+
+    /* As always, this line should not be reached. */
+    for( ;; );
+}
@@ -3,6 +3,9 @@
 #include <task.h>
 #include "pico/stdlib.h"
 #include "pico/cyw43_arch.h"
+#include "dlog.h"
+#include "static_alloc.h"
+#include "periodic_task.h"
 
 /***************************** Important Notes *********************************
  * 1) When a task goes into the block state, the scheduler will select the next 
@@ -16,6 +19,17 @@
  * vTaskDelay() may not be fixed [the task may take a different path through the 
  * code between calls, or may get interrupted or preempted a different number of 
  * times each time it executes]. 
+ *
+ * 3) The tasks log with DLOG() (common/dlog.h) instead of printf(). Task1 and
+ * Task2 never block, so their output is only limited by how often the dlog
+ * task, sharing their priority, gets to empty the ring; the rest is dropped
+ * and counted.
+ *
+ * 4) vperiodicTask's loop is a PeriodicTask_t (common/periodic_task.h): the
+ * same vTaskDelayUntil(), with how late each wake is against the 5 ms grid
+ * and how often an iteration overran it. Every second the reporter prints
+ * the min/mean/p99/max lateness and a histogram, so the effect of Task1 and
+ * Task2, interrupts and the logging on the loop shows up as numbers.
  *******************************************************************************/
 
 #define TASK1_PRIORITY          1
@@ -40,7 +54,7 @@ void vTask1(void *pvParameters)
     prev_wakeTime = xTaskGetTickCount();
     while(1)
     {
-        printf("%s", textParam);
+        DLOG("%s", textParam);
         // vTaskDelay(delay250ms); // Don't use
         // vTaskDelayUntil( &prev_wakeTime, pdMS_TO_TICKS(250) );
     }
@@ -53,20 +67,22 @@ void vTask2(void *pvParameters)
     prev_wakeTime = xTaskGetTickCount();
     while(1)
     {
-        printf("%s", textParam);
+        DLOG("%s", textParam);
         // vTaskDelayUntil( &prev_wakeTime, pdMS_TO_TICKS(250) );
     }
 }
 
 void vperiodicTask(void *pvParameters)
 {
-    TickType_t prev_wakeTime;
+    PeriodicTask_t loop;
     char *textParam = (char*)pvParameters;
-    prev_wakeTime = xTaskGetTickCount();
+
+    /* In place of prev_wakeTime = xTaskGetTickCount() */
+    vPeriodicTaskInit( &loop, pdMS_TO_TICKS(5) );
     while(1)
     {
-        printf("%s", textParam);
-        vTaskDelayUntil( &prev_wakeTime, pdMS_TO_TICKS(5) );
+        DLOG("%s", textParam);
+        vPeriodicTaskWait( &loop ); // vTaskDelayUntil(), timed
     }
 }
 
@@ -74,12 +90,14 @@ int main()
 {
     stdio_init_all();
 
-    xTaskCreate(vTask1, "TASK 1", configMINIMAL_STACK_SIZE,
+    xExampleTaskCreate(vTask1, "TASK 1", configMINIMAL_STACK_SIZE,
                 (void*)pcTextforTask1, TASK1_PRIORITY, NULL);
-    xTaskCreate(vTask2, "TASK 2", configMINIMAL_STACK_SIZE,
+    xExampleTaskCreate(vTask2, "TASK 2", configMINIMAL_STACK_SIZE,
                 (void*)pcTextforTask2, TASK2_PRIORITY, NULL);
-    xTaskCreate(vperiodicTask, "periodicTask", configMINIMAL_STACK_SIZE,
+    xExampleTaskCreate(vperiodicTask, "periodicTask", configMINIMAL_STACK_SIZE,
                 (void*)pcTextforPerodicTask, PERIODIC_TASK_PRIORITY, NULL);
+    vDlogStartTask(tskIDLE_PRIORITY + 1, NULL);
+    vPeriodicTaskStartReporter(pdMS_TO_TICKS(1000));
        
     vTaskStartScheduler();
  /* If all is well then main() will never reach here as the scheduler will
@@ -3,6 +3,9 @@
 #include <queue.h>
 #include "pico/stdlib.h"
 #include "pico/cyw43_arch.h"
+#include "dlog.h"
+#include "core_affinity.h"
+#include "static_alloc.h"
 
 /***************************** Important Notes *********************************
  * 1) Blocking on Queue Reads
@@ -36,6 +39,11 @@
  * priority task that is waiting for space. If the blocked tasks have equal 
  * priority, then the task that has been waiting for space the longest will be 
  * unblocked.
+ *
+ * 3) In preemtive_queuing_smp the senders run on core 0 and the receiver on
+ * core 1. The receiver no longer has to wait for both senders to block before
+ * it runs, so "Queue should have been full!" is printed: the priorities only
+ * order tasks that share a core.
  *******************************************************************************/
 
 
@@ -70,7 +78,7 @@ void transmitTask(void *parameter)
 
         if (status == pdFAIL)
         {
-            printf("Task 1 could not add to queue\r\n");
+            DLOG("Task 1 could not add to queue\r\n");
         }
     }
 }
@@ -84,38 +92,46 @@ void receiveTask(void *parameter)
     {
         if (uxQueueMessagesWaiting(queue) != 5)
         {
-            printf("Queue should have been full!\r\n");
+            DLOG("Queue should have been full!\r\n");
         }
         status = xQueueReceive(queue, &rx, 0);
         if (status == pdPASS)
         {
             if (rx.source == sender1)
             {
-                printf("From sender1: %d\r\n", rx.value);
+                DLOG("From sender1: %d\r\n", rx.value);
             }
             else if (rx.source == sender2)
             {
-                printf("From sender2: %d\r\n", rx.value);
+                DLOG("From sender2: %d\r\n", rx.value);
             }
         }
         else {
-            printf("Could not receive from queuer\r\n");
+            DLOG("Could not receive from queuer\r\n");
         }
     }
 }
 
 int main()
 {
-    queue = xQueueCreate(5, sizeof(data_t));
+    queue = xExampleQueueCreate(5, sizeof(data_t));
 
     stdio_init_all();
 
-    xTaskCreate(transmitTask, "Transmit1", configMINIMAL_STACK_SIZE, 
-                &(dataToSend[0]),SEND_TASK_PRIORITY, NULL);
-    xTaskCreate(transmitTask, "Transmit2", configMINIMAL_STACK_SIZE, 
-                &(dataToSend[1]), SEND_TASK_PRIORITY, NULL);    
-    xTaskCreate(receiveTask, "ReceiveTask", configMINIMAL_STACK_SIZE, 
-                NULL, RECEIVE_TASK_PRIORITY, NULL);
+    TaskHandle_t xTransmit1, xTransmit2, xReceive;
+
+    xExampleTaskCreate(transmitTask, "Transmit1", configMINIMAL_STACK_SIZE, 
+                &(dataToSend[0]),SEND_TASK_PRIORITY, &xTransmit1);
+    xExampleTaskCreate(transmitTask, "Transmit2", configMINIMAL_STACK_SIZE, 
+                &(dataToSend[1]), SEND_TASK_PRIORITY, &xTransmit2);    
+    xExampleTaskCreate(receiveTask, "ReceiveTask", configMINIMAL_STACK_SIZE, 
+                NULL, RECEIVE_TASK_PRIORITY, &xReceive);
+
+    /* Producers and consumer on opposite cores (only in the _smp variant) */
+    vPinTaskToCore(xTransmit1, 0);
+    vPinTaskToCore(xTransmit2, 0);
+    vPinTaskToCore(xReceive, 1);
+    vDlogStartTask(tskIDLE_PRIORITY + 1, NULL);
 
     vTaskStartScheduler();
 
@@ -0,0 +1,196 @@
+#include <stdlib.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "batch_queue.h"
+#include "bench_time.h"
+#include "static_alloc.h"
+
+/***************************** Important Notes *********************************
+ * 1) Moves ITEMS_PER_RUN data_t items (the struct from preemtive_queuing.cpp)
+ * from a producer to a consumer task, once through a queue one item per call
+ * and once through a batch queue (common/batch_queue.h) a whole queue length
+ * per call, for each queue length in ulQueueLengths[]. It prints items/second
+ * for each as CSV.
+ *
+ * 2) The consumer has the higher priority, so with the per-item path every
+ * xQueueSendToBack() wakes it and switches to it straight away: one context
+ * switch pair per item. With the batch path the consumer is woken once per
+ * batch and takes everything that is waiting.
+ *
+ * 3) Item n carries the value n % queue length in both paths, so the consumer
+ * can check that nothing was lost or reordered; the count of bad items is the
+ * last CSV column and should be 0.
+ *******************************************************************************/
+
+#define ITEMS_PER_RUN               100000
+#define MAX_QUEUE_LENGTH            1024
+#define CONTROL_TASK_PRIORITY       3
+#define CONSUMER_TASK_PRIORITY      2
+#define PRODUCER_TASK_PRIORITY      1
+
+typedef enum {
+    sender1,
+    sender2
+} dataSource_t;
+
+typedef struct {
+    uint8_t value;
+    dataSource_t source;
+} data_t;
+
+typedef enum {
+    pathPerItem,
+    pathBatch,
+    pathCount
+} path_t;
+
+static const char *pcPathNames[ pathCount ] = { "per_item", "batch" };
+static const uint32_t ulQueueLengths[] = { 5, 64, MAX_QUEUE_LENGTH };
+
+/* Set up by prvControlTask() before each run */
+static volatile path_t xPath;
+static volatile uint32_t ulQueueLength;
+static QueueHandle_t xQueue;
+static BatchQueue_t *pxBatchQueue;
+static volatile uint32_t ulBadItems;
+
+static data_t xProducerItems[ MAX_QUEUE_LENGTH ];
+static data_t xConsumerItems[ MAX_QUEUE_LENGTH ];
+
+static TaskHandle_t xControlTask;
+static TaskHandle_t xProducerTask;
+static TaskHandle_t xConsumerTask;
+
+static void prvProducerTask( void *pvParameters )
+{
+    uint32_t ulSent, ulIndex, ulCount;
+
+    for( ;; )
+    {
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        for( ulSent = 0; ulSent < ITEMS_PER_RUN; )
+        {
+            ulIndex = ulSent % ulQueueLength;
+            if( xPath == pathPerItem )
+            {
+                xQueueSendToBack( xQueue, &xProducerItems[ ulIndex ], portMAX_DELAY );
+                ulSent++;
+            }
+            else
+            {
+                /* Up to the end of xProducerItems[], so item n is always xProducerItems[ n % length ] */
+                ulCount = ulQueueLength - ulIndex;
+                if( ulCount > ITEMS_PER_RUN - ulSent )
+                {
+                    ulCount = ITEMS_PER_RUN - ulSent;
+                }
+                ulSent += ulBatchQueueSend( pxBatchQueue, &xProducerItems[ ulIndex ], ulCount, portMAX_DELAY );
+            }
+        }
+    }
+}
+
+static void prvConsumerTask( void *pvParameters )
+{
+    uint32_t ulReceived, ulCount;
+
+    for( ;; )
+    {
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        ulBadItems = 0;
+
+        for( ulReceived = 0; ulReceived < ITEMS_PER_RUN; )
+        {
+            if( xPath == pathPerItem )
+            {
+                xQueueReceive( xQueue, &xConsumerItems[ 0 ], portMAX_DELAY );
+                ulCount = 1;
+            }
+            else
+            {
+                ulCount = ulBatchQueueReceive( pxBatchQueue, xConsumerItems, ulQueueLength, portMAX_DELAY );
+            }
+
+            for( uint32_t i = 0; i < ulCount; i++ )
+            {
+                if( xConsumerItems[ i ].value != ( uint8_t ) ( ( ulReceived + i ) % ulQueueLength ) )
+                {
+                    ulBadItems++;
+                }
+            }
+            ulReceived += ulCount;
+        }
+
+        xTaskNotifyGive( xControlTask );
+    }
+}
+
+static void prvControlTask( void *pvParameters )
+{
+    uint64_t ullStartNs, ullElapsedNs;
+
+    printf( "path,queue_length,items,elapsed_us,items_per_s,bad_items\r\n" );
+
+    for( uint32_t ulLength = 0; ulLength < sizeof( ulQueueLengths ) / sizeof( ulQueueLengths[ 0 ] ); ulLength++ )
+    {
+        ulQueueLength = ulQueueLengths[ ulLength ];
+        /* Sized at run time, so from the heap even with static allocation */
+        xQueue = xQueueCreate( ulQueueLength, sizeof( data_t ) );
+        pxBatchQueue = pxBatchQueueCreate( ulQueueLength, sizeof( data_t ) );
+        configASSERT( ( xQueue != NULL ) && ( pxBatchQueue != NULL ) );
+
+        for( int iPath = 0; iPath < pathCount; iPath++ )
+        {
+            xPath = ( path_t ) iPath;
+
+            ullStartNs = ullBenchTimeNs();
+            /* Consumer first, so it is already blocked on the empty queue */
+            xTaskNotifyGive( xConsumerTask );
+            xTaskNotifyGive( xProducerTask );
+            ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+            ullElapsedNs = ullBenchTimeNs() - ullStartNs;
+
+            printf( "%s,%lu,%lu,%llu,%llu,%lu\r\n", pcPathNames[ iPath ], ( unsigned long ) ulQueueLength,
+                    ( unsigned long ) ITEMS_PER_RUN, ( unsigned long long ) ( ullElapsedNs / 1000 ),
+                    ( unsigned long long ) ( ( uint64_t ) ITEMS_PER_RUN * 1000000000ull / ullElapsedNs ),
+                    ( unsigned long ) ulBadItems );
+        }
+
+        vQueueDelete( xQueue );
+        vBatchQueueDelete( pxBatchQueue );
+    }
+
+    printf( "done\r\n" );
+#if HOST_POSIX_BUILD
+    exit( EXIT_SUCCESS );
+#endif
+    vTaskDelete( NULL );
+}
+
+int main()
+{
+    stdio_init_all();
+    while(!stdio_usb_connected()){tight_loop_contents();}
+
+    sleep_ms(1000);
+    printf("Queue batching benchmark\r\n");
+
+    for( uint32_t i = 0; i < MAX_QUEUE_LENGTH; i++ )
+    {
+        xProducerItems[ i ].value = ( uint8_t ) i;
+        xProducerItems[ i ].source = sender1;
+    }
+
+    xExampleTaskCreate( prvConsumerTask, "Consumer", configMINIMAL_STACK_SIZE, NULL, CONSUMER_TASK_PRIORITY, &xConsumerTask );
+    xExampleTaskCreate( prvProducerTask, "Producer", configMINIMAL_STACK_SIZE, NULL, PRODUCER_TASK_PRIORITY, &xProducerTask );
+    xExampleTaskCreate( prvControlTask, "Control", configMINIMAL_STACK_SIZE, NULL, CONTROL_TASK_PRIORITY, &xControlTask );
+
+    vTaskStartScheduler();
+
+    /* As normal, the following line should never be reached. */
+    for( ;; );
+}
@@ -3,6 +3,9 @@
 #include <queue.h>
 #include "pico/stdlib.h"
 #include "pico/cyw43_arch.h"
+#include "msg_pool.h"
+#include "core_affinity.h"
+#include "static_alloc.h"
 
 /***************************** Important Notes *********************************
  * 1) Notice how queue functions will always work with the address of the data 
@@ -11,22 +14,45 @@
  * 
  * In this case, notice how strings to queues are sent by sending the address of 
  * the pointer that points to the buffer a.k.a a pointer to a pointer
+ *
+ * 2) The buffers come from a fixed-block message pool (common/msg_pool.h)
+ * instead of pvPortMalloc()/vPortFree() per message. Every buffer is either in
+ * the queue, being filled by the sender or being printed by the receiver, so
+ * QUEUE_LENGTH + 2 blocks are enough for the pool to never run dry; the
+ * receiver prints the high-water mark to show it.
  *******************************************************************************/
 
+#define QUEUE_LENGTH        5
+#define MAX_STRING_LENGTH   50
+#define POOL_BLOCKS         ( QUEUE_LENGTH + 2 )
+#define STATS_EVERY         1000
+
 QueueHandle_t xPointerQueue;
 
+static msgpoolDEFINE_STORAGE( xStringStorage, MAX_STRING_LENGTH, POOL_BLOCKS );
+static MsgPool_t xStringPool;
+
 void sendingTask(void *pvParameter)
 {
     char *pcStringToSend;
-    const size_t xMaxStringLength = 50;
     BaseType_t xStringNumber = 0;
     while(1)
     {
-        pcStringToSend = (char*)pvPortMalloc(sizeof(char)*xMaxStringLength);
-        sprintf(pcStringToSend, "Sending #%d message via pointer\r\n", xStringNumber);
+        pcStringToSend = (char*)pvMsgPoolAlloc(&xStringPool);
+        if(pcStringToSend == NULL)
+        {
+            /* Counted by the pool, try again once the receiver caught up */
+            vTaskDelay(1);
+            continue;
+        }
+        snprintf(pcStringToSend, MAX_STRING_LENGTH, "Sending #%d message via pointer\r\n", (int)xStringNumber);
         xStringNumber++;
         /* Send the address of the pointer that points to the buffer */
-        xQueueSend(xPointerQueue, &pcStringToSend, 0); 
+        if(xQueueSend(xPointerQueue, &pcStringToSend, 0) != pdPASS)
+        {
+            /* Nobody else will ever see this buffer */
+            vMsgPoolRelease(&xStringPool, pcStringToSend);
+        }
     }
 
 }
@@ -34,24 +60,41 @@ void sendingTask(void *pvParameter)
 void receiveTask(void *pvParameter)
 {
     char *pvReceivedString = NULL;
+    uint32_t ulReceived = 0;
+    MsgPoolStats_t xStats;
     while(1)
     {
         /* Store the buffer’s address in pcReceivedString. */
         xQueueReceive(xPointerQueue, &pvReceivedString, portMAX_DELAY);
         printf("%s", pvReceivedString);
-        vPortFree(pvReceivedString); // Dont forget to free!
+        vMsgPoolRelease(&xStringPool, pvReceivedString); // Dont forget to release!
+
+        if(++ulReceived % STATS_EVERY == 0)
+        {
+            vMsgPoolGetStats(&xStringPool, &xStats);
+            printf("pool: %lu/%lu in use, high-water %lu, alloc failures %lu\r\n",
+                   (unsigned long)xStats.ulInUse, (unsigned long)xStats.ulBlockCount,
+                   (unsigned long)xStats.ulHighWaterMark, (unsigned long)xStats.ulAllocFailures);
+        }
     }
 }
 
 int main(void)
 {
-    xPointerQueue = xQueueCreate(5, sizeof(char *));
+    xPointerQueue = xExampleQueueCreate(QUEUE_LENGTH, sizeof(char *));
+    vMsgPoolInit(&xStringPool, xStringStorage, MAX_STRING_LENGTH, POOL_BLOCKS);
     stdio_init_all();
 
-    xTaskCreate(sendingTask, "Transmit1", configMINIMAL_STACK_SIZE, 
-                NULL, 1, NULL);
-    xTaskCreate(receiveTask, "ReceiveTask", configMINIMAL_STACK_SIZE, 
-                NULL, 2, NULL);
+    TaskHandle_t xSender, xReceiver;
+
+    xExampleTaskCreate(sendingTask, "Transmit1", configMINIMAL_STACK_SIZE, 
+                NULL, 1, &xSender);
+    xExampleTaskCreate(receiveTask, "ReceiveTask", configMINIMAL_STACK_SIZE, 
+                NULL, 2, &xReceiver);
+
+    /* Producer and consumer on opposite cores (only in the _smp variant) */
+    vPinTaskToCore(xSender, 0);
+    vPinTaskToCore(xReceiver, 1);
 
     vTaskStartScheduler();
 
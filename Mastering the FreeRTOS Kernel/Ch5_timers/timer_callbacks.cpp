@@ -3,6 +3,8 @@
 #include <timers.h>
 #include "pico/stdlib.h"
 #include "pico/cyw43_arch.h"
+#include "dlog.h"
+#include "static_alloc.h"
 
 // #define UNIQUE_CALLBACK_EXAMPLE
 #define SINGLE_CALLBACK_TIMERID_EXAMPLE
@@ -55,18 +57,19 @@ void prvTimerCallback(TimerHandle_t currTimer)
 
     /* A count of the number of times this software timer has expired is 
     stored in the timer's ID. Obtain the ID, increment it, then save it as
-    the new ID value. The ID is a void pointer, so is cast to a uint32_t. */
-    ctr = (uint32_t)pvTimerGetTimerID(currTimer);
-    vTimerSetTimerID(currTimer, (void*)(++ctr));
+    the new ID value. The ID is a void pointer, so is cast to a uint32_t
+    (through uintptr_t, as pointers are 64 bits wide on the host build). */
+    ctr = (uint32_t)(uintptr_t)pvTimerGetTimerID(currTimer);
+    vTimerSetTimerID(currTimer, (void*)(uintptr_t)(++ctr));
 
     timeNow = xTaskGetTickCount();
 
     if (currTimer == oneShot_timer)
     {
-        printf("One-shot timer callback executing: %u\n", timeNow);
+        DLOG("One-shot timer callback executing: %u\n", timeNow);
     }
     else {
-        printf("Auto-reload timer callback executing: %u\n", timeNow);
+        DLOG("Auto-reload timer callback executing: %u\n", timeNow);
 
         if (ctr++ == 5)
         {
@@ -84,14 +87,14 @@ void pvOneShotTimerCallback(TimerHandle_t xTimer)
 {
     TickType_t timeNow;
     timeNow = xTaskGetTickCount();
-    printf("One-shot timer callback executing: %u\n", timeNow);
+    DLOG("One-shot timer callback executing: %u\n", timeNow);
 }
 
 void pvAutoReloadTimerCallback(TimerHandle_t xTimer)
 {
     TickType_t timeNow;
     timeNow = xTaskGetTickCount();
-    printf("Auto-reload timer callback executing: %u\n", timeNow);
+    DLOG("Auto-reload timer callback executing: %u\n", timeNow);
 }
 #endif
 
@@ -101,7 +104,7 @@ int main (void)
     while(!stdio_usb_connected()){tight_loop_contents();}
 
 #ifdef SINGLE_CALLBACK_TIMERID_EXAMPLE
-    oneShot_timer = xTimerCreate(
+    oneShot_timer = xExampleTimerCreate(
         "OneShot",
         main_ONESHOT_TIMER_PERIOD,
         pdFALSE,
@@ -109,7 +112,7 @@ int main (void)
         prvTimerCallback
     );
 
-    autoReload_timer = xTimerCreate(
+    autoReload_timer = xExampleTimerCreate(
         "autoReload",
         main_RELOAD_TIMER_PERIOD,
         pdTRUE,
@@ -119,7 +122,7 @@ int main (void)
 #endif
 
 #ifdef UNIQUE_CALLBACK_EXAMPLE
-    oneShot_timer = xTimerCreate(
+    oneShot_timer = xExampleTimerCreate(
         "OneShot",
         main_ONESHOT_TIMER_PERIOD,
         pdFALSE,
@@ -127,7 +130,7 @@ int main (void)
         pvOneShotTimerCallback
     );
 
-    autoReload_timer = xTimerCreate(
+    autoReload_timer = xExampleTimerCreate(
         "autoReload",
         main_RELOAD_TIMER_PERIOD,
         pdTRUE,
@@ -146,6 +149,7 @@ int main (void)
 
         if ( timer1Started == pdPASS && timer2Started == pdPASS )
         {
+            vDlogStartTask(tskIDLE_PRIORITY + 1, NULL);
             vTaskStartScheduler();
         }
 
@@ -0,0 +1,89 @@
+#include <FreeRTOS.h>
+#include <task.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "dlog.h"
+#include "timer_wheel.h"
+
+/***************************** Important Notes *********************************
+ * 1) timer_callbacks.cpp with more periodic timers: main_PERIODIC_TIMERS
+ * auto-reload timers with periods a little apart, as for a handful of sensors
+ * polled about twice a second. As FreeRTOS software timers each expiry wakes
+ * the daemon task on its own tick, and that task runs at
+ * configTIMER_TASK_PRIORITY, above everything else.
+ *
+ * 2) Here they run on common/timer_wheel.h, each with a slack of
+ * main_SLACK_MS: a timer may expire that much late, which lets the wheel move
+ * expiries whose windows overlap onto the same tick. Their callbacks then
+ * share one wake of the wheel's service task (see note 5 in timer_wheel.h).
+ * Set main_SLACK_MS to 0 to see every timer wake it on its own.
+ *
+ * 3) As in timer_callbacks.cpp each timer counts its expiries in its ID. The
+ * report timer has no slack and every main_REPORT_PERIOD logs the ticks that
+ * had callbacks against the callbacks run, i.e. the wakes saved, and for each
+ * periodic timer the worst lateness seen against its slack.
+ *******************************************************************************/
+
+#define main_PERIODIC_TIMERS    6
+#define main_SLACK_MS           50
+#define main_REPORT_PERIOD      pdMS_TO_TICKS(5000)
+
+static const uint32_t ulPeriodsMs[ main_PERIODIC_TIMERS ] = { 500, 530, 570, 610, 650, 700 };
+
+static WheelTimer_t xPeriodicTimers[ main_PERIODIC_TIMERS ];
+static WheelTimer_t xReportTimer;
+
+static void prvPeriodicCallback(WheelTimerHandle_t currTimer)
+{
+    uint32_t ctr;
+
+    /* The number of expiries is kept in the timer's ID, as in
+    timer_callbacks.cpp. Nothing is logged here, that would be a wake of its
+    own for the dlog task every time. */
+    ctr = (uint32_t)(uintptr_t)pvWheelTimerGetTimerID(currTimer);
+    vWheelTimerSetTimerID(currTimer, (void*)(uintptr_t)(++ctr));
+}
+
+static void prvReportCallback(WheelTimerHandle_t currTimer)
+{
+    TimerWheelStats_t stats;
+
+    vTimerWheelGetStats(&stats);
+    DLOG("%u callbacks on %u ticks: %u wakes saved, %u moved by the slack\n",
+         stats.ulExpired, stats.ulExpiryTicks, stats.ulWakesSaved, stats.ulDeferred);
+
+    for (int i = 0; i < main_PERIODIC_TIMERS; i++)
+    {
+        DLOG("Timer %d (%u ms): %u expiries, max %u ticks late\n", i, ulPeriodsMs[i],
+             (uint32_t)(uintptr_t)pvWheelTimerGetTimerID(&xPeriodicTimers[i]),
+             xWheelTimerGetMaxLateness(&xPeriodicTimers[i]));
+    }
+    DLOG("Slack %u ticks, service task woken %u times\n", pdMS_TO_TICKS(main_SLACK_MS), stats.ulServiceWakes);
+}
+
+int main (void)
+{
+    stdio_init_all();
+    while(!stdio_usb_connected()){tight_loop_contents();}
+
+    /* Where the daemon task would be */
+    vTimerWheelStart(configTIMER_TASK_PRIORITY);
+
+    for (int i = 0; i < main_PERIODIC_TIMERS; i++)
+    {
+        xWheelTimerInit(&xPeriodicTimers[i], pdMS_TO_TICKS(ulPeriodsMs[i]), pdTRUE,
+                        0,  // Initialize timerID as 0
+                        prvPeriodicCallback);
+        vWheelTimerSetSlack(&xPeriodicTimers[i], pdMS_TO_TICKS(main_SLACK_MS));
+        xWheelTimerStart(&xPeriodicTimers[i]);
+    }
+
+    xWheelTimerInit(&xReportTimer, main_REPORT_PERIOD, pdTRUE, NULL, prvReportCallback);
+    xWheelTimerStart(&xReportTimer);
+
+    vDlogStartTask(tskIDLE_PRIORITY + 1, NULL);
+    vTaskStartScheduler();
+
+    /* As always, this line should not be reached. */
+    for( ;; );
+}
@@ -5,6 +5,9 @@
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "pico/cyw43_arch.h"
+#include "deferral_stats.h"
+#include "isr_log.h"
+#include "static_alloc.h"
 
 /***************************** Important Notes *********************************
  * 1) FreeRTOS API functions perform actions that are not valid inside an 
@@ -61,11 +64,13 @@ void gpio_callback(uint gpio, uint32_t events)
     context switch is required. */
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-    printf("ISR triggered\r\n");
+    /* Never printf() from an ISR, see common/isr_log.h */
+    vIsrLogFromISR("ISR triggered\r\n", 0, 0);
 
     // event is an enum gpio_irq_level
     if (gpio == GPIO_PIN)
     {
+        vDeferralStatsRaisedFromISR();
 
         /* 'Give' the semaphore to unblock the task, passing in the address of
         xHigherPriorityTaskWoken as the interrupt safe API function's
@@ -73,7 +78,8 @@ void gpio_callback(uint gpio, uint32_t events)
         
         See NOTE 3
         */
-        xSemaphoreGiveFromISR(binarySemaphore, &xHigherPriorityTaskWoken);
+        vDeferralStatsDeferredFromISR(
+            xSemaphoreGiveFromISR(binarySemaphore, &xHigherPriorityTaskWoken) );
 
         /* Pass the xHigherPriorityTaskWoken value into portYIELD_FROM_ISR().  If
         xHigherPriorityTaskWoken was set to pdTRUE inside xSemaphoreGiveFromISR()
@@ -98,6 +104,7 @@ void gpio_triggered_task(void *TaskParam)
         /* To get here the event must have occurred.  Process the event (in this
         Case, just print out a message). */
         printf( "Handler task - Processing event.\r\n" );
+        vDeferralStatsHandled( 1 );
     }
 }
 
@@ -113,7 +120,7 @@ int main()
 
     /* Before a semaphore is used it must be explicitly created.  In this example
     a binary semaphore is created. */
-    binarySemaphore = xSemaphoreCreateBinary();
+    binarySemaphore = xExampleSemaphoreCreateBinary();
     /* Check the semaphore was created successfully. */
     if (binarySemaphore != NULL)
     {
@@ -122,7 +129,13 @@ int main()
         the interrupt.  The handler task is created with a high priority to ensure
         it runs immediately after the interrupt exits.  In this case a priority of
         3 is chosen. */
-        xTaskCreate(gpio_triggered_task, "Handler", configMINIMAL_STACK_SIZE, NULL, 3, NULL );
+        xExampleTaskCreate(gpio_triggered_task, "Handler", configMINIMAL_STACK_SIZE, NULL, 3, NULL );
+
+        /* Print how many events are raised, dropped and handled each second. */
+        vDeferralStatsStartReporter( pdMS_TO_TICKS( 1000 ) );
+
+        /* Print the messages queued by the ISR from a low priority task. */
+        vIsrLogStartTask( tskIDLE_PRIORITY + 1 );
 
         /* Start the scheduler so the created tasks start executing. */
         vTaskStartScheduler();
@@ -5,6 +5,9 @@
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "pico/cyw43_arch.h"
+#include "deferral_stats.h"
+#include "isr_log.h"
+#include "static_alloc.h"
 
 /***************************** Important Notes *********************************
  * 1) Just as binary semaphores can be thought of as queues that have a 
@@ -42,7 +45,8 @@ void gpio_callback(uint gpio, uint32_t events)
     context switch is required. */
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-    printf("ISR triggered\r\n");
+    /* Never printf() from an ISR, see common/isr_log.h */
+    vIsrLogFromISR("ISR triggered\r\n", 0, 0);
 
     // event is an enum gpio_irq_level
     if (gpio == GPIO_PIN)
@@ -53,12 +57,19 @@ void gpio_callback(uint gpio, uint32_t events)
         semaphore latches the events to allow the task to which interrupts are deferred
         to process them in turn, without events getting lost. This simulates multiple
         interrupts being received by the processor, even though in this case the events
-        are simulated within a single interrupt occurrence. */
-        xSemaphoreGiveFromISR(countingSemaphore, &xHigherPriorityTaskWoken);
+        are simulated within a single interrupt occurrence. Each 'give' counts as
+        one event in the deferral stats. */
+        vDeferralStatsRaisedFromISR();
+        vDeferralStatsDeferredFromISR(
+            xSemaphoreGiveFromISR(countingSemaphore, &xHigherPriorityTaskWoken) );
         asm volatile("nop \n nop \n nop");
-        xSemaphoreGiveFromISR(countingSemaphore, &xHigherPriorityTaskWoken);
+        vDeferralStatsRaisedFromISR();
+        vDeferralStatsDeferredFromISR(
+            xSemaphoreGiveFromISR(countingSemaphore, &xHigherPriorityTaskWoken) );
         asm volatile("nop \n nop \n nop");
-        xSemaphoreGiveFromISR(countingSemaphore, &xHigherPriorityTaskWoken);
+        vDeferralStatsRaisedFromISR();
+        vDeferralStatsDeferredFromISR(
+            xSemaphoreGiveFromISR(countingSemaphore, &xHigherPriorityTaskWoken) );
 
         /* Pass the xHigherPriorityTaskWoken value into portYIELD_FROM_ISR().  If
         xHigherPriorityTaskWoken was set to pdTRUE inside xSemaphoreGiveFromISR()
@@ -83,6 +94,7 @@ void gpio_triggered_task(void *TaskParam)
         /* To get here the event must have occurred.  Process the event (in this
         Case, just print out a message). */
         printf( "Handler task - Processing event.\r\n" );
+        vDeferralStatsHandled( 1 );
     }
 }
 
@@ -99,7 +111,7 @@ int main()
     /* Before a semaphore is used it must be explicitly created. In this example a
     counting semaphore is created. The semaphore is created to have a maximum count
     value of 10, and an initial count value of 0. */
-    countingSemaphore = xSemaphoreCreateCounting(10, 0);
+    countingSemaphore = xExampleSemaphoreCreateCounting(10, 0);
     /* Check the semaphore was created successfully. */
     if (countingSemaphore != NULL)
     {
@@ -108,7 +120,13 @@ int main()
         the interrupt.  The handler task is created with a high priority to ensure
         it runs immediately after the interrupt exits.  In this case a priority of
         3 is chosen. */
-        xTaskCreate(gpio_triggered_task, "Handler", configMINIMAL_STACK_SIZE, NULL, 3, NULL );
+        xExampleTaskCreate(gpio_triggered_task, "Handler", configMINIMAL_STACK_SIZE, NULL, 3, NULL );
+
+        /* Print how many events are raised, dropped and handled each second. */
+        vDeferralStatsStartReporter( pdMS_TO_TICKS( 1000 ) );
+
+        /* Print the messages queued by the ISR from a low priority task. */
+        vIsrLogStartTask( tskIDLE_PRIORITY + 1 );
 
         /* Start the scheduler so the created tasks start executing. */
         vTaskStartScheduler();
@@ -5,6 +5,8 @@
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "pico/cyw43_arch.h"
+#include "deferral_stats.h"
+#include "isr_log.h"
 
 /***************************** Important Notes *********************************
  * 1) It is possible to use the xTimerPendFunctionCallFromISR() API function to 
@@ -46,6 +48,7 @@ void vDeferredHandlingFunction( void *pvParameter1, uint32_t ulParameter2 )
     /* Process the event - in this case just print out a message and the value of
     ulParameter2. pvParameter1 is not used in this example. */
     printf("Handler task - Processing event %d\r\n", ulParameter2);
+    vDeferralStatsHandled( 1 );
 }
 
 void gpio_callback(uint gpio, uint32_t events)
@@ -57,21 +60,23 @@ void gpio_callback(uint gpio, uint32_t events)
     context switch is required. */
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-    printf("ISR triggered\r\n");
+    /* Never printf() from an ISR, see common/isr_log.h */
+    vIsrLogFromISR("ISR triggered\r\n", 0, 0);
 
     // event is an enum gpio_irq_level
     if (gpio == GPIO_PIN)
     {
+        vDeferralStatsRaisedFromISR();
 
         /* Send a pointer to the interrupt's deferred handling function to the daemon task.
         The deferred handling function's pvParameter1 parameter is not used so just set to
         NULL. The deferred handling function's ulParameter2 parameter is used to pass a
         number that is incremented by one each time this interrupt handler executes. */
-        xTimerPendFunctionCallFromISR( 
+        vDeferralStatsDeferredFromISR( xTimerPendFunctionCallFromISR( 
         vDeferredHandlingFunction,  /* Function to execute. */
         NULL,                       /* Not used. */
         ulParameterValue,           /* Incrementing value. */
-        &xHigherPriorityTaskWoken );
+        &xHigherPriorityTaskWoken ) );
 
         ulParameterValue++;
 
@@ -94,6 +99,12 @@ int main()
     gpio_pull_up(GPIO_PIN);
     gpio_set_irq_enabled_with_callback(GPIO_PIN, GPIO_IRQ_EDGE_FALL, true, &gpio_callback);
 
+    /* Print how many events are raised, dropped and handled each second. */
+    vDeferralStatsStartReporter( pdMS_TO_TICKS( 1000 ) );
+
+    /* Print the messages queued by the ISR from a low priority task. */
+    vIsrLogStartTask( tskIDLE_PRIORITY + 1 );
+
     /* Start the scheduler so the created tasks start executing. */
     vTaskStartScheduler();
 
@@ -5,6 +5,10 @@
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "pico/cyw43_arch.h"
+#include "deferral_stats.h"
+#include "isr_log.h"
+#include "core_affinity.h"
+#include "static_alloc.h"
 
 /***************************** Important Notes *********************************
  * 1) Binary and counting semaphores are used to communicate events. Queues are 
@@ -76,6 +80,7 @@ void stringFromISR_task(void *pvParameter)
         
         /* Print out the string received */
         printf("%s", rxString);
+        vDeferralStatsHandled( 1 );
     }
 }
 
@@ -100,7 +105,8 @@ void gpio_callback(uint gpio, uint32_t events)
     the call to xQueueReceiveFromISR() and the call to xQueueSendToBackFromISR(). */
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-    printf("ISR triggered\r\n");
+    /* Never printf() from an ISR, see common/isr_log.h */
+    vIsrLogFromISR("ISR triggered\r\n", 0, 0);
 
     // event is an enum gpio_irq_level
     if (gpio == GPIO_PIN)
@@ -110,10 +116,13 @@ void gpio_callback(uint gpio, uint32_t events)
                                     &uReceivedNumber,
                                     &xHigherPriorityTaskWoken) != errQUEUE_EMPTY)
         {
-            printf("%d removed to numQueue\r\n", uReceivedNumber);
-            xQueueSendToBackFromISR(stringQueue,
-                                    &strings[uReceivedNumber],
-                                    &xHigherPriorityTaskWoken );
+            vIsrLogFromISR("%d removed to numQueue\r\n", uReceivedNumber, 0);
+            /* Each string sent on to the task counts as one event in the deferral stats. */
+            vDeferralStatsRaisedFromISR();
+            vDeferralStatsDeferredFromISR(
+                xQueueSendToBackFromISR(stringQueue,
+                                        &strings[uReceivedNumber],
+                                        &xHigherPriorityTaskWoken ) );
         }
         ctr = 0;
     } // if (gpio == GPIO_PIN)
@@ -136,16 +145,29 @@ int main()
     can hold variables of type char*.  Both queues can hold a maximum of 10 items.  A
     real application should check the return values to ensure the queues have been
     successfully created. */
-    intQueue = xQueueCreate( 5, sizeof( uint32_t ) );
-    stringQueue = xQueueCreate( 5, sizeof( char * ) );
+    intQueue = xExampleQueueCreate( 5, sizeof( uint32_t ) );
+    stringQueue = xExampleQueueCreate( 5, sizeof( char * ) );
 
     /* Create the task that uses a queue to pass integers to the interrupt service
     routine.  The task is created at priority 1. */
-    xTaskCreate( periodic_NumToISR_task, "IntGen", configMINIMAL_STACK_SIZE, NULL, 1, NULL );
+    TaskHandle_t xIntGenTask, xStringTask;
+    xExampleTaskCreate( periodic_NumToISR_task, "IntGen", configMINIMAL_STACK_SIZE, NULL, 1, &xIntGenTask );
     
     /* Create the task that prints out the strings sent to it from the interrupt
     service routine.  This task is created at the higher priority of 2. */
-    xTaskCreate( stringFromISR_task, "String", configMINIMAL_STACK_SIZE, NULL, 2, NULL );
+    xExampleTaskCreate( stringFromISR_task, "String", configMINIMAL_STACK_SIZE, NULL, 2, &xStringTask );
+
+    /* In the _smp variant the GPIO interrupt, enabled above from main() on
+    core 0, runs on core 0 like the task feeding it; the task it feeds runs
+    on core 1. */
+    vPinTaskToCore( xIntGenTask, 0 );
+    vPinTaskToCore( xStringTask, 1 );
+
+    /* Print how many events are raised, dropped and handled each second. */
+    vDeferralStatsStartReporter( pdMS_TO_TICKS( 1000 ) );
+
+    /* Print the messages queued by the ISR from a low priority task. */
+    vIsrLogStartTask( tskIDLE_PRIORITY + 1 );
 
     /* Start the scheduler so the created tasks start executing. */
     vTaskStartScheduler();
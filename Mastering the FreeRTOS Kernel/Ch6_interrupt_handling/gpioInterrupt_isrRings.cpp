@@ -0,0 +1,123 @@
+#include <FreeRTOS.h>
+#include <task.h>
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "pico/cyw43_arch.h"
+#include "deferral_stats.h"
+#include "isr_log.h"
+#include "spsc_ring.h"
+#include "static_alloc.h"
+
+/***************************** Important Notes *********************************
+ * 1) The same example as gpioInterrupt_isrQueues.cpp, with both queues
+ * replaced by Ring<T, N> from common/spsc_ring.h. Each path has exactly one
+ * producer and one consumer: periodic_NumToISR_task feeds the ISR, and the ISR
+ * feeds stringFromISR_task. Neither side enters a critical section.
+ *
+ * 2) The ISR never blocks, so it drains xIntRing with xPopFromISR(). The
+ * string task blocks in xPop() on its task notification, which xPushFromISR()
+ * only gives while the task is actually waiting.
+ *
+ * 3) Ring lengths must be a power of two, so both rings hold 8 items where the
+ * queues held 5.
+ *******************************************************************************/
+
+#define GPIO_PIN        9
+#define TX_PERIOD_MS    2500
+
+static Ring< uint32_t, 8 > xIntRing;
+static Ring< const char *, 8 > xStringRing;
+uint32_t ctr = 0;
+
+void periodic_NumToISR_task(void *pvParameter)
+{
+    TickType_t prevTime = xTaskGetTickCount();
+    while(1)
+    {
+        vTaskDelayUntil( &prevTime, pdMS_TO_TICKS(TX_PERIOD_MS) );
+        /* The consumer is the ISR, which never waits, so there is nobody to notify. */
+        if (xIntRing.xPush( ctr ) == pdPASS)
+        {
+            printf("%d added to intRing\r\n", ctr);
+            if (++ctr >= 5){ctr = 0;}
+        }
+    }
+}
+
+void stringFromISR_task(void *pvParameter)
+{
+    const char *rxString;
+    while(1)
+    {
+        /* Block on the ring to wait for data to arrive. */
+        xStringRing.xPop( rxString, portMAX_DELAY );
+
+        /* Print out the string received */
+        printf("%s", rxString);
+        vDeferralStatsHandled( 1 );
+    }
+}
+
+void gpio_callback(uint gpio, uint32_t events)
+{
+    uint32_t uReceivedNumber = 0;
+
+    // Defines an array of pointers to strings
+    static const char *strings[] =
+    {
+        "String0\r\n",
+        "String1\r\n",
+        "String2\r\n",
+        "String3\r\n",
+        "String4\r\n"
+    };
+
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    /* Never printf() from an ISR, see common/isr_log.h */
+    vIsrLogFromISR("ISR triggered\r\n", 0, 0);
+
+    // event is an enum gpio_irq_level
+    if (gpio == GPIO_PIN)
+    {
+        /* Read from the ring until the ring is empty. */
+        while (xIntRing.xPopFromISR( uReceivedNumber ) == pdPASS)
+        {
+            vIsrLogFromISR("%d removed from intRing\r\n", uReceivedNumber, 0);
+            /* Each string sent on to the task counts as one event in the deferral stats. */
+            vDeferralStatsRaisedFromISR();
+            vDeferralStatsDeferredFromISR(
+                xStringRing.xPushFromISR( strings[uReceivedNumber], &xHigherPriorityTaskWoken ) );
+        }
+        ctr = 0;
+    } // if (gpio == GPIO_PIN)
+
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+
+int main()
+{
+    stdio_init_all();
+    while(!stdio_usb_connected()){tight_loop_contents();}
+
+    sleep_ms(1000);
+    printf("ISR Rings Example\r\n");
+    gpio_pull_up(GPIO_PIN);
+    gpio_set_irq_enabled_with_callback(GPIO_PIN, GPIO_IRQ_EDGE_FALL, true, &gpio_callback);
+
+    /* The rings are static objects, there is nothing to create. */
+    xExampleTaskCreate( periodic_NumToISR_task, "IntGen", configMINIMAL_STACK_SIZE, NULL, 1, NULL );
+    xExampleTaskCreate( stringFromISR_task, "String", configMINIMAL_STACK_SIZE, NULL, 2, NULL );
+
+    /* Print how many events are raised, dropped and handled each second. */
+    vDeferralStatsStartReporter( pdMS_TO_TICKS( 1000 ) );
+
+    /* Print the messages queued by the ISR from a low priority task. */
+    vIsrLogStartTask( tskIDLE_PRIORITY + 1 );
+
+    /* Start the scheduler so the created tasks start executing. */
+    vTaskStartScheduler();
+
+    /* As normal, the following line should never be reached. */
+    for( ;; );
+}
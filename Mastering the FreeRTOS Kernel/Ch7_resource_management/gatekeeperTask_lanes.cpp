@@ -0,0 +1,110 @@
+#include <FreeRTOS.h>
+#include <task.h>
+#include <timers.h>
+#include "pico/stdlib.h"
+#include "pico/rand.h"
+#include "pico/cyw43_arch.h"
+#include "core_affinity.h"
+#include "static_alloc.h"
+#include "lane_gatekeeper.h"
+
+/***************************** Important Notes *********************************
+ * 1) gatekeeperTask_printString.cpp with a lane per kind of message in place
+ * of the one queue, see common/lane_gatekeeper.h. There the tick hook's
+ * message is sent to the front of the queue to jump the tasks' messages; here
+ * it goes to the urgent lane, which the gatekeeper always empties first and
+ * flushes straight away. The tick hook is off in this FreeRTOSConfig.h
+ * (configUSE_TICK_HOOK 0), so a 200ms software timer sends it instead.
+ *
+ * 2) The lanes overflow differently:
+ *
+ * urgent - 4 deep, drop oldest: a newer alarm is worth more than an old one.
+ * normal - 5 deep, the print task blocks up to main_NORMAL_BLOCK_MS for room.
+ * bulk   - 8 deep, drop newest: the bulk task sends a burst of
+ *          main_BULK_BURST messages every 100ms, more than the lane holds,
+ *          and loses what doesn't fit without ever waiting.
+ *
+ * 3) Every second the gatekeeper prints a lane line per lane (sent, dropped,
+ * sends that found the lane full, the most messages waiting, and the mean and
+ * max latency from the send to the end of its write to stdout) after the gk
+ * line of the batch writer. The urgent latency stays low while the bulk lane
+ * drops, and the normal and bulk ones include the main_FLUSH_DEADLINE_MS wait
+ * for their batch to go out.
+ *******************************************************************************/
+
+#define main_FLUSH_DEADLINE_MS  20
+#define main_NORMAL_BLOCK_MS    50
+#define main_BULK_BURST         20
+
+static const char *pcUrgentString = "Urgent message from the timer ############################\r\n";
+static const char *pcNormalString = "Task 1 ****************************************************\r\n";
+static const char *pcBulkString   = "Bulk ------------------------------------------------------\r\n";
+
+static void prvUrgentTimerCallback( TimerHandle_t xTimer )
+{
+    xLanePrint( eLaneUrgent, pcUrgentString );
+}
+
+static void prvPrintTask( void *pvParameters )
+{
+    const TickType_t xMaxBlockTimeTicks = 0x20;
+
+    while(1)
+    {
+        xLanePrint( eLaneNormal, pcNormalString );
+        vTaskDelay( ( get_rand_32() % xMaxBlockTimeTicks ) );
+    }
+}
+
+static void prvBulkTask( void *pvParameters )
+{
+    TickType_t xLastWake = xTaskGetTickCount();
+
+    while(1)
+    {
+        for( int i = 0; i < main_BULK_BURST; i++ )
+        {
+            xLanePrint( eLaneBulk, pcBulkString );
+        }
+        xTaskDelayUntil( &xLastWake, pdMS_TO_TICKS( 100 ) );
+    }
+}
+
+int main()
+{
+    stdio_init_all();
+    while(!stdio_usb_connected()){tight_loop_contents();}
+
+    sleep_ms(1000);
+    printf("Lane gatekeeper example\r\n");
+
+    const LaneConfig_t xConfigs[ laneCOUNT ] =
+    {
+        { 4, eLaneDropOldest, 0 },                                  /* eLaneUrgent */
+        { 5, eLaneBlock, pdMS_TO_TICKS( main_NORMAL_BLOCK_MS ) },   /* eLaneNormal */
+        { 8, eLaneDropNewest, 0 }                                   /* eLaneBulk */
+    };
+    TimerHandle_t xUrgentTimer = xExampleTimerCreate( "Urgent", pdMS_TO_TICKS( 200 ), pdTRUE, NULL, prvUrgentTimerCallback );
+
+    if( xUrgentTimer != NULL )
+    {
+        /* As in gatekeeperTask_printString.cpp the gatekeeper is below the
+        tasks that print. */
+        TaskHandle_t xPrint, xBulk, xGatekeeper;
+        xGatekeeper = xLaneGatekeeperStart( xConfigs, 0, pdMS_TO_TICKS( main_FLUSH_DEADLINE_MS ), pdMS_TO_TICKS( 1000 ) );
+        xExampleTaskCreate( prvPrintTask, "Print1", configMINIMAL_STACK_SIZE, NULL, 2, &xPrint );
+        xExampleTaskCreate( prvBulkTask, "Bulk", configMINIMAL_STACK_SIZE, NULL, 1, &xBulk );
+        xTimerStart( xUrgentTimer, 0 );
+
+        /* In gatekeeperTask_lanes_smp the gatekeeper gets core 1 to itself, as
+        in gatekeeperTask_printString_smp. */
+        vPinTaskToCore( xPrint, 0 );
+        vPinTaskToCore( xBulk, 0 );
+        vPinTaskToCore( xGatekeeper, 1 );
+
+        vTaskStartScheduler();
+    }
+
+    /* As normal, the following line should never be reached. */
+    for( ;; );
+}
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include <message_buffer.h>
+#include "pico/stdlib.h"
+#include "pico/rand.h"
+#include "pico/cyw43_arch.h"
+#include "core_affinity.h"
+#include "static_alloc.h"
+#include "batch_writer.h"
+
+/***************************** Important Notes *********************************
+ * 1) gatekeeperTask_printString.cpp with a message buffer in place of the
+ * queue of char pointers. A pointer is only safe to send while the string it
+ * points to stays put, there the static pcStringsToPrint[], and the
+ * gatekeeper has to strlen() each one again. xMessageBufferSend() instead
+ * copies the bytes and their length into the buffer in one call, and
+ * xMessageBufferReceive() hands back both. So the print tasks can format each
+ * line on their own stack (a counter and the tick count here) and reuse that
+ * stack as soon as the send returns.
+ *
+ * 2) A message buffer has no lock of its own and allows one writer at a time:
+ * with two print tasks each send takes xSendMutex. The mutex is held for the
+ * copy into the buffer only, never while the output is written, which stays
+ * the gatekeeper's job.
+ *
+ * 3) A received message must fit the gatekeeper's receive buffer, or it stays
+ * in the message buffer and blocks every one after it, so prvSendToGatekeeper()
+ * cuts lines to main_MAX_MESSAGE_LENGTH. Each message costs its length plus
+ * sizeof( configMESSAGE_BUFFER_LENGTH_TYPE ) bytes in the buffer.
+ *
+ * 4) The output is batched as in gatekeeperTask_printString.cpp, see
+ * common/batch_writer.h. benchmarks/gatekeeper_bench.cpp compares the bytes/s
+ * through this and through the pointer queue.
+ *******************************************************************************/
+
+#define main_MAX_MESSAGE_LENGTH 80
+#define main_BUFFER_SIZE        ( 5 * ( main_MAX_MESSAGE_LENGTH + sizeof( configMESSAGE_BUFFER_LENGTH_TYPE ) ) )
+#define main_FLUSH_DEADLINE_MS  20
+
+static MessageBufferHandle_t xPrintBuffer;
+static SemaphoreHandle_t xSendMutex;
+
+/* A full buffer drops the line, as the queue version does */
+static void prvSendToGatekeeper( const char *pcLine, size_t xLength )
+{
+    if( xLength > main_MAX_MESSAGE_LENGTH )
+    {
+        xLength = main_MAX_MESSAGE_LENGTH;
+    }
+
+    xSemaphoreTake( xSendMutex, portMAX_DELAY );
+    {
+        xMessageBufferSend( xPrintBuffer, pcLine, xLength, 0 );
+    }
+    xSemaphoreGive( xSendMutex );
+}
+
+static void prvStdioGatekeeperTask( void *pvParameters )
+{
+    char cMessage[ main_MAX_MESSAGE_LENGTH ];
+    size_t xLength;
+    TickType_t xBlockTime = portMAX_DELAY;
+
+    /* As in gatekeeperTask_printString.cpp this is the only task that writes
+    to standard out, now with the length of every message known. */
+    while(1)
+    {
+        xLength = xMessageBufferReceive( xPrintBuffer, cMessage, sizeof( cMessage ), xBlockTime );
+        if( xLength > 0 )
+        {
+            vBatchWriterWrite( cMessage, xLength );
+        }
+        xBlockTime = xBatchWriterService();
+    }
+}
+
+static void prvPrintTask( void *pvParameters )
+{
+    const int iTask = ( int ) ( intptr_t ) pvParameters;
+    const TickType_t xMaxBlockTimeTicks = 0x20;
+    char cLine[ main_MAX_MESSAGE_LENGTH ];
+    uint32_t ulCount = 0;
+    int iLength;
+
+    while(1)
+    {
+        /* A different line every time, gone once this loop comes round again */
+        iLength = snprintf( cLine, sizeof( cLine ), "Task %d message %lu at tick %lu %s\r\n", iTask,
+                            ( unsigned long ) ulCount++, ( unsigned long ) xTaskGetTickCount(),
+                            ( iTask == 1 ) ? "****************" : "----------------" );
+        if( iLength > 0 )
+        {
+            prvSendToGatekeeper( cLine, ( ( size_t ) iLength < sizeof( cLine ) ) ? ( size_t ) iLength : sizeof( cLine ) - 1 );
+        }
+
+        vTaskDelay( ( get_rand_32() % xMaxBlockTimeTicks ) );
+    }
+}
+
+int main()
+{
+    stdio_init_all();
+    while(!stdio_usb_connected()){tight_loop_contents();}
+
+    sleep_ms(1000);
+    printf("Message buffer gatekeeper example\r\n");
+
+    xPrintBuffer = xExampleMessageBufferCreate( main_BUFFER_SIZE );
+    xSendMutex = xExampleSemaphoreCreateMutex();
+
+    if( ( xPrintBuffer != NULL ) && ( xSendMutex != NULL ) )
+    {
+        /* The same priorities as gatekeeperTask_printString.cpp: the gatekeeper
+        below both print tasks. */
+        TaskHandle_t xPrint1, xPrint2, xGatekeeper;
+        xExampleTaskCreate( prvPrintTask, "Print1", configMINIMAL_STACK_SIZE, ( void * ) 1, 1, &xPrint1 );
+        xExampleTaskCreate( prvPrintTask, "Print2", configMINIMAL_STACK_SIZE, ( void * ) 2, 2, &xPrint2 );
+        xExampleTaskCreate( prvStdioGatekeeperTask, "Gatekeeper", configMINIMAL_STACK_SIZE, NULL, 0, &xGatekeeper );
+        vBatchWriterStart( 0, pdMS_TO_TICKS( main_FLUSH_DEADLINE_MS ), pdMS_TO_TICKS( 1000 ) );
+
+        vPinTaskToCore( xPrint1, 0 );
+        vPinTaskToCore( xPrint2, 0 );
+        vPinTaskToCore( xGatekeeper, 1 );
+
+        vTaskStartScheduler();
+    }
+
+    /* As normal, the following line should never be reached. */
+    for( ;; );
+}
@@ -6,6 +6,9 @@
 #include "pico/rand.h"
 #include "hardware/gpio.h"
 #include "pico/cyw43_arch.h"
+#include "core_affinity.h"
+#include "static_alloc.h"
+#include "batch_writer.h"
 
 /***************************** Important Notes *********************************
  * 1) Although mutexes are useful, precautions must be taken to avoid several 
@@ -127,10 +130,18 @@
  * In the example below, the gatekeeper task uses a FreeRTOS queue to serialize access 
  * to standard out. The internal implementation of the task does not have to consider 
  * mutual exclusion because it is the only task permitted to access standard out directly.
+ * 
+ * 3) The gatekeeper doesn't putchar() each message a character at a time. It copies
+ * the messages into a buffer (common/batch_writer.h) that goes out in one fwrite(),
+ * from a writer task, once full or main_FLUSH_DEADLINE_MS after its first message,
+ * while the gatekeeper fills a second buffer. Every second a gk line reports the
+ * bytes/s and how many messages each write carried.
 
  * 
  *******************************************************************************/
 
+#define main_FLUSH_DEADLINE_MS  20
+
 SemaphoreHandle_t xMutex;
 QueueHandle_t xPrintQueue;
 
@@ -173,6 +184,7 @@ void vApplicationTickHook( void )
 static void prvStdioGatekeeperTask( void *pvParameters )
 {
     char *pcMessageToPrint;
+    TickType_t xBlockTime = portMAX_DELAY;
     /* This is the only task that is allowed to write to serial. Any other
     task wanting to write a string to the output does not access standard out
     directly, but instead sends the string to this task. As only this task accesses
@@ -180,16 +192,16 @@ static void prvStdioGatekeeperTask( void *pvParameters )
     within the implementation of the task itself. */
     while(1)
     {
-        /* Wait for a message to arrive. An indefinite block time is specified so
-        there is no need to check the return value – the function will only return
-        when a message has been successfully received. */
-        xQueueReceive( xPrintQueue, &pcMessageToPrint, portMAX_DELAY );
-        /* Output the received string. */
-        uint32_t len = strlen(pcMessageToPrint);
-        uint32_t idx = 0;
-        for (idx = 0; idx < len; idx++){
-            putchar(*(pcMessageToPrint+idx));
+        /* Wait for a message to arrive, or for the batch of messages received so
+        far to be due for output. */
+        if( xQueueReceive( xPrintQueue, &pcMessageToPrint, xBlockTime ) == pdPASS )
+        {
+            /* Add the received string to the batch, see note 3. */
+            vBatchWriterWrite( pcMessageToPrint, strlen( pcMessageToPrint ) );
         }
+        /* Write the batch out if its deadline has passed, and wait for the next
+        message no longer than until the next one is due. */
+        xBlockTime = xBatchWriterService();
         /* Loop back to wait for the next message. */
     }
 }
@@ -200,7 +212,7 @@ static void prvPrintTask( void *pvParameters )
     const TickType_t xMaxBlockTimeTicks = 0x20;
     /* Two instances of this task are created. The task parameter is used to pass
     an index into an array of strings into the task. Cast this to the required type. */
-    iIndexToString = ( int ) pvParameters;
+    iIndexToString = ( int ) ( intptr_t ) pvParameters;
     while(1)
     {
         /* Print out the string, not directly, but instead by passing a pointer to
@@ -229,7 +241,7 @@ int main()
 
     /* Before a queue is used it must be explicitly created. The queue is created
     to hold a maximum of 5 character pointers. */
-    xPrintQueue = xQueueCreate( 5, sizeof( char * ) );
+    xPrintQueue = xExampleQueueCreate( 5, sizeof( char * ) );
 
     /* Check the queue was created successfully. */
     if( xPrintQueue != NULL )
@@ -239,8 +251,9 @@ int main()
         parameter (the 4th parameter to xTaskCreate()). The tasks are created at
         different priorities so the higher priority task will occasionally preempt
         the lower priority task. */
-        xTaskCreate( prvPrintTask, "Print1", configMINIMAL_STACK_SIZE, ( void * ) 0, 1, NULL );
-        xTaskCreate( prvPrintTask, "Print2", configMINIMAL_STACK_SIZE, ( void * ) 1, 2, NULL );
+        TaskHandle_t xPrint1, xPrint2, xGatekeeper;
+        xExampleTaskCreate( prvPrintTask, "Print1", configMINIMAL_STACK_SIZE, ( void * ) 0, 1, &xPrint1 );
+        xExampleTaskCreate( prvPrintTask, "Print2", configMINIMAL_STACK_SIZE, ( void * ) 1, 2, &xPrint2 );
 
         /* Create the gatekeeper task. This is the only task that is permitted
         to directly access standard out. 
@@ -251,7 +264,14 @@ int main()
         priority, so messages get processed immediately—but doing so would be at the cost of 
         the gatekeeper delaying lower priority tasks until it has completed accessing the protected 
         resource. */
-        xTaskCreate( prvStdioGatekeeperTask, "Gatekeeper", configMINIMAL_STACK_SIZE, NULL, 0, NULL );
+        xExampleTaskCreate( prvStdioGatekeeperTask, "Gatekeeper", configMINIMAL_STACK_SIZE, NULL, 0, &xGatekeeper );
+        vBatchWriterStart( 0, pdMS_TO_TICKS( main_FLUSH_DEADLINE_MS ), pdMS_TO_TICKS( 1000 ) );
+
+        /* In gatekeeperTask_printString_smp the gatekeeper gets core 1 to itself,
+        so it no longer waits for both print tasks to block. */
+        vPinTaskToCore( xPrint1, 0 );
+        vPinTaskToCore( xPrint2, 0 );
+        vPinTaskToCore( xGatekeeper, 1 );
 
         /* Start the scheduler so the created tasks start executing. */
         vTaskStartScheduler();
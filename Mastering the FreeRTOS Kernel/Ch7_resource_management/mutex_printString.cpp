@@ -5,6 +5,8 @@
 #include "pico/rand.h"
 #include "hardware/gpio.h"
 #include "pico/cyw43_arch.h"
+#include "static_alloc.h"
+#include "mutex_profile.h"
 
 /***************************** Important Notes *********************************
  * 1) A Mutex is a special type of binary semaphore that is used to control 
@@ -29,9 +31,26 @@
  * allow for the competing tasks to corrupt each others data and demonstrate 
  * the usefulness of a mutex. 
  * 
+ * 4) That loop also holds the mutex for one stdio call per character, so by
+ * default (main_PER_CHAR_OUTPUT 0) the string goes out in a single fwrite()
+ * instead and the mutex is held for one call. Set main_PER_CHAR_OUTPUT to 1
+ * for the putchar() loop, to see the corruption with the mutex commented out.
+ * 
+ * 5) The mutex is taken and given through common/mutex_profile.h, which
+ * counts the contended takes and priority inheritances and times every wait
+ * and hold. Every main_PROFILE_PERIOD_MS an mtx line and the two histograms
+ * show how long the print tasks wait for stdout and who held it longest. The
+ * reporter holds xMutex too while it prints, so its lines don't land in the
+ * middle of a task's line. It takes xMutex directly, so its own takes aren't
+ * counted, but a print task waiting for the report is.
+ * 
  *******************************************************************************/
 
+#define main_PER_CHAR_OUTPUT    0
+#define main_PROFILE_PERIOD_MS  1000
+
 SemaphoreHandle_t xMutex;
+static ProfiledMutex_t xProfiledMutex;  /* xMutex with its stats, note 5 */
 
 static void prvNewPrintString( const char *pcString )
 {
@@ -45,7 +64,7 @@ static void prvNewPrintString( const char *pcString )
     check that xSemaphoreTake() returns pdTRUE before accessing the shared resource
     (which in this case is standard out). As noted earlier in this book, indefinite
     time outs are not recommended for production code. */
-    xSemaphoreTake(xMutex, portMAX_DELAY); // Can be commented out to demo corruption
+    xMutexProfileTake(&xProfiledMutex, portMAX_DELAY); // Can be commented out to demo corruption
     {
         /* The following line will only execute once the mutex has been successfully
         obtained. Standard out can be accessed freely now as only one task can have
@@ -58,13 +77,19 @@ static void prvNewPrintString( const char *pcString )
         // printf( "%s", pcString );
 
         uint32_t len = strlen(pcString);
+#if main_PER_CHAR_OUTPUT
         uint32_t idx = 0;
         for (idx = 0; idx < len; idx++){
             putchar(*(pcString+idx));
         }
+#else
+        /* One write, see note 4 */
+        fwrite(pcString, 1, len, stdout);
+        fflush(stdout);
+#endif
         /* The mutex MUST be given back! */
     }
-    xSemaphoreGive( xMutex ); // Can be commented out to demo corruption
+    xMutexProfileGive( &xProfiledMutex ); // Can be commented out to demo corruption
 }
 
 static void prvPrintTask( void *pvParameters )
@@ -99,17 +124,21 @@ int main()
 
     /* Before a semaphore is used it must be explicitly created. In this example a
     mutex type semaphore is created. */
-    xMutex = xSemaphoreCreateMutex();
+    xMutex = xExampleSemaphoreCreateMutex();
     /* Check the semaphore was created successfully before creating the tasks. */
     if (xMutex != NULL )
     {
+        /* All takes and gives of xMutex go through xProfiledMutex from here on */
+        vMutexProfileInit( &xProfiledMutex, xMutex, "stdout" );
+        vMutexProfileStartReporter( pdMS_TO_TICKS( main_PROFILE_PERIOD_MS ), xMutex );
+
         /* Create two instances of the tasks that write to stdout. The string they
         write is passed in to the task as the task’s parameter. The tasks are
         created at different priorities so some preemption will occur. */
-        xTaskCreate( prvPrintTask, "Print1", configMINIMAL_STACK_SIZE,
+        xExampleTaskCreate( prvPrintTask, "Print1", configMINIMAL_STACK_SIZE,
         (char*)"Task 1 ***************************************\r\n", 1, NULL );
 
-        xTaskCreate( prvPrintTask, "Print2", configMINIMAL_STACK_SIZE,
+        xExampleTaskCreate( prvPrintTask, "Print2", configMINIMAL_STACK_SIZE,
         (char*)"Task 2 ---------------------------------------\r\n", 2, NULL );
 
         /* Start the scheduler so the created tasks start executing. */
@@ -4,6 +4,8 @@
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "pico/cyw43_arch.h"
+#include "dlog.h"
+#include "static_alloc.h"
 
 /***************************** Important Notes *********************************
  * 1) Event groups are a feature that allow events to be communicated to tasks.
@@ -32,7 +34,7 @@ EventGroupHandle_t xEventGroup;
 
 void vDeferredHandlingFunction( void *pvParameter, uint32_t ulParameter2 )
 {
-    printf("%s", pvParameter);
+    DLOG("%s", pvParameter);
 }
 
 static void gpio_callback(uint gpio, uint32_t events)
@@ -79,7 +81,7 @@ static void vEventBitSettingTask( void *pvParameters )
 
         /* Print out a message to say event bit 0 is about to be set by the task,
         then set event bit 0. */
-        printf( "Bit setting task -\t about to set bit 0.\r\n" );
+        DLOG( "Bit setting task -\t about to set bit 0.\r\n" );
 
         xEventGroupSetBits( xEventGroup, mainFIRST_TASK_BIT );
 
@@ -88,7 +90,7 @@ static void vEventBitSettingTask( void *pvParameters )
         
         /* Print out a message to say event bit 1 is about to be set by the task,
         then set event bit 1. */
-        printf( "Bit setting task -\t about to set bit 1.\r\n" );
+        DLOG( "Bit setting task -\t about to set bit 1.\r\n" );
         xEventGroupSetBits( xEventGroup, mainSECOND_TASK_BIT );
     }
 }
@@ -117,15 +119,15 @@ static void vEventBitReadingTask( void *pvParameters )
         /* Print a message for each bit that was set. */
         if ((xEventGroupValue & mainFIRST_TASK_BIT) != 0)
         {
-            printf( "Bit reading task -\t Event bit 0 was set\r\n");
+            DLOG( "Bit reading task -\t Event bit 0 was set\r\n");
         }
         if ((xEventGroupValue & mainSECOND_TASK_BIT) != 0)
         {
-            printf( "Bit reading task -\t Event bit 1 was set\r\n");
+            DLOG( "Bit reading task -\t Event bit 1 was set\r\n");
         }
         if ((xEventGroupValue & mainISR_BIT) != 0)
         {
-            printf( "Bit reading task -\t Event bit 2 was set\r\n");
+            DLOG( "Bit reading task -\t Event bit 2 was set\r\n");
         }
     }
 }
@@ -141,13 +143,15 @@ int main()
     gpio_set_irq_enabled_with_callback(GPIO_PIN, GPIO_IRQ_EDGE_FALL, true, &gpio_callback);
 
     /* Before an event group can be used it must first be created. */
-    xEventGroup = xEventGroupCreate();
+    xEventGroup = xExampleEventGroupCreate();
 
     /* Create the task that sets event bits in the event group. */
-    xTaskCreate( vEventBitSettingTask, "Bit Setter", configMINIMAL_STACK_SIZE, NULL, 1, NULL );
+    xExampleTaskCreate( vEventBitSettingTask, "Bit Setter", configMINIMAL_STACK_SIZE, NULL, 1, NULL );
 
     /* Create the task that waits for event bits to get set in the event group. */
-    xTaskCreate( vEventBitReadingTask, "Bit Reader", configMINIMAL_STACK_SIZE, NULL, 2, NULL );
+    xExampleTaskCreate( vEventBitReadingTask, "Bit Reader", configMINIMAL_STACK_SIZE, NULL, 2, NULL );
+
+    vDlogStartTask( tskIDLE_PRIORITY + 1, NULL );
 
     /* Start the scheduler so the created tasks start executing. */
     vTaskStartScheduler();
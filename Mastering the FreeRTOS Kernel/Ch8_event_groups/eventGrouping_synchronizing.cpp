@@ -5,6 +5,8 @@
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "pico/cyw43_arch.h"
+#include "dlog.h"
+#include "static_alloc.h"
 
 /***************************** Important Notes *********************************
  * 1) Sometimes the design of an application requires two or more tasks to 
@@ -86,7 +88,7 @@ static void vSyncingTask( void *pvParameters )
         /* Print out a message to show this task has reached its synchronization
         point. pcTaskGetTaskName() is an API function that returns the name assigned
         to the task when the task was created. */
-        printf("%s%s", pcTaskGetTaskName( NULL ), " reached sync point\r\n" );
+        DLOG( "%s reached sync point\r\n", pcTaskGetTaskName( NULL ) );
 
         /* Wait for all the tasks to have reached their respective synchronization
         points. */
@@ -106,7 +108,7 @@ static void vSyncingTask( void *pvParameters )
         executed after all the tasks reached their respective synchronization
         points. */
 
-        printf( "%s%s", pcTaskGetTaskName( NULL ), " exited sync point\r\n" );
+        DLOG( "%s exited sync point\r\n", pcTaskGetTaskName( NULL ) );
     }
 }
 
@@ -121,15 +123,17 @@ int main()
     // gpio_set_irq_enabled_with_callback(GPIO_PIN, GPIO_IRQ_EDGE_FALL, true, &ulEventBitSettingISR);
 
     /* Before an event group can be used it must first be created. */
-    xEventGroup = xEventGroupCreate();
+    xEventGroup = xExampleEventGroupCreate();
 
     /* Create three instances of the task. Each task is given a different name,
     which is later printed out to give a visual indication of which task is
     executing. The event bit to use when the task reaches its synchronization point
     is passed into the task using the task parameter. */
-    xTaskCreate( vSyncingTask, "Task 1", configMINIMAL_STACK_SIZE, (void*)mainFIRST_TASK_BIT, 1, NULL );
-    xTaskCreate( vSyncingTask, "Task 2", configMINIMAL_STACK_SIZE, (void*)mainSECOND_TASK_BIT, 1, NULL );
-    xTaskCreate( vSyncingTask, "Task 3", configMINIMAL_STACK_SIZE, (void*)mainTHIRD_TASK_BIT, 1, NULL );
+    xExampleTaskCreate( vSyncingTask, "Task 1", configMINIMAL_STACK_SIZE, (void*)mainFIRST_TASK_BIT, 1, NULL );
+    xExampleTaskCreate( vSyncingTask, "Task 2", configMINIMAL_STACK_SIZE, (void*)mainSECOND_TASK_BIT, 1, NULL );
+    xExampleTaskCreate( vSyncingTask, "Task 3", configMINIMAL_STACK_SIZE, (void*)mainTHIRD_TASK_BIT, 1, NULL );
+
+    vDlogStartTask( tskIDLE_PRIORITY + 1, NULL );
 
     /* Start the scheduler so the created tasks start executing. */
     vTaskStartScheduler();
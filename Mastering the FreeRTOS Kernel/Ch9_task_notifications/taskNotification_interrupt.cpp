@@ -4,6 +4,9 @@
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "pico/cyw43_arch.h"
+#include "deferral_stats.h"
+#include "isr_log.h"
+#include "static_alloc.h"
 
 /***************************** Important Notes *********************************
  * 1) The methods described so far have required the creation of a communication 
@@ -150,6 +153,10 @@
  *******************************************************************************/
 #define GPIO_PIN 9
 
+/* Handle of the task to which interrupt processing is deferred, saved when the
+task is created so the ISR can notify it. */
+TaskHandle_t xHandlerTask = NULL;
+
 void gpio_triggered_task(void *TaskParam)
 {
     while(1)
@@ -159,8 +166,12 @@ void gpio_triggered_task(void *TaskParam)
 
         /* xClearCountOnExit parameter can be changed to pdFALSE so that 
         ulTaskNotifyTake behaves more like a counting semaphore */
-        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        uint32_t ulEvents = ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
         printf( "Handler task - Processing event.\r\n");
+
+        /* With pdTRUE every notification given since the last take is handled
+        by this one pass, the deferral stats count them as coalesced. */
+        vDeferralStatsHandled( ulEvents );
     }
 }
 
@@ -171,17 +182,19 @@ void gpio_callback(uint gpio, uint32_t events)
     context switch is required. */
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-    printf("ISR triggered\r\n");
+    /* Never printf() from an ISR, see common/isr_log.h */
+    vIsrLogFromISR("ISR triggered\r\n", 0, 0);
 
     // event is an enum gpio_irq_level
     if (gpio == GPIO_PIN)
     {
+        vDeferralStatsRaisedFromISR();
         /* Send a notification directly to the task to which interrupt processing is
         being deferred. */
         vTaskNotifyGiveFromISR( /* The handle of the task to which the notification
                                    is being sent. The handle was saved when the task
                                    was created. */
-                                (TaskHandle_t)gpio_triggered_task,
+                                xHandlerTask,
                                 /* xHigherPriorityTaskWoken is used in the usual way. */
                                 &xHigherPriorityTaskWoken );
 
@@ -209,7 +222,13 @@ int main()
     the interrupt.  The handler task is created with a high priority to ensure
     it runs immediately after the interrupt exits.  In this case a priority of
     3 is chosen. */
-    xTaskCreate(gpio_triggered_task, "Handler", configMINIMAL_STACK_SIZE, NULL, 3, NULL );
+    xExampleTaskCreate(gpio_triggered_task, "Handler", configMINIMAL_STACK_SIZE, NULL, 3, &xHandlerTask );
+
+    /* Print how many events are raised, dropped and handled each second. */
+    vDeferralStatsStartReporter( pdMS_TO_TICKS( 1000 ) );
+
+    /* Print the messages queued by the ISR from a low priority task. */
+    vIsrLogStartTask( tskIDLE_PRIORITY + 1 );
 
     /* Start the scheduler so the created tasks start executing. */
     vTaskStartScheduler();
@@ -42,12 +42,26 @@
 
 /* Scheduler Related */
 #define configUSE_PREEMPTION                    1
+#if EXAMPLE_TICKLESS && !EXAMPLE_SMP_VARIANT && !HOST_POSIX_BUILD // set for the targets in TICKLESS_TARGETS, see example_enable_tickless()
+/* 2: the port's own SysTick based version is left out, see common/tickless_idle.h */
+#define configUSE_TICKLESS_IDLE                 2
+#else
 #define configUSE_TICKLESS_IDLE                 0
+#endif
 #define configUSE_IDLE_HOOK                     0
 #define configUSE_TICK_HOOK                     0
+#if HOST_POSIX_BUILD
+#define configTICK_RATE_HZ                      ( ( TickType_t ) HOST_TICK_RATE_HZ )
+#else
 #define configTICK_RATE_HZ                      ( ( TickType_t ) 1000 )
+#endif
 #define configMAX_PRIORITIES                    32
+#if HOST_POSIX_BUILD // set by host/host_posix.cmake
+/* Every task of the POSIX port is a pthread, which needs at least PTHREAD_STACK_MIN */
+#define configMINIMAL_STACK_SIZE                ( configSTACK_DEPTH_TYPE ) 8192
+#else
 #define configMINIMAL_STACK_SIZE                ( configSTACK_DEPTH_TYPE ) 256
+#endif
 #define configUSE_16_BIT_TICKS                  0
 
 #define configIDLE_SHOULD_YIELD                 1
@@ -64,24 +78,43 @@
 // todo need this for lwip FreeRTOS sys_arch to compile
 #define configENABLE_BACKWARD_COMPATIBILITY     1
 #define configNUM_THREAD_LOCAL_STORAGE_POINTERS 5
+/* Index 0 for the examples, 1 for vHiresDelayUntil(), see common/hires_timer.h */
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES   2
 
 /* System */
 #define configSTACK_DEPTH_TYPE                  uint32_t
 #define configMESSAGE_BUFFER_LENGTH_TYPE        size_t
 
 /* Memory allocation related definitions. */
+#if EXAMPLE_STATIC_ALLOCATION // set for the targets in STATIC_ALLOCATION_TARGETS, see example_enable_static_allocation()
+#define configSUPPORT_STATIC_ALLOCATION         1
+#else
 #define configSUPPORT_STATIC_ALLOCATION         0
+#endif
 #define configSUPPORT_DYNAMIC_ALLOCATION        1
+#if HOST_POSIX_BUILD
+#define configTOTAL_HEAP_SIZE                   (8*1024*1024)
+#else
 #define configTOTAL_HEAP_SIZE                   (128*1024)
+#endif
 #define configAPPLICATION_ALLOCATED_HEAP        0
 
 /* Hook function related definitions. */
 #define configCHECK_FOR_STACK_OVERFLOW          0
 #define configUSE_MALLOC_FAILED_HOOK            0
+#if EXAMPLE_RUNTIME_STATS || EXAMPLE_TICKLESS
+/* Starts the stats and report tasks, see common/example_hooks.c */
+#define configUSE_DAEMON_TASK_STARTUP_HOOK      1
+#else
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
+#endif
 
 /* Run time and task stats gathering related definitions. */
+#if EXAMPLE_RUNTIME_STATS // set for the targets in RUNTIME_STATS_TARGETS, see example_enable_runtime_stats()
+#define configGENERATE_RUN_TIME_STATS           1
+#else
 #define configGENERATE_RUN_TIME_STATS           0
+#endif
 #define configUSE_TRACE_FACILITY                1
 #define configUSE_STATS_FORMATTING_FUNCTIONS    0
 
@@ -93,7 +126,11 @@
 #define configUSE_TIMERS                        1
 #define configTIMER_TASK_PRIORITY               ( configMAX_PRIORITIES - 1 )
 #define configTIMER_QUEUE_LENGTH                10
+#if HOST_POSIX_BUILD
+#define configTIMER_TASK_STACK_DEPTH            configMINIMAL_STACK_SIZE
+#else
 #define configTIMER_TASK_STACK_DEPTH            1024
+#endif
 
 /* Interrupt nesting behaviour configuration. */
 /*
@@ -104,13 +141,18 @@
 
 #if FREE_RTOS_KERNEL_SMP // set by the RP2040 SMP port of FreeRTOS
 /* SMP port only */
+#if EXAMPLE_SMP_VARIANT // set for the <example>_smp targets, see example_add_smp_variant()
 #define configNUM_CORES                         2
+#define configUSE_CORE_AFFINITY                 1
+#else
+#define configNUM_CORES                         1
+#define configUSE_CORE_AFFINITY                 0
+#endif
 #define configTICK_CORE                         0
 #define configRUN_MULTIPLE_PRIORITIES           1
-#define configUSE_CORE_AFFINITY                 0
 #endif
 
-/* RP2040 specific */
+/* RP2040 specific (ignored by the POSIX port) */
 #define configSUPPORT_PICO_SYNC_INTEROP         1
 #define configSUPPORT_PICO_TIME_INTEROP         1
 
@@ -138,6 +180,36 @@ to exclude the API function. */
 #define INCLUDE_xQueueGetMutexHolder            1
 
 /* A header file that defines trace macro can be included here. */
+#if EXAMPLE_TRACE && !defined( __ASSEMBLER__ ) // set for the targets in TRACE_TARGETS, see example_enable_trace()
+#include "trace_recorder.h"
+#endif
+
+#if EXAMPLE_RUNTIME_STATS && EXAMPLE_TRACE
+#define traceTASK_SWITCHED_IN()                 do { vRuntimeStatsTaskSwitchedIn(); vTraceTaskSwitchedIn(); } while( 0 )
+#elif EXAMPLE_RUNTIME_STATS
+#define traceTASK_SWITCHED_IN()                 vRuntimeStatsTaskSwitchedIn()
+#elif EXAMPLE_TRACE
+#define traceTASK_SWITCHED_IN()                 vTraceTaskSwitchedIn()
+#endif
+
+#if EXAMPLE_RUNTIME_STATS && !defined( __ASSEMBLER__ )
+#include "runtime_stats.h"
+#if !HOST_POSIX_BUILD
+/* The RP2040 timer counts microseconds from reset, nothing to set up. The host
+build overrides the POSIX port's counter the same way, see host/port/portmacro.h */
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()        ulRuntimeStatsCounter()
+#endif
+#endif
+
+#if EXAMPLE_TICKLESS && !defined( __ASSEMBLER__ )
+#include "tickless_idle.h"
+#if ( configUSE_TICKLESS_IDLE == 2 )
+#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )   vTicklessSuppressTicksAndSleep( xExpectedIdleTime )
+#define configPRE_SLEEP_PROCESSING( xExpectedIdleTime )     vTicklessPreSleep( &( xExpectedIdleTime ) )
+#define configPOST_SLEEP_PROCESSING( xExpectedIdleTime )    vTicklessPostSleep( xExpectedIdleTime )
+#endif
+#endif
 
 #endif /* FREERTOS_CONFIG_H */
 
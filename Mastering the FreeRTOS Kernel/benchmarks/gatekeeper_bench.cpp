@@ -0,0 +1,216 @@
+#include <stdlib.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <semphr.h>
+#include <message_buffer.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "bench_time.h"
+
+/***************************** Important Notes *********************************
+ * 1) Bytes/s from a print task to a gatekeeper, the transport alone, at
+ * message sizes of 16, 64 and 256 bytes:
+ *
+ * "pointer_queue":  gatekeeperTask_printString.cpp. A queue of 5 char
+ *     pointers to static strings; the gatekeeper strlen()s each one and
+ *     copies it into its output buffer.
+ * "message_buffer": gatekeeperTask_messageBuffer.cpp. A message buffer that
+ *     holds 5 messages; the sender's bytes and length are copied in, and the
+ *     gatekeeper receives them straight into its output buffer.
+ * "message_buffer_locked": the same with the send mutex the example needs
+ *     for its two writers.
+ *
+ * 2) As in the examples the sender has the higher priority, so it fills the
+ * queue or buffer and blocks, and the gatekeeper then drains it. The output
+ * buffer stands in for common/batch_writer.h and is never written out, so
+ * stdout doesn't set the rate.
+ *
+ * 3) The pointer queue moves 4 bytes per message whatever the size, but only
+ * works for strings that outlive the send, and pays for a strlen(). The
+ * message buffer copies the whole message once more, on the sender's side,
+ * and works for any bytes.
+ *******************************************************************************/
+
+#define MESSAGES_PER_RUN        20000
+#define QUEUE_LENGTH            5
+#define MAX_MESSAGE_SIZE        256
+#define SINK_SIZE               4096
+#define CONTROL_TASK_PRIORITY   3
+#define SENDER_TASK_PRIORITY    2
+#define GATEKEEPER_PRIORITY     1
+
+typedef enum {
+    implPointerQueue,
+    implMessageBuffer,
+    implMessageBufferLocked,
+    implCount
+} impl_t;
+
+static const char *pcImplNames[ implCount ] = { "pointer_queue", "message_buffer", "message_buffer_locked" };
+static const size_t xSizes[] = { 16, 64, 256 };
+
+static QueueHandle_t xPointerQueue;
+static MessageBufferHandle_t xMessageBuffer;     /* Sized per message size */
+static SemaphoreHandle_t xSendMutex;
+
+static char cMessage[ MAX_MESSAGE_SIZE + 1 ];
+static char cSink[ SINK_SIZE ];
+static size_t xSinkUsed;
+
+static volatile impl_t xImpl;
+static volatile size_t xMessageSize;
+static volatile uint32_t ulBadMessages;
+
+static TaskHandle_t xControlTask;
+static TaskHandle_t xSenderTask;
+static TaskHandle_t xGatekeeperTask;
+
+/* Where the next message goes in the output buffer */
+static char *prvSinkSpace( void )
+{
+    if( xSinkUsed + MAX_MESSAGE_SIZE > SINK_SIZE )
+    {
+        xSinkUsed = 0;
+    }
+    return &cSink[ xSinkUsed ];
+}
+
+static void prvSenderTask( void *pvParameters )
+{
+    const char *pcMessage = cMessage;
+
+    for( ;; )
+    {
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        for( uint32_t i = 0; i < MESSAGES_PER_RUN; i++ )
+        {
+            switch( xImpl )
+            {
+                case implPointerQueue:
+                    xQueueSendToBack( xPointerQueue, &pcMessage, portMAX_DELAY );
+                    break;
+
+                case implMessageBuffer:
+                    xMessageBufferSend( xMessageBuffer, cMessage, xMessageSize, portMAX_DELAY );
+                    break;
+
+                default:
+                    xSemaphoreTake( xSendMutex, portMAX_DELAY );
+                    xMessageBufferSend( xMessageBuffer, cMessage, xMessageSize, portMAX_DELAY );
+                    xSemaphoreGive( xSendMutex );
+                    break;
+            }
+        }
+    }
+}
+
+static void prvGatekeeperTask( void *pvParameters )
+{
+    char *pcReceived;
+    size_t xLength;
+
+    for( ;; )
+    {
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        ulBadMessages = 0;
+
+        for( uint32_t i = 0; i < MESSAGES_PER_RUN; i++ )
+        {
+            if( xImpl == implPointerQueue )
+            {
+                xQueueReceive( xPointerQueue, &pcReceived, portMAX_DELAY );
+                xLength = strlen( pcReceived );
+                memcpy( prvSinkSpace(), pcReceived, xLength );
+            }
+            else
+            {
+                xLength = xMessageBufferReceive( xMessageBuffer, prvSinkSpace(), MAX_MESSAGE_SIZE, portMAX_DELAY );
+            }
+            xSinkUsed += xLength;
+
+            if( xLength != xMessageSize )
+            {
+                ulBadMessages++;
+            }
+        }
+
+        xTaskNotifyGive( xControlTask );
+    }
+}
+
+static void prvControlTask( void *pvParameters )
+{
+    uint64_t ullElapsedNs;
+
+    printf( "impl,msg_bytes,messages,elapsed_us,bytes_per_s,ns_per_msg\r\n" );
+
+    for( size_t s = 0; s < sizeof( xSizes ) / sizeof( xSizes[ 0 ] ); s++ )
+    {
+        xMessageSize = xSizes[ s ];
+        memset( cMessage, 'x', xMessageSize );
+        cMessage[ xMessageSize ] = '\0';
+
+        /* Room for QUEUE_LENGTH messages of this size, as the queue has */
+        if( xMessageBuffer != NULL )
+        {
+            vMessageBufferDelete( xMessageBuffer );
+        }
+        xMessageBuffer = xMessageBufferCreate( QUEUE_LENGTH * ( xMessageSize + sizeof( configMESSAGE_BUFFER_LENGTH_TYPE ) ) );
+        configASSERT( xMessageBuffer != NULL );
+
+        for( int iImpl = 0; iImpl < implCount; iImpl++ )
+        {
+            xImpl = ( impl_t ) iImpl;
+
+            ullElapsedNs = ullBenchTimeNs();
+            /* The sender runs first and fills the queue or buffer, note 2 */
+            xTaskNotifyGive( xGatekeeperTask );
+            xTaskNotifyGive( xSenderTask );
+            ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+            ullElapsedNs = ullBenchTimeNs() - ullElapsedNs;
+
+            printf( "%s,%lu,%lu,%llu,%llu,%lu\r\n", pcImplNames[ iImpl ], ( unsigned long ) xMessageSize,
+                    ( unsigned long ) MESSAGES_PER_RUN, ( unsigned long long ) ( ullElapsedNs / 1000 ),
+                    ( unsigned long long ) ( ( uint64_t ) MESSAGES_PER_RUN * xMessageSize * 1000000000u / ullElapsedNs ),
+                    ( unsigned long ) ( ullElapsedNs / MESSAGES_PER_RUN ) );
+
+            if( ulBadMessages != 0 )
+            {
+                printf( "%s: %lu messages of the wrong length\r\n", pcImplNames[ iImpl ], ( unsigned long ) ulBadMessages );
+            }
+        }
+    }
+
+    printf( "done\r\n" );
+#if HOST_POSIX_BUILD
+    exit( EXIT_SUCCESS );
+#endif
+    vTaskDelete( NULL );
+}
+
+int main()
+{
+    stdio_init_all();
+    while(!stdio_usb_connected()){tight_loop_contents();}
+
+    sleep_ms(1000);
+    printf("Gatekeeper transport benchmark\r\n");
+
+    xPointerQueue = xQueueCreate( QUEUE_LENGTH, sizeof( char * ) );
+    xSendMutex = xSemaphoreCreateMutex();
+
+    if( ( xPointerQueue != NULL ) && ( xSendMutex != NULL ) )
+    {
+        xTaskCreate( prvGatekeeperTask, "Gatekeeper", configMINIMAL_STACK_SIZE, NULL, GATEKEEPER_PRIORITY, &xGatekeeperTask );
+        xTaskCreate( prvSenderTask, "Sender", configMINIMAL_STACK_SIZE, NULL, SENDER_TASK_PRIORITY, &xSenderTask );
+        xTaskCreate( prvControlTask, "Control", configMINIMAL_STACK_SIZE, NULL, CONTROL_TASK_PRIORITY, &xControlTask );
+
+        vTaskStartScheduler();
+    }
+
+    /* As normal, the following line should never be reached. */
+    for( ;; );
+}
@@ -0,0 +1,278 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "bench_time.h"
+#include "bench_stats.h"
+#if EXAMPLE_HEAP_SLAB
+#include "heap_slab.h"
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) Built once per heap implementation of the kernel, as heap_bench_heap<n>,
+ * and for common/heap_slab.h as heap_bench_slab (see EXAMPLE_HEAP in the top
+ * level CMakeLists.txt). Each replays the same two allocation patterns
+ * through pvPortMalloc()/vPortFree():
+ *
+ * "churn50": what queuing_pointers_string.cpp did before it had a message
+ *     pool: a 50 byte buffer allocated per message and freed by the receiver,
+ *     with up to QUEUE_LENGTH messages in flight, as when the queue is full.
+ * "mixed":   MIXED_SLOTS slots, each step picks one at random and frees its
+ *     block if it has one, or else allocates 8 to 512 bytes (mostly small)
+ *     for it. The generator is seeded the same for every heap, so each one
+ *     sees the identical sequence of calls.
+ *
+ * 2) Every call is timed on its own with ulBenchFineStamp(), i.e. to the
+ * clk_sys cycle on the RP2040. The benchmark task is the only task that is
+ * ready, so the worst case only includes the tick interrupt.
+ *
+ * 3) At the end of each workload, with its blocks still allocated, the free
+ * bytes and the largest free block show how fragmented the heap is. Only
+ * heap_4 and heap_5 report the largest block (vPortGetHeapStats()); heap_1
+ * never splits, so all of its free bytes are one block; heap_2 keeps its free
+ * list private, so the column is left empty. min_ever_free is
+ * xPortGetMinimumEverFreeHeapSize() (since boot) on heap_4/5 and the
+ * benchmark's own low water mark on heap_1/2, which don't have it. The slab
+ * heap reports heap_4's figures, its arena counted as allocated, and at the
+ * end what each of its size classes holds.
+ *
+ * 4) heap_1 has no vPortFree(). On it both workloads leave out the frees and
+ * stop at the first allocation that fails, which shows how long it lasts.
+ *******************************************************************************/
+
+#define QUEUE_LENGTH            5       // xPointerQueue in queuing_pointers_string.cpp
+#define MESSAGE_SIZE            50
+#define CHURN_MESSAGES          4000
+#define MIXED_SLOTS             64
+#define MIXED_STEPS             6000
+#define MIXED_SEED              0x2545F491u
+#define MAX_SAMPLES             4096
+#define BENCH_TASK_PRIORITY     2
+
+#if EXAMPLE_HEAP == 1
+#define HEAP_CAN_FREE           0
+#else
+#define HEAP_CAN_FREE           1
+#endif
+
+#define STRINGIFY( x )          #x
+#define HEAP_NAME_OF( n )       "heap_" STRINGIFY( n )
+#if EXAMPLE_HEAP_SLAB
+#define HEAP_NAME               "slab"
+#else
+#define HEAP_NAME               HEAP_NAME_OF( EXAMPLE_HEAP )
+#endif
+
+static uint32_t ulAllocBuffer[ MAX_SAMPLES ];
+static uint32_t ulFreeBuffer[ MAX_SAMPLES ];
+static BenchSamples_t xAllocTimes;
+static BenchSamples_t xFreeTimes;
+
+static uint32_t ulFailed;
+static size_t xLowWater;
+static uint32_t ulRandom;
+
+static void *prvTimedMalloc( size_t xSize )
+{
+    uint32_t ulStart;
+    void *pv;
+    size_t xFree;
+
+    ulStart = ulBenchFineStamp();
+    pv = pvPortMalloc( xSize );
+    vBenchSamplesAdd( &xAllocTimes, ulBenchFineElapsedNs( ulStart, ulBenchFineStamp() ) );
+
+    if( pv == NULL )
+    {
+        ulFailed++;
+    }
+
+    xFree = xPortGetFreeHeapSize();
+    if( xFree < xLowWater )
+    {
+        xLowWater = xFree;
+    }
+    return pv;
+}
+
+static void prvTimedFree( void *pv )
+{
+#if HEAP_CAN_FREE
+    uint32_t ulStart;
+
+    ulStart = ulBenchFineStamp();
+    vPortFree( pv );
+    vBenchSamplesAdd( &xFreeTimes, ulBenchFineElapsedNs( ulStart, ulBenchFineStamp() ) );
+#else
+    ( void ) pv;
+#endif
+}
+
+/* xorshift32, so every heap replays the same sizes and slots */
+static uint32_t prvRandom( void )
+{
+    ulRandom ^= ulRandom << 13;
+    ulRandom ^= ulRandom >> 17;
+    ulRandom ^= ulRandom << 5;
+    return ulRandom;
+}
+
+static void prvStartWorkload( void )
+{
+    vBenchSamplesInit( &xAllocTimes, ulAllocBuffer, MAX_SAMPLES );
+    vBenchSamplesInit( &xFreeTimes, ulFreeBuffer, MAX_SAMPLES );
+    ulFailed = 0;
+    xLowWater = xPortGetFreeHeapSize();
+    ulRandom = MIXED_SEED;
+}
+
+/* Called while the workload's blocks are still allocated */
+static void prvPrintRow( const char *pcWorkload )
+{
+    BenchSummary_t xAlloc, xFree;
+    size_t xMinEverFree = xLowWater;
+    char cLargest[ 16 ] = "";
+
+#if EXAMPLE_HEAP == 4 || EXAMPLE_HEAP == 5
+    HeapStats_t xStats;
+
+    vPortGetHeapStats( &xStats );
+    snprintf( cLargest, sizeof( cLargest ), "%lu", ( unsigned long ) xStats.xSizeOfLargestFreeBlockInBytes );
+    xMinEverFree = xPortGetMinimumEverFreeHeapSize();
+#elif EXAMPLE_HEAP == 1
+    snprintf( cLargest, sizeof( cLargest ), "%lu", ( unsigned long ) xPortGetFreeHeapSize() );
+#endif
+
+    vBenchSamplesSummarise( &xAllocTimes, &xAlloc );
+    vBenchSamplesSummarise( &xFreeTimes, &xFree );
+
+    printf( "%s,%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%s,%lu\r\n", HEAP_NAME, pcWorkload,
+            ( unsigned long ) ( xAlloc.xCount + xAllocTimes.xOverflow ), ( unsigned long ) ulFailed,
+            ( unsigned long ) xAlloc.ulMean, ( unsigned long ) xAlloc.ulP99, ( unsigned long ) xAlloc.ulMax,
+            ( unsigned long ) ( xFree.xCount + xFreeTimes.xOverflow ),
+            ( unsigned long ) xFree.ulMean, ( unsigned long ) xFree.ulP99, ( unsigned long ) xFree.ulMax,
+            ( unsigned long ) xPortGetFreeHeapSize(), cLargest, ( unsigned long ) xMinEverFree );
+}
+
+static void prvChurn50( void )
+{
+    void *pvInFlight[ QUEUE_LENGTH ] = { NULL };
+
+    prvStartWorkload();
+
+    for( uint32_t i = 0; i < CHURN_MESSAGES; i++ )
+    {
+        /* The oldest message has been received and printed */
+        void **ppvSlot = &pvInFlight[ i % QUEUE_LENGTH ];
+
+        if( *ppvSlot != NULL )
+        {
+            prvTimedFree( *ppvSlot );
+        }
+        *ppvSlot = prvTimedMalloc( MESSAGE_SIZE );
+
+        if( ( HEAP_CAN_FREE == 0 ) && ( *ppvSlot == NULL ) )
+        {
+            break;
+        }
+    }
+
+    prvPrintRow( "churn50" );
+
+    for( int i = 0; i < QUEUE_LENGTH; i++ )
+    {
+        prvTimedFree( pvInFlight[ i ] );
+    }
+}
+
+static void prvMixed( void )
+{
+    static void *pvSlots[ MIXED_SLOTS ];
+    size_t xSize;
+
+    prvStartWorkload();
+
+    for( uint32_t i = 0; i < MIXED_STEPS; i++ )
+    {
+        void **ppvSlot = &pvSlots[ prvRandom() % MIXED_SLOTS ];
+
+        if( *ppvSlot != NULL )
+        {
+            prvTimedFree( *ppvSlot );
+            *ppvSlot = NULL;
+            continue;
+        }
+
+        /* Three in four 8..64 bytes, the rest up to 512 */
+        xSize = ( ( prvRandom() & 3 ) != 0 ) ? 8 + prvRandom() % 57 : 64 + prvRandom() % 449;
+        *ppvSlot = prvTimedMalloc( xSize );
+
+        if( ( HEAP_CAN_FREE == 0 ) && ( *ppvSlot == NULL ) )
+        {
+            break;
+        }
+    }
+
+    prvPrintRow( "mixed" );
+
+    for( int i = 0; i < MIXED_SLOTS; i++ )
+    {
+        if( pvSlots[ i ] != NULL )
+        {
+            prvTimedFree( pvSlots[ i ] );
+            pvSlots[ i ] = NULL;
+        }
+    }
+}
+
+static void prvBenchTask( void *pvParameters )
+{
+    printf( "heap,workload,allocs,failed,alloc_mean_ns,alloc_p99_ns,alloc_max_ns,"
+            "frees,free_mean_ns,free_p99_ns,free_max_ns,free_bytes,largest_free_block,min_ever_free\r\n" );
+
+    prvChurn50();
+    prvMixed();
+
+#if EXAMPLE_HEAP_SLAB
+    SlabClassStats_t xClassStats[ slabNUM_CLASSES ];
+
+    vSlabGetStats( xClassStats );
+    printf( "class,block_size,pages,in_use,high_water_mark,allocations,overflows\r\n" );
+    for( int i = 0; i < slabNUM_CLASSES; i++ )
+    {
+        printf( "%d,%lu,%lu,%lu,%lu,%lu,%lu\r\n", i, ( unsigned long ) xClassStats[ i ].ulBlockSize,
+                ( unsigned long ) xClassStats[ i ].ulPages, ( unsigned long ) xClassStats[ i ].ulInUse,
+                ( unsigned long ) xClassStats[ i ].ulHighWaterMark, ( unsigned long ) xClassStats[ i ].ulAllocations,
+                ( unsigned long ) xClassStats[ i ].ulOverflows );
+    }
+    printf( "free_pages,%lu\r\n", ( unsigned long ) ulSlabGetFreePages() );
+#endif
+
+    printf( "done\r\n" );
+#if HOST_POSIX_BUILD
+    exit( EXIT_SUCCESS );
+#endif
+    for( ;; )
+    {
+        /* Not vTaskDelete(), which heap_1 can't free */
+        vTaskSuspend( NULL );
+    }
+}
+
+int main()
+{
+    stdio_init_all();
+    while(!stdio_usb_connected()){tight_loop_contents();}
+
+    sleep_ms(1000);
+    printf("%s allocator benchmark\r\n", HEAP_NAME);
+
+    xTaskCreate( prvBenchTask, "Bench", configMINIMAL_STACK_SIZE, NULL, BENCH_TASK_PRIORITY, NULL );
+
+    vTaskStartScheduler();
+
+    /* As normal, the following line should never be reached. */
+    for( ;; );
+}
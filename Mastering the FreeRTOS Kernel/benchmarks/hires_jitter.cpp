@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "bench_time.h"
+#include "bench_stats.h"
+#include "hires_timer.h"
+
+/***************************** Important Notes *********************************
+ * 1) Period jitter of a periodic task, woken by:
+ *
+ * "tick_delay_until":  vTaskDelayUntil(), as vperiodicTask in tasks.cpp, at
+ *     5 ms, the finest period below which it can only do whole ticks.
+ * "hires_delay_until": vHiresDelayUntil() (common/hires_timer.h) at 5 ms and
+ *     at 500 us, which ticks can't express.
+ * "hires_timer":       a periodic HiresTimer_t at 250 us, timed in its
+ *     callback in the service task.
+ *
+ * 2) Each interval between two wakes is measured with ullBenchTimeNs() (1 us
+ * steps on the RP2040) and the jitter is how far it is from the period.
+ * The task and the service task run at the same high priority with nothing
+ * else ready, so the figures are the timing source's own: the tick interrupt
+ * for vTaskDelayUntil(), the alarm interrupt for the others.
+ *
+ * 3) On the host build the high resolution calls fall back to whole ticks
+ * (note 5 in hires_timer.h), so there the 500 us and 250 us rows show the
+ * ticks they are rounded to.
+ *******************************************************************************/
+
+#define INTERVALS               2000
+#define TASK_PERIOD_US          5000
+#define FAST_PERIOD_US          500
+#define TIMER_PERIOD_US         250
+#define BENCH_TASK_PRIORITY     ( configMAX_PRIORITIES - 2 )
+
+static uint32_t ulJitterBuffer[ INTERVALS ];
+static BenchSamples_t xJitter;
+
+static TaskHandle_t xBenchTask;
+static HiresTimer_t xTimer;
+static uint64_t ullLastNs;
+static uint32_t ulCallbacks;
+
+static void prvAddInterval( uint64_t ullNowNs, uint32_t ulPeriodUs )
+{
+    const int64_t llErrorNs = ( int64_t ) ( ullNowNs - ullLastNs ) - ( int64_t ) ulPeriodUs * 1000;
+
+    vBenchSamplesAdd( &xJitter, ( uint32_t ) ( ( llErrorNs < 0 ) ? -llErrorNs : llErrorNs ) );
+    ullLastNs = ullNowNs;
+}
+
+static void prvPrintRow( const char *pcMethod, uint32_t ulPeriodUs, uint32_t ulOverruns )
+{
+    BenchSummary_t xSummary;
+
+    vBenchSamplesSummarise( &xJitter, &xSummary );
+    printf( "%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu\r\n", pcMethod, ( unsigned long ) ulPeriodUs,
+            ( unsigned long ) xSummary.xCount, ( unsigned long ) xSummary.ulMin, ( unsigned long ) xSummary.ulMedian,
+            ( unsigned long ) xSummary.ulP99, ( unsigned long ) xSummary.ulMax, ( unsigned long ) ulOverruns );
+}
+
+static void prvTickDelayUntil( void )
+{
+    TickType_t xLastWakeTime;
+
+    vBenchSamplesInit( &xJitter, ulJitterBuffer, INTERVALS );
+    xLastWakeTime = xTaskGetTickCount();
+    vTaskDelayUntil( &xLastWakeTime, pdMS_TO_TICKS( TASK_PERIOD_US / 1000 ) );
+    ullLastNs = ullBenchTimeNs();
+
+    for( uint32_t i = 0; i < INTERVALS; i++ )
+    {
+        vTaskDelayUntil( &xLastWakeTime, pdMS_TO_TICKS( TASK_PERIOD_US / 1000 ) );
+        prvAddInterval( ullBenchTimeNs(), TASK_PERIOD_US );
+    }
+    prvPrintRow( "tick_delay_until", TASK_PERIOD_US, 0 );
+}
+
+static void prvHiresDelayUntil( uint32_t ulPeriodUs )
+{
+    uint64_t ullLastWakeUs;
+
+    vBenchSamplesInit( &xJitter, ulJitterBuffer, INTERVALS );
+    ullLastWakeUs = time_us_64();
+    vHiresDelayUntil( &ullLastWakeUs, ulPeriodUs );
+    ullLastNs = ullBenchTimeNs();
+
+    for( uint32_t i = 0; i < INTERVALS; i++ )
+    {
+        vHiresDelayUntil( &ullLastWakeUs, ulPeriodUs );
+        prvAddInterval( ullBenchTimeNs(), ulPeriodUs );
+    }
+    prvPrintRow( "hires_delay_until", ulPeriodUs, 0 );
+}
+
+static void prvTimerCallback( HiresTimer_t *pxTimer, uint64_t ullDueUs )
+{
+    const uint64_t ullNowNs = ullBenchTimeNs();
+
+    /* The first callback only starts the clock */
+    if( ulCallbacks++ == 0 )
+    {
+        ullLastNs = ullNowNs;
+        return;
+    }
+    prvAddInterval( ullNowNs, TIMER_PERIOD_US );
+    if( ulCallbacks == INTERVALS + 1 )
+    {
+        vHiresTimerStop( pxTimer );
+        xTaskNotifyGive( xBenchTask );
+    }
+}
+
+static void prvHiresTimer( void )
+{
+    vBenchSamplesInit( &xJitter, ulJitterBuffer, INTERVALS );
+    ulCallbacks = 0;
+    xHiresTimerStart( &xTimer, TIMER_PERIOD_US, TIMER_PERIOD_US );
+    ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+    prvPrintRow( "hires_timer", TIMER_PERIOD_US, ulHiresTimerGetOverruns( &xTimer ) );
+}
+
+static void prvBenchTask( void *pvParameters )
+{
+    printf( "method,period_us,intervals,jitter_min_ns,jitter_median_ns,jitter_p99_ns,jitter_max_ns,overruns\r\n" );
+
+    prvTickDelayUntil();
+    prvHiresDelayUntil( TASK_PERIOD_US );
+    prvHiresDelayUntil( FAST_PERIOD_US );
+    prvHiresTimer();
+
+    printf( "done\r\n" );
+#if HOST_POSIX_BUILD
+    exit( EXIT_SUCCESS );
+#endif
+    vTaskDelete( NULL );
+}
+
+int main()
+{
+    stdio_init_all();
+    while(!stdio_usb_connected()){tight_loop_contents();}
+
+    sleep_ms(1000);
+    printf("High resolution timer jitter benchmark\r\n");
+
+    vHiresTimerServiceStart( BENCH_TASK_PRIORITY );
+    vHiresTimerInit( &xTimer, prvTimerCallback, NULL );
+    xTaskCreate( prvBenchTask, "Bench", configMINIMAL_STACK_SIZE, NULL, BENCH_TASK_PRIORITY, &xBenchTask );
+
+    vTaskStartScheduler();
+
+    /* As normal, the following line should never be reached. */
+    for( ;; );
+}
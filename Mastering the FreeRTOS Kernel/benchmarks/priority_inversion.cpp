@@ -0,0 +1,267 @@
+#include <stdlib.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "bench_time.h"
+#include "bench_stats.h"
+#include "core_affinity.h"
+
+/***************************** Important Notes *********************************
+ * 1) The priority inversion of note 1A in gatekeeperTask_printString.cpp, run
+ * RUNS_PER_LOAD times for each MP load:
+ *
+ * (1) LP takes the lock. (2) HP is woken, tries to take it and blocks.
+ * (3) MP is woken and runs for its load, busy. (4) LP holds the lock for
+ * LP_HOLD_US, busy, and gives it. HP's blocking time is from its take to the
+ * take returning.
+ *
+ * "mutex": LP inherits HP's priority at (2), so MP can't preempt it at (3)
+ *     and only runs once HP is done. HP blocks for about LP_HOLD_US whatever
+ *     the MP load: the inversion is bounded by LP's hold.
+ * "binary_semaphore": the control, no inheritance. MP preempts LP and runs
+ *     its whole load while HP waits, about LP_HOLD_US + the MP load.
+ *
+ * 2) The cost of inheritance, the median of every take and give, in ns and
+ * clk_sys cycles (ulBenchFineStamp(), cycles are 0 on the host build):
+ *
+ * "take_give_uncontended": an xSemaphoreTake() + xSemaphoreGive() pair that
+ *     never blocks. The mutex also records and clears its holder.
+ * "contended_take": from HP calling xSemaphoreTake() to LP running again,
+ *     i.e. HP blocking and the switch back, with the mutex raising LP's
+ *     priority on the way.
+ * "give_to_waiter": from LP calling xSemaphoreGive() to HP's take returning,
+ *     i.e. HP unblocking and the switch to it, with the mutex restoring LP's
+ *     priority on the way.
+ *
+ * The difference between the mutex and binary_semaphore rows is what
+ * configUSE_MUTEXES inheritance costs per take or give.
+ *
+ * 3) All four tasks are on core 0, in the _smp variant too: with MP free to
+ * run on core 1 it would never preempt LP.
+ *******************************************************************************/
+
+#define RUNS_PER_LOAD           50
+#define LP_HOLD_US              1000
+#define UNCONTENDED_PAIRS       1000
+#define CONTROL_TASK_PRIORITY   5
+#define HP_TASK_PRIORITY        4
+#define MP_TASK_PRIORITY        3
+#define LP_TASK_PRIORITY        2
+
+typedef enum {
+    lockMutex,
+    lockBinarySemaphore,
+    lockCount
+} lock_t;
+
+static const char *pcLockNames[ lockCount ] = { "mutex", "binary_semaphore" };
+static const uint32_t ulMpLoadsUs[] = { 0, 500, 1000, 2000, 5000 };
+
+#define LOAD_COUNT              ( sizeof( ulMpLoadsUs ) / sizeof( ulMpLoadsUs[ 0 ] ) )
+
+static SemaphoreHandle_t xLocks[ lockCount ];
+static volatile lock_t xLock;
+static volatile uint32_t ulMpLoadUs;
+
+/* Written by LP, read by HP once it has the lock */
+static volatile uint32_t ulLpResumedStamp;
+static volatile uint32_t ulLpGiveStamp;
+
+static uint32_t ulWaitBuffer[ RUNS_PER_LOAD ];
+static uint32_t ulTakeBuffer[ lockCount ][ RUNS_PER_LOAD * LOAD_COUNT ];
+static uint32_t ulGiveBuffer[ lockCount ][ RUNS_PER_LOAD * LOAD_COUNT ];
+static uint32_t ulPairBuffer[ UNCONTENDED_PAIRS ];
+static BenchSamples_t xWaitUs;
+static BenchSamples_t xContendedTakeNs[ lockCount ];
+static BenchSamples_t xGiveToWaiterNs[ lockCount ];
+
+static TaskHandle_t xControlTask;
+static TaskHandle_t xHpTask;
+static TaskHandle_t xMpTask;
+static TaskHandle_t xLpTask;
+
+static void prvSpinUs( uint32_t ulUs )
+{
+    const uint64_t ullEndNs = ullBenchTimeNs() + ( uint64_t ) ulUs * 1000u;
+
+    while( ullBenchTimeNs() < ullEndNs )
+    {
+    }
+}
+
+static uint32_t prvNsToCycles( uint32_t ulNs )
+{
+#if HOST_POSIX_BUILD
+    ( void ) ulNs;
+    return 0;
+#else
+    return ( uint32_t ) ( ( uint64_t ) ulNs * clock_get_hz( clk_sys ) / 1000000000u );
+#endif
+}
+
+static void prvLpTask( void *pvParameters )
+{
+    for( ;; )
+    {
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        xSemaphoreTake( xLocks[ xLock ], portMAX_DELAY );
+        {
+            /* HP preempts and blocks on the lock, note 1 (2) */
+            xTaskNotifyGive( xHpTask );
+            ulLpResumedStamp = ulBenchFineStamp();
+
+            /* MP preempts unless LP now has HP's priority, (3) */
+            xTaskNotifyGive( xMpTask );
+
+            prvSpinUs( LP_HOLD_US );
+            ulLpGiveStamp = ulBenchFineStamp();
+        }
+        xSemaphoreGive( xLocks[ xLock ] );
+
+        xTaskNotifyGive( xControlTask );
+    }
+}
+
+static void prvMpTask( void *pvParameters )
+{
+    for( ;; )
+    {
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        prvSpinUs( ulMpLoadUs );
+        xTaskNotifyGive( xControlTask );
+    }
+}
+
+static void prvHpTask( void *pvParameters )
+{
+    uint64_t ullStartNs;
+    uint32_t ulTakeStamp, ulTakenStamp;
+
+    for( ;; )
+    {
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        ullStartNs = ullBenchTimeNs();
+        ulTakeStamp = ulBenchFineStamp();
+        xSemaphoreTake( xLocks[ xLock ], portMAX_DELAY );
+        ulTakenStamp = ulBenchFineStamp();
+        vBenchSamplesAdd( &xWaitUs, ( uint32_t ) ( ( ullBenchTimeNs() - ullStartNs ) / 1000 ) );
+        xSemaphoreGive( xLocks[ xLock ] );
+
+        /* Both well under a tick, as ulBenchFineElapsedNs() needs */
+        vBenchSamplesAdd( &xContendedTakeNs[ xLock ], ulBenchFineElapsedNs( ulTakeStamp, ulLpResumedStamp ) );
+        vBenchSamplesAdd( &xGiveToWaiterNs[ xLock ], ulBenchFineElapsedNs( ulLpGiveStamp, ulTakenStamp ) );
+
+        xTaskNotifyGive( xControlTask );
+    }
+}
+
+static void prvPrintCost( const char *pcLock, const char *pcOp, BenchSamples_t *pxSamples )
+{
+    BenchSummary_t xSummary;
+
+    vBenchSamplesSummarise( pxSamples, &xSummary );
+    printf( "%s,%s,%lu,%lu,%lu\r\n", pcLock, pcOp, ( unsigned long ) xSummary.xCount,
+            ( unsigned long ) xSummary.ulMedian, ( unsigned long ) prvNsToCycles( xSummary.ulMedian ) );
+}
+
+static void prvUncontended( int iLock )
+{
+    BenchSamples_t xPairNs;
+    uint32_t ulStart;
+
+    vBenchSamplesInit( &xPairNs, ulPairBuffer, UNCONTENDED_PAIRS );
+    for( uint32_t i = 0; i < UNCONTENDED_PAIRS; i++ )
+    {
+        ulStart = ulBenchFineStamp();
+        xSemaphoreTake( xLocks[ iLock ], 0 );
+        xSemaphoreGive( xLocks[ iLock ] );
+        vBenchSamplesAdd( &xPairNs, ulBenchFineElapsedNs( ulStart, ulBenchFineStamp() ) );
+    }
+    prvPrintCost( pcLockNames[ iLock ], "take_give_uncontended", &xPairNs );
+}
+
+static void prvControlTask( void *pvParameters )
+{
+    BenchSummary_t xSummary;
+    uint32_t ulDone;
+
+    printf( "lock,mp_load_us,runs,lp_hold_us,hp_wait_min_us,hp_wait_median_us,hp_wait_p99_us,hp_wait_max_us\r\n" );
+
+    for( int iLock = 0; iLock < lockCount; iLock++ )
+    {
+        xLock = ( lock_t ) iLock;
+        vBenchSamplesInit( &xContendedTakeNs[ iLock ], ulTakeBuffer[ iLock ], RUNS_PER_LOAD * LOAD_COUNT );
+        vBenchSamplesInit( &xGiveToWaiterNs[ iLock ], ulGiveBuffer[ iLock ], RUNS_PER_LOAD * LOAD_COUNT );
+
+        for( size_t l = 0; l < LOAD_COUNT; l++ )
+        {
+            ulMpLoadUs = ulMpLoadsUs[ l ];
+            vBenchSamplesInit( &xWaitUs, ulWaitBuffer, RUNS_PER_LOAD );
+
+            for( uint32_t r = 0; r < RUNS_PER_LOAD; r++ )
+            {
+                xTaskNotifyGive( xLpTask );
+
+                /* LP, MP and HP each report when done */
+                for( ulDone = 0; ulDone < 3; )
+                {
+                    ulDone += ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+                }
+            }
+
+            vBenchSamplesSummarise( &xWaitUs, &xSummary );
+            printf( "%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu\r\n", pcLockNames[ iLock ], ( unsigned long ) ulMpLoadUs,
+                    ( unsigned long ) xSummary.xCount, ( unsigned long ) LP_HOLD_US,
+                    ( unsigned long ) xSummary.ulMin, ( unsigned long ) xSummary.ulMedian,
+                    ( unsigned long ) xSummary.ulP99, ( unsigned long ) xSummary.ulMax );
+        }
+    }
+
+    printf( "lock,op,samples,median_ns,median_cycles\r\n" );
+    for( int iLock = 0; iLock < lockCount; iLock++ )
+    {
+        prvUncontended( iLock );
+        prvPrintCost( pcLockNames[ iLock ], "contended_take", &xContendedTakeNs[ iLock ] );
+        prvPrintCost( pcLockNames[ iLock ], "give_to_waiter", &xGiveToWaiterNs[ iLock ] );
+    }
+
+    printf( "done\r\n" );
+#if HOST_POSIX_BUILD
+    exit( EXIT_SUCCESS );
+#endif
+    vTaskDelete( NULL );
+}
+
+int main()
+{
+    stdio_init_all();
+    while(!stdio_usb_connected()){tight_loop_contents();}
+
+    sleep_ms(1000);
+    printf("Priority inversion benchmark\r\n");
+
+    xLocks[ lockMutex ] = xSemaphoreCreateMutex();
+    xLocks[ lockBinarySemaphore ] = xSemaphoreCreateBinary();
+
+    if( ( xLocks[ lockMutex ] != NULL ) && ( xLocks[ lockBinarySemaphore ] != NULL ) )
+    {
+        /* A binary semaphore used as a lock starts given */
+        xSemaphoreGive( xLocks[ lockBinarySemaphore ] );
+
+        /* All on core 0, note 3 */
+        xTaskCreatePinned( prvLpTask, "LP", configMINIMAL_STACK_SIZE, NULL, LP_TASK_PRIORITY, 0, &xLpTask );
+        xTaskCreatePinned( prvMpTask, "MP", configMINIMAL_STACK_SIZE, NULL, MP_TASK_PRIORITY, 0, &xMpTask );
+        xTaskCreatePinned( prvHpTask, "HP", configMINIMAL_STACK_SIZE, NULL, HP_TASK_PRIORITY, 0, &xHpTask );
+        xTaskCreatePinned( prvControlTask, "Control", configMINIMAL_STACK_SIZE, NULL, CONTROL_TASK_PRIORITY,
+                           0, &xControlTask );
+
+        vTaskStartScheduler();
+    }
+
+    /* As normal, the following line should never be reached. */
+    for( ;; );
+}
@@ -0,0 +1,206 @@
+#include <stdlib.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <semphr.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "bench_time.h"
+#include "spsc_ring.h"
+
+/***************************** Important Notes *********************************
+ * 1) Compares Ring<T, N> (common/spsc_ring.h) with a FreeRTOS queue of the
+ * same length on the two single producer, single consumer paths of Ch6:
+ *
+ * "uncontended": one task sends an item and immediately takes it back,
+ *     ITEMS_PER_RUN times. This is the bare cost of a send plus a receive:
+ *     xQueueSendToBack() + xQueueReceive(), the FromISR pair an ISR on either
+ *     end would use, and xPush() + xPopFromISR() on the ring.
+ * "blocking": a producer task passes ITEMS_PER_RUN items to a higher priority
+ *     consumer task that blocks when there is nothing to do, so every item
+ *     wakes it - xQueueReceive( portMAX_DELAY ) against xPop( portMAX_DELAY ).
+ *
+ * 2) The FromISR calls are made from a task with interrupts masked, as they
+ * would be inside an ISR; the interrupt entry and exit are not counted.
+ *
+ * 3) The output is CSV, ns_per_item being the time for one item to go in
+ * and come back out.
+ *******************************************************************************/
+
+#define ITEMS_PER_RUN           100000
+#define RING_LENGTH             8
+#define CONTROL_TASK_PRIORITY   3
+#define CONSUMER_TASK_PRIORITY  2
+#define PRODUCER_TASK_PRIORITY  1
+
+typedef enum {
+    pathQueue,
+    pathRing,
+    pathCount
+} path_t;
+
+static const char *pcPathNames[ pathCount ] = { "queue", "ring" };
+
+static QueueHandle_t xQueue;
+static SemaphoreHandle_t xConsumerStart;
+static Ring< uint32_t, RING_LENGTH > xRing;
+
+static volatile path_t xPath;
+static volatile uint32_t ulBadItems;
+
+static TaskHandle_t xControlTask;
+static TaskHandle_t xProducerTask;
+
+static void prvPrintRow( const char *pcMode, const char *pcPath, uint64_t ullElapsedNs )
+{
+    printf( "%s,%s,%lu,%llu,%lu\r\n", pcMode, pcPath, ( unsigned long ) ITEMS_PER_RUN,
+            ( unsigned long long ) ( ullElapsedNs / 1000 ), ( unsigned long ) ( ullElapsedNs / ITEMS_PER_RUN ) );
+}
+
+static void prvUncontended( void )
+{
+    UBaseType_t uxSavedInterruptStatus;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uint64_t ullStartNs;
+    uint32_t ulItem;
+
+    ullStartNs = ullBenchTimeNs();
+    for( uint32_t i = 0; i < ITEMS_PER_RUN; i++ )
+    {
+        xQueueSendToBack( xQueue, &i, 0 );
+        xQueueReceive( xQueue, &ulItem, 0 );
+    }
+    prvPrintRow( "uncontended", "queue", ullBenchTimeNs() - ullStartNs );
+
+    ullStartNs = ullBenchTimeNs();
+    for( uint32_t i = 0; i < ITEMS_PER_RUN; i++ )
+    {
+        uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+        xQueueSendToBackFromISR( xQueue, &i, &xHigherPriorityTaskWoken );
+        xQueueReceiveFromISR( xQueue, &ulItem, &xHigherPriorityTaskWoken );
+        taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+    }
+    prvPrintRow( "uncontended", "queue_from_isr", ullBenchTimeNs() - ullStartNs );
+
+    ullStartNs = ullBenchTimeNs();
+    for( uint32_t i = 0; i < ITEMS_PER_RUN; i++ )
+    {
+        xRing.xPush( i );
+        xRing.xPopFromISR( ulItem );
+    }
+    prvPrintRow( "uncontended", "ring", ullBenchTimeNs() - ullStartNs );
+}
+
+static void prvProducerTask( void *pvParameters )
+{
+    for( ;; )
+    {
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        for( uint32_t i = 0; i < ITEMS_PER_RUN; )
+        {
+            if( xPath == pathQueue )
+            {
+                xQueueSendToBack( xQueue, &i, portMAX_DELAY );
+                i++;
+            }
+            else if( xRing.xPush( i ) == pdPASS )
+            {
+                i++;
+            }
+            else
+            {
+                /* Only the consumer can block on the ring; can't happen while
+                it has the higher priority, but don't spin if it does. */
+                taskYIELD();
+            }
+        }
+    }
+}
+
+static void prvConsumerTask( void *pvParameters )
+{
+    uint32_t ulItem;
+
+    for( ;; )
+    {
+        /* Not a notification: xRing.xPop() blocks on this task's notification. */
+        xSemaphoreTake( xConsumerStart, portMAX_DELAY );
+        ulBadItems = 0;
+
+        for( uint32_t i = 0; i < ITEMS_PER_RUN; i++ )
+        {
+            if( xPath == pathQueue )
+            {
+                xQueueReceive( xQueue, &ulItem, portMAX_DELAY );
+            }
+            else
+            {
+                xRing.xPop( ulItem, portMAX_DELAY );
+            }
+
+            if( ulItem != i )
+            {
+                ulBadItems++;
+            }
+        }
+
+        xTaskNotifyGive( xControlTask );
+    }
+}
+
+static void prvControlTask( void *pvParameters )
+{
+    uint64_t ullStartNs;
+
+    printf( "mode,path,items,elapsed_us,ns_per_item\r\n" );
+
+    prvUncontended();
+
+    for( int iPath = 0; iPath < pathCount; iPath++ )
+    {
+        xPath = ( path_t ) iPath;
+
+        ullStartNs = ullBenchTimeNs();
+        /* Consumer first, so it is already blocked on the empty queue or ring */
+        xSemaphoreGive( xConsumerStart );
+        xTaskNotifyGive( xProducerTask );
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        prvPrintRow( "blocking", pcPathNames[ iPath ], ullBenchTimeNs() - ullStartNs );
+
+        if( ulBadItems != 0 )
+        {
+            printf( "%s: %lu items lost or out of order\r\n", pcPathNames[ iPath ], ( unsigned long ) ulBadItems );
+        }
+    }
+
+    printf( "done\r\n" );
+#if HOST_POSIX_BUILD
+    exit( EXIT_SUCCESS );
+#endif
+    vTaskDelete( NULL );
+}
+
+int main()
+{
+    stdio_init_all();
+    while(!stdio_usb_connected()){tight_loop_contents();}
+
+    sleep_ms(1000);
+    printf("SPSC ring vs queue benchmark\r\n");
+
+    xQueue = xQueueCreate( RING_LENGTH, sizeof( uint32_t ) );
+    xConsumerStart = xSemaphoreCreateBinary();
+
+    if( ( xQueue != NULL ) && ( xConsumerStart != NULL ) )
+    {
+        xTaskCreate( prvConsumerTask, "Consumer", configMINIMAL_STACK_SIZE, NULL, CONSUMER_TASK_PRIORITY, NULL );
+        xTaskCreate( prvProducerTask, "Producer", configMINIMAL_STACK_SIZE, NULL, PRODUCER_TASK_PRIORITY, &xProducerTask );
+        xTaskCreate( prvControlTask, "Control", configMINIMAL_STACK_SIZE, NULL, CONTROL_TASK_PRIORITY, &xControlTask );
+
+        vTaskStartScheduler();
+    }
+
+    /* As normal, the following line should never be reached. */
+    for( ;; );
+}
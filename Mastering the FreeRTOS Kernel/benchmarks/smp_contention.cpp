@@ -0,0 +1,191 @@
+#include <stdlib.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <semphr.h>
+#include <event_groups.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "bench_time.h"
+#include "core_affinity.h"
+
+/***************************** Important Notes *********************************
+ * 1) Two tasks of equal priority hammer one kernel object, first both pinned
+ * to core 0, then on core 0 and core 1:
+ *
+ * queue:       one sends OPS_PER_RUN items, the other receives them.
+ * mutex:       both take the mutex, bump a shared counter and give it back,
+ *              OPS_PER_RUN times each.
+ * event_group: ping-pong, one sets bit 0 and waits for bit 1, the other waits
+ *              for bit 0 and sets bit 1, OPS_PER_RUN round trips.
+ *
+ * 2) On one core the two tasks only alternate when one blocks or at a tick,
+ * so the kernel object is never contended. Across cores every operation can
+ * find the other core inside the object, and both cores take the kernel's
+ * spinlocks (a single critical section shared by all objects) for every call.
+ *
+ * 3) Only smp_contention_smp pins to two cores. Without core affinity (the
+ * plain target and the host build) the same_core rows are all that is run.
+ *******************************************************************************/
+
+#define OPS_PER_RUN             20000
+#define QUEUE_LENGTH            8
+#define WORKER_TASK_PRIORITY    2
+#define CONTROL_TASK_PRIORITY   3
+
+#define PING_BIT                ( 1UL << 0UL )
+#define PONG_BIT                ( 1UL << 1UL )
+
+typedef enum {
+    testQueue,
+    testMutex,
+    testEventGroup,
+    testCount
+} test_t;
+
+static const char *pcTestNames[ testCount ] = { "queue", "mutex", "event_group" };
+
+static QueueHandle_t xQueue;
+static SemaphoreHandle_t xMutex;
+static EventGroupHandle_t xEventGroup;
+static volatile uint32_t ulSharedCounter;
+static TaskHandle_t xControlTask;
+
+/* Every worker ends like this, so the control task can wait for both. */
+static void prvWorkerDone( void )
+{
+    xTaskNotifyGive( xControlTask );
+    vTaskDelete( NULL );
+}
+
+static void prvQueueProducer( void *pvParameters )
+{
+    for( uint32_t i = 0; i < OPS_PER_RUN; i++ )
+    {
+        xQueueSendToBack( xQueue, &i, portMAX_DELAY );
+    }
+    prvWorkerDone();
+}
+
+static void prvQueueConsumer( void *pvParameters )
+{
+    uint32_t ulItem;
+    for( uint32_t i = 0; i < OPS_PER_RUN; i++ )
+    {
+        xQueueReceive( xQueue, &ulItem, portMAX_DELAY );
+    }
+    prvWorkerDone();
+}
+
+static void prvMutexWorker( void *pvParameters )
+{
+    for( uint32_t i = 0; i < OPS_PER_RUN; i++ )
+    {
+        xSemaphoreTake( xMutex, portMAX_DELAY );
+        ulSharedCounter++;
+        xSemaphoreGive( xMutex );
+    }
+    prvWorkerDone();
+}
+
+static void prvEventPing( void *pvParameters )
+{
+    for( uint32_t i = 0; i < OPS_PER_RUN; i++ )
+    {
+        xEventGroupSetBits( xEventGroup, PING_BIT );
+        xEventGroupWaitBits( xEventGroup, PONG_BIT, pdTRUE, pdTRUE, portMAX_DELAY );
+    }
+    prvWorkerDone();
+}
+
+static void prvEventPong( void *pvParameters )
+{
+    for( uint32_t i = 0; i < OPS_PER_RUN; i++ )
+    {
+        xEventGroupWaitBits( xEventGroup, PING_BIT, pdTRUE, pdTRUE, portMAX_DELAY );
+        xEventGroupSetBits( xEventGroup, PONG_BIT );
+    }
+    prvWorkerDone();
+}
+
+static const TaskFunction_t pxFirstWorker[ testCount ] = { prvQueueProducer, prvMutexWorker, prvEventPing };
+static const TaskFunction_t pxSecondWorker[ testCount ] = { prvQueueConsumer, prvMutexWorker, prvEventPong };
+
+static void prvRun( test_t xTest, UBaseType_t uxSecondCore, const char *pcPlacement )
+{
+    uint64_t ullStartNs, ullElapsedNs;
+
+    ulSharedCounter = 0;
+
+    /* Creating the workers is counted too, it is small next to OPS_PER_RUN
+    operations. With a free core they start running straight away. */
+    ullStartNs = ullBenchTimeNs();
+    xTaskCreatePinned( pxFirstWorker[ xTest ], "Worker1", configMINIMAL_STACK_SIZE, NULL,
+                       WORKER_TASK_PRIORITY, 0, NULL );
+    xTaskCreatePinned( pxSecondWorker[ xTest ], "Worker2", configMINIMAL_STACK_SIZE, NULL,
+                       WORKER_TASK_PRIORITY, uxSecondCore, NULL );
+    for( int i = 0; i < 2; i++ )
+    {
+        ulTaskNotifyTake( pdFALSE, portMAX_DELAY );
+    }
+    ullElapsedNs = ullBenchTimeNs() - ullStartNs;
+
+    printf( "%s,%s,%lu,%llu,%llu\r\n", pcTestNames[ xTest ], pcPlacement, ( unsigned long ) OPS_PER_RUN,
+            ( unsigned long long ) ( ullElapsedNs / 1000 ),
+            ( unsigned long long ) ( ( uint64_t ) OPS_PER_RUN * 1000000000ull / ullElapsedNs ) );
+
+    if( ( xTest == testMutex ) && ( ulSharedCounter != 2 * OPS_PER_RUN ) )
+    {
+        printf( "mutex: counter %lu, expected %lu\r\n", ( unsigned long ) ulSharedCounter,
+                ( unsigned long ) ( 2 * OPS_PER_RUN ) );
+    }
+}
+
+static void prvControlTask( void *pvParameters )
+{
+    printf( "test,placement,ops,elapsed_us,ops_per_s\r\n" );
+
+    for( int iTest = 0; iTest < testCount; iTest++ )
+    {
+        /* Let the idle task free the previous workers first */
+        vTaskDelay( pdMS_TO_TICKS( 10 ) );
+        prvRun( ( test_t ) iTest, 0, "same_core" );
+
+        if( uxSchedulerCores() > 1 )
+        {
+            vTaskDelay( pdMS_TO_TICKS( 10 ) );
+            prvRun( ( test_t ) iTest, 1, "cross_core" );
+        }
+    }
+
+    printf( "done\r\n" );
+#if HOST_POSIX_BUILD
+    exit( EXIT_SUCCESS );
+#endif
+    vTaskDelete( NULL );
+}
+
+int main()
+{
+    stdio_init_all();
+    while(!stdio_usb_connected()){tight_loop_contents();}
+
+    sleep_ms(1000);
+    printf("SMP contention benchmark, %lu core(s)\r\n", ( unsigned long ) uxSchedulerCores());
+
+    xQueue = xQueueCreate( QUEUE_LENGTH, sizeof( uint32_t ) );
+    xMutex = xSemaphoreCreateMutex();
+    xEventGroup = xEventGroupCreate();
+
+    if( ( xQueue != NULL ) && ( xMutex != NULL ) && ( xEventGroup != NULL ) )
+    {
+        /* On core 0 in the _smp variant, so the cross_core runs have core 1 to themselves */
+        xTaskCreatePinned( prvControlTask, "Control", configMINIMAL_STACK_SIZE, NULL, CONTROL_TASK_PRIORITY,
+                           0, &xControlTask );
+
+        vTaskStartScheduler();
+    }
+
+    /* As normal, the following line should never be reached. */
+    for( ;; );
+}
@@ -0,0 +1,300 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <timers.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "bench_time.h"
+#include "timer_wheel.h"
+
+/***************************** Important Notes *********************************
+ * 1) FreeRTOS software timers against common/timer_wheel.h with 10, 1000 and
+ * 10000 timers running, standing in for per-connection timeouts:
+ *
+ * "start":  every timer started with a random period of IDLE_TIMEOUT_MIN to
+ *     IDLE_TIMEOUT_MAX ticks, so none expire during the run.
+ * "reset":  OPS random timers reset, as on traffic on their connection.
+ * "stop":   OPS random timers stopped.
+ * "expire": every timer, stopped or not, given a period of 1 to EXPIRE_WINDOW
+ *     ticks, so all expire within that window. The row is how late the
+ *     callbacks ran, in ticks converted to ns; the wheel handles each tick's
+ *     timers as a batch.
+ *
+ * 2) The daemon task and the wheel's service task run at
+ * configTIMER_TASK_PRIORITY, above the benchmark task, so a timers.h call
+ * includes the daemon task processing the command. mean_ns is the total
+ * time divided by the calls, max_ns the slowest call (1 us steps on the
+ * RP2040).
+ *
+ * 3) The same seed is used for both, so they see the same periods and the same
+ * timers picked. Timers and handles come from the heap; a row that doesn't fit
+ * is printed as out_of_memory, which on the RP2040 is the 10000 timer rows.
+ *******************************************************************************/
+
+#define IDLE_TIMEOUT_MIN        pdMS_TO_TICKS( 10000 )
+#define IDLE_TIMEOUT_MAX        pdMS_TO_TICKS( 20000 )
+#define EXPIRE_WINDOW           100
+#define OPS                     2000
+#define SEED                    0x2545F491u
+#define BENCH_TASK_PRIORITY     2
+
+static const uint32_t ulTimerCounts[] = { 10, 1000, 10000 };
+
+static uint32_t ulRandom;
+static TaskHandle_t xBenchTask;
+
+/* Expire phase, updated by the callbacks */
+static uint32_t ulExpiredCount, ulExpectedCount;
+static uint64_t ullLateTicksSum;
+static uint32_t ulLateTicksMax;
+
+static uint32_t prvRandom( void )
+{
+    ulRandom ^= ulRandom << 13;
+    ulRandom ^= ulRandom >> 17;
+    ulRandom ^= ulRandom << 5;
+    return ulRandom;
+}
+
+static TickType_t prvIdleTimeout( void )
+{
+    return IDLE_TIMEOUT_MIN + prvRandom() % ( IDLE_TIMEOUT_MAX - IDLE_TIMEOUT_MIN );
+}
+
+static void prvPrintRow( const char *pcImpl, uint32_t ulTimers, const char *pcOp, uint32_t ulCalls,
+                         uint64_t ullMeanNs, uint64_t ullMaxNs )
+{
+    printf( "%s,%lu,%s,%lu,%llu,%llu\r\n", pcImpl, ( unsigned long ) ulTimers, pcOp, ( unsigned long ) ulCalls,
+            ( unsigned long long ) ullMeanNs, ( unsigned long long ) ullMaxNs );
+}
+
+/* The timer's ID holds the tick it is due at */
+static void prvExpired( uint32_t ulDueTick )
+{
+    const uint32_t ulLate = ( uint32_t ) xTaskGetTickCount() - ulDueTick;
+
+    ullLateTicksSum += ulLate;
+    if( ulLate > ulLateTicksMax )
+    {
+        ulLateTicksMax = ulLate;
+    }
+    if( ++ulExpiredCount == ulExpectedCount )
+    {
+        xTaskNotifyGive( xBenchTask );
+    }
+}
+
+static void prvTimerCallback( TimerHandle_t xTimer )
+{
+    prvExpired( ( uint32_t ) ( uintptr_t ) pvTimerGetTimerID( xTimer ) );
+}
+
+static void prvWheelCallback( WheelTimerHandle_t xTimer )
+{
+    prvExpired( ( uint32_t ) ( uintptr_t ) pvWheelTimerGetTimerID( xTimer ) );
+}
+
+static void prvExpireStart( uint32_t ulTimers )
+{
+    ulExpiredCount = 0;
+    ulExpectedCount = ulTimers;
+    ullLateTicksSum = 0;
+    ulLateTicksMax = 0;
+}
+
+static void prvExpireEnd( const char *pcImpl, uint32_t ulTimers )
+{
+    const uint64_t ullNsPerTick = 1000000000ull / configTICK_RATE_HZ;
+
+    ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+    prvPrintRow( pcImpl, ulTimers, "expire", ulTimers, ullLateTicksSum * ullNsPerTick / ulTimers,
+                 ( uint64_t ) ulLateTicksMax * ullNsPerTick );
+}
+
+static void prvBenchTimers( uint32_t ulTimers )
+{
+    TimerHandle_t *pxTimers = ( TimerHandle_t * ) pvPortMalloc( ulTimers * sizeof( TimerHandle_t ) );
+    uint64_t ullStartNs, ullCallNs, ullMaxNs;
+    uint32_t ulCreated = 0, i, ulPick;
+    TickType_t xPeriod;
+
+    if( pxTimers != NULL )
+    {
+        for( ; ulCreated < ulTimers; ulCreated++ )
+        {
+            pxTimers[ ulCreated ] = xTimerCreate( "Conn", prvIdleTimeout(), pdFALSE, NULL, prvTimerCallback );
+            if( pxTimers[ ulCreated ] == NULL )
+            {
+                break;
+            }
+        }
+    }
+    if( ulCreated < ulTimers )
+    {
+        printf( "timers,%lu,out_of_memory\r\n", ( unsigned long ) ulTimers );
+        while( ( pxTimers != NULL ) && ( ulCreated > 0 ) )
+        {
+            xTimerDelete( pxTimers[ --ulCreated ], portMAX_DELAY );
+        }
+        vPortFree( pxTimers );
+        return;
+    }
+
+    ullMaxNs = 0;
+    ullStartNs = ullBenchTimeNs();
+    for( i = 0; i < ulTimers; i++ )
+    {
+        ullCallNs = ullBenchTimeNs();
+        xTimerStart( pxTimers[ i ], portMAX_DELAY );
+        ullCallNs = ullBenchTimeNs() - ullCallNs;
+        ullMaxNs = ( ullCallNs > ullMaxNs ) ? ullCallNs : ullMaxNs;
+    }
+    prvPrintRow( "timers", ulTimers, "start", ulTimers, ( ullBenchTimeNs() - ullStartNs ) / ulTimers, ullMaxNs );
+
+    ullMaxNs = 0;
+    ullStartNs = ullBenchTimeNs();
+    for( i = 0; i < OPS; i++ )
+    {
+        ulPick = prvRandom() % ulTimers;
+        ullCallNs = ullBenchTimeNs();
+        xTimerReset( pxTimers[ ulPick ], portMAX_DELAY );
+        ullCallNs = ullBenchTimeNs() - ullCallNs;
+        ullMaxNs = ( ullCallNs > ullMaxNs ) ? ullCallNs : ullMaxNs;
+    }
+    prvPrintRow( "timers", ulTimers, "reset", OPS, ( ullBenchTimeNs() - ullStartNs ) / OPS, ullMaxNs );
+
+    ullMaxNs = 0;
+    ullStartNs = ullBenchTimeNs();
+    for( i = 0; i < OPS; i++ )
+    {
+        ulPick = prvRandom() % ulTimers;
+        ullCallNs = ullBenchTimeNs();
+        xTimerStop( pxTimers[ ulPick ], portMAX_DELAY );
+        ullCallNs = ullBenchTimeNs() - ullCallNs;
+        ullMaxNs = ( ullCallNs > ullMaxNs ) ? ullCallNs : ullMaxNs;
+    }
+    prvPrintRow( "timers", ulTimers, "stop", OPS, ( ullBenchTimeNs() - ullStartNs ) / OPS, ullMaxNs );
+
+    prvExpireStart( ulTimers );
+    for( i = 0; i < ulTimers; i++ )
+    {
+        xPeriod = 1 + prvRandom() % EXPIRE_WINDOW;
+        vTimerSetTimerID( pxTimers[ i ], ( void * ) ( uintptr_t ) ( xTaskGetTickCount() + xPeriod ) );
+        xTimerChangePeriod( pxTimers[ i ], xPeriod, portMAX_DELAY );
+    }
+    prvExpireEnd( "timers", ulTimers );
+
+    for( i = 0; i < ulTimers; i++ )
+    {
+        xTimerDelete( pxTimers[ i ], portMAX_DELAY );
+    }
+    vPortFree( pxTimers );
+}
+
+static void prvBenchWheel( uint32_t ulTimers )
+{
+    WheelTimer_t *pxTimers = ( WheelTimer_t * ) pvPortMalloc( ulTimers * sizeof( WheelTimer_t ) );
+    uint64_t ullStartNs, ullCallNs, ullMaxNs;
+    uint32_t i, ulPick;
+    TickType_t xPeriod;
+
+    if( pxTimers == NULL )
+    {
+        printf( "wheel,%lu,out_of_memory\r\n", ( unsigned long ) ulTimers );
+        return;
+    }
+    for( i = 0; i < ulTimers; i++ )
+    {
+        xWheelTimerInit( &pxTimers[ i ], prvIdleTimeout(), pdFALSE, NULL, prvWheelCallback );
+    }
+
+    ullMaxNs = 0;
+    ullStartNs = ullBenchTimeNs();
+    for( i = 0; i < ulTimers; i++ )
+    {
+        ullCallNs = ullBenchTimeNs();
+        xWheelTimerStart( &pxTimers[ i ] );
+        ullCallNs = ullBenchTimeNs() - ullCallNs;
+        ullMaxNs = ( ullCallNs > ullMaxNs ) ? ullCallNs : ullMaxNs;
+    }
+    prvPrintRow( "wheel", ulTimers, "start", ulTimers, ( ullBenchTimeNs() - ullStartNs ) / ulTimers, ullMaxNs );
+
+    ullMaxNs = 0;
+    ullStartNs = ullBenchTimeNs();
+    for( i = 0; i < OPS; i++ )
+    {
+        ulPick = prvRandom() % ulTimers;
+        ullCallNs = ullBenchTimeNs();
+        xWheelTimerReset( &pxTimers[ ulPick ] );
+        ullCallNs = ullBenchTimeNs() - ullCallNs;
+        ullMaxNs = ( ullCallNs > ullMaxNs ) ? ullCallNs : ullMaxNs;
+    }
+    prvPrintRow( "wheel", ulTimers, "reset", OPS, ( ullBenchTimeNs() - ullStartNs ) / OPS, ullMaxNs );
+
+    ullMaxNs = 0;
+    ullStartNs = ullBenchTimeNs();
+    for( i = 0; i < OPS; i++ )
+    {
+        ulPick = prvRandom() % ulTimers;
+        ullCallNs = ullBenchTimeNs();
+        xWheelTimerStop( &pxTimers[ ulPick ] );
+        ullCallNs = ullBenchTimeNs() - ullCallNs;
+        ullMaxNs = ( ullCallNs > ullMaxNs ) ? ullCallNs : ullMaxNs;
+    }
+    prvPrintRow( "wheel", ulTimers, "stop", OPS, ( ullBenchTimeNs() - ullStartNs ) / OPS, ullMaxNs );
+
+    prvExpireStart( ulTimers );
+    for( i = 0; i < ulTimers; i++ )
+    {
+        xPeriod = 1 + prvRandom() % EXPIRE_WINDOW;
+        vWheelTimerSetTimerID( &pxTimers[ i ], ( void * ) ( uintptr_t ) ( xTaskGetTickCount() + xPeriod ) );
+        xWheelTimerChangePeriod( &pxTimers[ i ], xPeriod );
+    }
+    prvExpireEnd( "wheel", ulTimers );
+
+    /* All one-shot and expired, so none are left on the wheel */
+    vPortFree( pxTimers );
+}
+
+static void prvBenchTask( void *pvParameters )
+{
+    TimerWheelStats_t xStats;
+
+    printf( "impl,timers,op,calls,mean_ns,max_ns\r\n" );
+
+    for( size_t i = 0; i < sizeof( ulTimerCounts ) / sizeof( ulTimerCounts[ 0 ] ); i++ )
+    {
+        ulRandom = SEED;
+        prvBenchTimers( ulTimerCounts[ i ] );
+        ulRandom = SEED;
+        prvBenchWheel( ulTimerCounts[ i ] );
+    }
+
+    vTimerWheelGetStats( &xStats );
+    printf( "wheel: %lu callbacks, %lu cascaded, %lu service task wakes\r\n", ( unsigned long ) xStats.ulExpired,
+            ( unsigned long ) xStats.ulCascaded, ( unsigned long ) xStats.ulServiceWakes );
+
+    printf( "done\r\n" );
+#if HOST_POSIX_BUILD
+    exit( EXIT_SUCCESS );
+#endif
+    vTaskDelete( NULL );
+}
+
+int main()
+{
+    stdio_init_all();
+    while(!stdio_usb_connected()){tight_loop_contents();}
+
+    sleep_ms(1000);
+    printf("Timer wheel benchmark\r\n");
+
+    vTimerWheelStart( configTIMER_TASK_PRIORITY );
+    xTaskCreate( prvBenchTask, "Bench", configMINIMAL_STACK_SIZE, NULL, BENCH_TASK_PRIORITY, &xBenchTask );
+
+    vTaskStartScheduler();
+
+    /* As normal, the following line should never be reached. */
+    for( ;; );
+}
@@ -23,7 +23,7 @@ int main()
         printf("Wi-Fi init failed");
         return -1;
     }
-    xTaskCreate((TaskFunction_t)led_task, "LED_Task", 256, NULL, 1, NULL);
+    xTaskCreate((TaskFunction_t)led_task, "LED_Task", configMINIMAL_STACK_SIZE, NULL, 1, NULL);
     vTaskStartScheduler();
 
     while(1){};
@@ -0,0 +1,235 @@
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include "batch_queue.h"
+
+BatchQueue_t *pxBatchQueueCreate( uint32_t ulLength, size_t xItemSize )
+{
+    BatchQueue_t *pxQueue;
+
+    configASSERT( ( ulLength > 0 ) && ( xItemSize > 0 ) );
+
+    /* One allocation for the control block and the items, as xQueueCreate() does */
+    pxQueue = ( BatchQueue_t * ) pvPortMalloc( sizeof( BatchQueue_t ) + ulLength * xItemSize );
+    if( pxQueue == NULL )
+    {
+        return NULL;
+    }
+
+    pxQueue->pucStorage = ( uint8_t * ) ( pxQueue + 1 );
+    pxQueue->xItemSize = xItemSize;
+    pxQueue->ulLength = ulLength;
+    pxQueue->ulReadIndex = 0;
+    pxQueue->ulCount = 0;
+    pxQueue->ulSendersWaiting = 0;
+    pxQueue->ulReceiversWaiting = 0;
+    pxQueue->xSpaceAvailable = xSemaphoreCreateBinary();
+    pxQueue->xItemsAvailable = xSemaphoreCreateBinary();
+
+    if( ( pxQueue->xSpaceAvailable == NULL ) || ( pxQueue->xItemsAvailable == NULL ) )
+    {
+        vBatchQueueDelete( pxQueue );
+        return NULL;
+    }
+    return pxQueue;
+}
+
+void vBatchQueueDelete( BatchQueue_t *pxQueue )
+{
+    if( pxQueue->xSpaceAvailable != NULL )
+    {
+        vSemaphoreDelete( pxQueue->xSpaceAvailable );
+    }
+    if( pxQueue->xItemsAvailable != NULL )
+    {
+        vSemaphoreDelete( pxQueue->xItemsAvailable );
+    }
+    vPortFree( pxQueue );
+}
+
+/* The following run with interrupts masked. Each copies at most two runs,
+either side of the end of the storage. */
+static uint32_t prvCopyIn( BatchQueue_t *pxQueue, const uint8_t *pucItems, uint32_t ulCount )
+{
+    const uint32_t ulWriteIndex = ( pxQueue->ulReadIndex + pxQueue->ulCount ) % pxQueue->ulLength;
+    uint32_t ulFirst;
+
+    if( ulCount > pxQueue->ulLength - pxQueue->ulCount )
+    {
+        ulCount = pxQueue->ulLength - pxQueue->ulCount;
+    }
+    ulFirst = ( ulCount < pxQueue->ulLength - ulWriteIndex ) ? ulCount : pxQueue->ulLength - ulWriteIndex;
+
+    memcpy( &pxQueue->pucStorage[ ulWriteIndex * pxQueue->xItemSize ], pucItems, ulFirst * pxQueue->xItemSize );
+    memcpy( pxQueue->pucStorage, &pucItems[ ulFirst * pxQueue->xItemSize ], ( ulCount - ulFirst ) * pxQueue->xItemSize );
+    pxQueue->ulCount += ulCount;
+
+    return ulCount;
+}
+
+static uint32_t prvCopyOut( BatchQueue_t *pxQueue, uint8_t *pucBuffer, uint32_t ulMaxCount )
+{
+    const uint32_t ulCount = ( ulMaxCount < pxQueue->ulCount ) ? ulMaxCount : pxQueue->ulCount;
+    const uint32_t ulToEnd = pxQueue->ulLength - pxQueue->ulReadIndex;
+    const uint32_t ulFirst = ( ulCount < ulToEnd ) ? ulCount : ulToEnd;
+
+    memcpy( pucBuffer, &pxQueue->pucStorage[ pxQueue->ulReadIndex * pxQueue->xItemSize ], ulFirst * pxQueue->xItemSize );
+    memcpy( &pucBuffer[ ulFirst * pxQueue->xItemSize ], pxQueue->pucStorage, ( ulCount - ulFirst ) * pxQueue->xItemSize );
+    pxQueue->ulReadIndex = ( pxQueue->ulReadIndex + ulCount ) % pxQueue->ulLength;
+    pxQueue->ulCount -= ulCount;
+
+    return ulCount;
+}
+
+uint32_t ulBatchQueueSend( BatchQueue_t *pxQueue, const void *pvItems, uint32_t ulCount,
+                           TickType_t xTicksToWait )
+{
+    TimeOut_t xTimeOut;
+    BaseType_t xWaited = pdFALSE;
+    BaseType_t xWakeReceiver, xWakeSender;
+    uint32_t ulSent;
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    for( ;; )
+    {
+        taskENTER_CRITICAL();
+        {
+            if( xWaited != pdFALSE )
+            {
+                pxQueue->ulSendersWaiting--;
+            }
+
+            ulSent = prvCopyIn( pxQueue, ( const uint8_t * ) pvItems, ulCount );
+            xWakeReceiver = ( ulSent > 0 ) && ( pxQueue->ulReceiversWaiting > 0 );
+            /* Space left over for the next blocked sender */
+            xWakeSender = ( ulSent > 0 ) && ( pxQueue->ulCount < pxQueue->ulLength ) &&
+                          ( pxQueue->ulSendersWaiting > 0 );
+
+            xWaited = ( ulSent == 0 ) && ( xTicksToWait > 0 );
+            if( xWaited != pdFALSE )
+            {
+                pxQueue->ulSendersWaiting++;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( ulSent > 0 )
+        {
+            if( xWakeReceiver != pdFALSE )
+            {
+                xSemaphoreGive( pxQueue->xItemsAvailable );
+            }
+            if( xWakeSender != pdFALSE )
+            {
+                xSemaphoreGive( pxQueue->xSpaceAvailable );
+            }
+            return ulSent;
+        }
+        if( xWaited == pdFALSE )
+        {
+            return 0;
+        }
+
+        xSemaphoreTake( pxQueue->xSpaceAvailable, xTicksToWait );
+
+        /* Woken or timed out, either way try once more. A give left over from
+        an earlier wait only costs a spurious pass round the loop. */
+        if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+        {
+            xTicksToWait = 0;
+        }
+    }
+}
+
+uint32_t ulBatchQueueSendFromISR( BatchQueue_t *pxQueue, const void *pvItems, uint32_t ulCount,
+                                  BaseType_t *pxHigherPriorityTaskWoken )
+{
+    UBaseType_t uxSavedInterruptStatus;
+    BaseType_t xWakeReceiver;
+    uint32_t ulSent;
+
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    {
+        ulSent = prvCopyIn( pxQueue, ( const uint8_t * ) pvItems, ulCount );
+        xWakeReceiver = ( ulSent > 0 ) && ( pxQueue->ulReceiversWaiting > 0 );
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    if( xWakeReceiver != pdFALSE )
+    {
+        xSemaphoreGiveFromISR( pxQueue->xItemsAvailable, pxHigherPriorityTaskWoken );
+    }
+    return ulSent;
+}
+
+uint32_t ulBatchQueueReceive( BatchQueue_t *pxQueue, void *pvBuffer, uint32_t ulMaxCount,
+                              TickType_t xTicksToWait )
+{
+    TimeOut_t xTimeOut;
+    BaseType_t xWaited = pdFALSE;
+    BaseType_t xWakeSender, xWakeReceiver;
+    uint32_t ulReceived;
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    for( ;; )
+    {
+        taskENTER_CRITICAL();
+        {
+            if( xWaited != pdFALSE )
+            {
+                pxQueue->ulReceiversWaiting--;
+            }
+
+            ulReceived = prvCopyOut( pxQueue, ( uint8_t * ) pvBuffer, ulMaxCount );
+            xWakeSender = ( ulReceived > 0 ) && ( pxQueue->ulSendersWaiting > 0 );
+            /* Items left over for the next blocked receiver */
+            xWakeReceiver = ( ulReceived > 0 ) && ( pxQueue->ulCount > 0 ) &&
+                            ( pxQueue->ulReceiversWaiting > 0 );
+
+            xWaited = ( ulReceived == 0 ) && ( xTicksToWait > 0 );
+            if( xWaited != pdFALSE )
+            {
+                pxQueue->ulReceiversWaiting++;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( ulReceived > 0 )
+        {
+            if( xWakeSender != pdFALSE )
+            {
+                xSemaphoreGive( pxQueue->xSpaceAvailable );
+            }
+            if( xWakeReceiver != pdFALSE )
+            {
+                xSemaphoreGive( pxQueue->xItemsAvailable );
+            }
+            return ulReceived;
+        }
+        if( xWaited == pdFALSE )
+        {
+            return 0;
+        }
+
+        xSemaphoreTake( pxQueue->xItemsAvailable, xTicksToWait );
+
+        if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+        {
+            xTicksToWait = 0;
+        }
+    }
+}
+
+uint32_t ulBatchQueueMessagesWaiting( BatchQueue_t *pxQueue )
+{
+    uint32_t ulCount;
+
+    taskENTER_CRITICAL();
+    ulCount = pxQueue->ulCount;
+    taskEXIT_CRITICAL();
+
+    return ulCount;
+}
@@ -0,0 +1,69 @@
+#ifndef BATCH_QUEUE_H
+#define BATCH_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <FreeRTOS.h>
+#include <semphr.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) xQueueSendToBack() and xQueueReceive() move one item per call, and every
+ * call pays for a critical section, the checks for blocked tasks and possibly
+ * a context switch. For small items that overhead is most of the cost. A batch
+ * queue holds the same fixed-size items, but moves up to N of them in one
+ * critical section, and a call wakes at most one blocked task on either side.
+ *
+ * 2) Partial success: ulBatchQueueSend() copies as many of the items as there
+ * is space for and returns how many it took, ulBatchQueueReceive() returns up
+ * to ulMaxCount of the items waiting. They only block (up to xTicksToWait)
+ * when not even one item can be moved, so a caller moving a fixed number of
+ * items loops until they all went through.
+ *
+ * 3) Items are copied with interrupts masked, so the number of items per call
+ * times the item size bounds the added interrupt latency. Keep batches of
+ * large items small.
+ *
+ * 4) Like a queue, any number of tasks can send and receive. Blocked tasks
+ * wait on a binary semaphore each for space and for items, so the highest
+ * priority one is woken first; a woken task that leaves space (or items)
+ * behind wakes the next one.
+ *******************************************************************************/
+
+typedef struct
+{
+    uint8_t *pucStorage;
+    size_t xItemSize;
+    uint32_t ulLength;
+    uint32_t ulReadIndex;
+    uint32_t ulCount;
+    uint32_t ulSendersWaiting;
+    uint32_t ulReceiversWaiting;
+    SemaphoreHandle_t xSpaceAvailable;
+    SemaphoreHandle_t xItemsAvailable;
+} BatchQueue_t;
+
+/* Allocated with pvPortMalloc(), like xQueueCreate(). NULL if out of heap. */
+BatchQueue_t *pxBatchQueueCreate( uint32_t ulLength, size_t xItemSize );
+void vBatchQueueDelete( BatchQueue_t *pxQueue );
+
+/* Number of items sent, 0 if the queue stayed full for xTicksToWait. */
+uint32_t ulBatchQueueSend( BatchQueue_t *pxQueue, const void *pvItems, uint32_t ulCount,
+                           TickType_t xTicksToWait );
+uint32_t ulBatchQueueSendFromISR( BatchQueue_t *pxQueue, const void *pvItems, uint32_t ulCount,
+                                  BaseType_t *pxHigherPriorityTaskWoken );
+
+/* Number of items received, 0 if the queue stayed empty for xTicksToWait. */
+uint32_t ulBatchQueueReceive( BatchQueue_t *pxQueue, void *pvBuffer, uint32_t ulMaxCount,
+                              TickType_t xTicksToWait );
+
+uint32_t ulBatchQueueMessagesWaiting( BatchQueue_t *pxQueue );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BATCH_QUEUE_H */
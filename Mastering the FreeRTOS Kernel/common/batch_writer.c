@@ -0,0 +1,316 @@
+#include <stdio.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include "pico/time.h"
+#include "batch_writer.h"
+#include "static_alloc.h"
+
+#define WRITER_TASK_STACK_SIZE  configMINIMAL_STACK_SIZE
+#define REPORT_LINE_LENGTH      160
+
+/* The timed messages of one source that end in a buffer. Send times are kept
+relative to the buffer's first one, so they can be summed across a wrap of
+time_us_32(). */
+typedef struct
+{
+    uint32_t ulCount;
+    int32_t lOldestUs;
+    int64_t llSumUs;
+} SourceTimes_t;
+
+typedef struct
+{
+    char cData[ batchwriterBUFFER_SIZE ];
+    size_t xLength;
+    uint32_t ulMessages;                /* Started in this buffer */
+    uint32_t ulBaseUs;                  /* Send time of the first timed message */
+    uint32_t ulTimed;
+    SourceTimes_t xSources[ batchwriterMAX_SOURCES ];
+} OutBuffer_t;
+
+static OutBuffer_t xBuffers[ 2 ];
+static OutBuffer_t *pxFilling = &xBuffers[ 0 ];
+static OutBuffer_t *volatile pxHanded;  /* The one the writer task is sending */
+
+static TaskHandle_t xWriterTask;
+static SemaphoreHandle_t xWriterIdle;   /* Given by the writer when done with pxHanded */
+
+static TickType_t xFlushDeadline;
+static TickType_t xFirstTick;           /* Of the oldest byte in pxFilling */
+static TickType_t xReportPeriod;
+static TickType_t xLastReport;
+
+static BatchWriterStats_t xStats;
+static BatchWriterStats_t xReported;
+static BatchWriterLatency_t xLatency[ batchwriterMAX_SOURCES ];
+
+/* In the writer task, once the buffer has gone out */
+static void prvAddLatencies( OutBuffer_t *pxBuffer, uint32_t ulDoneUs )
+{
+    const int64_t llDoneUs = ( int32_t ) ( ulDoneUs - pxBuffer->ulBaseUs );
+    SourceTimes_t *pxSource;
+    BatchWriterLatency_t *pxLatency;
+
+    taskENTER_CRITICAL();
+    {
+        for( UBaseType_t i = 0; i < batchwriterMAX_SOURCES; i++ )
+        {
+            pxSource = &pxBuffer->xSources[ i ];
+            pxLatency = &xLatency[ i ];
+            if( pxSource->ulCount == 0 )
+            {
+                continue;
+            }
+
+            pxLatency->ulWritten += pxSource->ulCount;
+            pxLatency->ullSumUs += ( uint64_t ) ( llDoneUs * pxSource->ulCount - pxSource->llSumUs );
+            if( ( uint32_t ) ( llDoneUs - pxSource->lOldestUs ) > pxLatency->ulMaxUs )
+            {
+                pxLatency->ulMaxUs = ( uint32_t ) ( llDoneUs - pxSource->lOldestUs );
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    pxBuffer->ulTimed = 0;
+    memset( pxBuffer->xSources, 0, sizeof( pxBuffer->xSources ) );
+}
+
+static void prvWriterTask( void *pvParameters )
+{
+    OutBuffer_t *pxBuffer;
+    uint64_t ullStartUs;
+
+    for( ;; )
+    {
+        ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        pxBuffer = pxHanded;
+
+        /* One transfer for the whole batch */
+        ullStartUs = time_us_64();
+        fwrite( pxBuffer->cData, 1, pxBuffer->xLength, stdout );
+        fflush( stdout );
+
+        taskENTER_CRITICAL();
+        {
+            xStats.ulWriteUs += ( uint32_t ) ( time_us_64() - ullStartUs );
+        }
+        taskEXIT_CRITICAL();
+
+        if( pxBuffer->ulTimed > 0 )
+        {
+            prvAddLatencies( pxBuffer, time_us_32() );
+        }
+
+        pxBuffer->xLength = 0;
+        pxBuffer->ulMessages = 0;
+        xSemaphoreGive( xWriterIdle );
+    }
+}
+
+static void prvHandOver( BaseType_t xFull )
+{
+    /* The writer may still be sending the other buffer */
+    xSemaphoreTake( xWriterIdle, portMAX_DELAY );
+
+    taskENTER_CRITICAL();
+    {
+        xStats.ulFlushes++;
+        xStats.ulFullFlushes += ( xFull != pdFALSE );
+        if( pxFilling->ulMessages > xStats.ulMaxMessagesPerFlush )
+        {
+            xStats.ulMaxMessagesPerFlush = pxFilling->ulMessages;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    pxHanded = pxFilling;
+    pxFilling = ( pxFilling == &xBuffers[ 0 ] ) ? &xBuffers[ 1 ] : &xBuffers[ 0 ];
+    xTaskNotifyGive( xWriterTask );
+}
+
+/* Counts a timed message in the buffer its last byte went to, before that
+buffer can be handed over */
+static void prvRecordSend( UBaseType_t uxSource, uint32_t ulSentUs )
+{
+    SourceTimes_t *pxSource = &pxFilling->xSources[ uxSource ];
+    int32_t lSentUs;
+
+    if( pxFilling->ulTimed++ == 0 )
+    {
+        pxFilling->ulBaseUs = ulSentUs;
+    }
+    lSentUs = ( int32_t ) ( ulSentUs - pxFilling->ulBaseUs );
+
+    if( ( pxSource->ulCount == 0 ) || ( lSentUs < pxSource->lOldestUs ) )
+    {
+        pxSource->lOldestUs = lSentUs;
+    }
+    pxSource->ulCount++;
+    pxSource->llSumUs += lSentUs;
+}
+
+/* Copies, handing over each buffer it fills. uxSource is
+batchwriterMAX_SOURCES for an untimed write. */
+static void prvAppend( const char *pcData, size_t xLength, UBaseType_t uxSource, uint32_t ulSentUs )
+{
+    size_t xChunk;
+
+    while( xLength > 0 )
+    {
+        if( pxFilling->xLength == 0 )
+        {
+            xFirstTick = xTaskGetTickCount();
+        }
+        xChunk = batchwriterBUFFER_SIZE - pxFilling->xLength;
+        xChunk = ( xLength < xChunk ) ? xLength : xChunk;
+
+        memcpy( &pxFilling->cData[ pxFilling->xLength ], pcData, xChunk );
+        pxFilling->xLength += xChunk;
+        pcData += xChunk;
+        xLength -= xChunk;
+
+        if( ( xLength == 0 ) && ( uxSource < batchwriterMAX_SOURCES ) )
+        {
+            prvRecordSend( uxSource, ulSentUs );
+        }
+        if( pxFilling->xLength == batchwriterBUFFER_SIZE )
+        {
+            prvHandOver( pdTRUE );
+        }
+    }
+}
+
+static void prvWrite( const char *pcData, size_t xLength, UBaseType_t uxSource, uint32_t ulSentUs )
+{
+    /* Counted in the buffer it starts in */
+    pxFilling->ulMessages++;
+
+    taskENTER_CRITICAL();
+    {
+        xStats.ulMessages++;
+        xStats.ulBytes += xLength;
+    }
+    taskEXIT_CRITICAL();
+
+    prvAppend( pcData, xLength, uxSource, ulSentUs );
+}
+
+void vBatchWriterWrite( const char *pcData, size_t xLength )
+{
+    prvWrite( pcData, xLength, batchwriterMAX_SOURCES, 0 );
+}
+
+void vBatchWriterWriteTimed( const char *pcData, size_t xLength, UBaseType_t uxSource, uint32_t ulSentUs )
+{
+    configASSERT( uxSource < batchwriterMAX_SOURCES );
+    prvWrite( pcData, xLength, uxSource, ulSentUs );
+}
+
+void vBatchWriterFlush( void )
+{
+    if( pxFilling->xLength > 0 )
+    {
+        prvHandOver( pdFALSE );
+    }
+}
+
+static void prvReport( TickType_t xNow )
+{
+    const uint32_t ulPeriodMs = ( uint32_t ) ( ( uint64_t ) xReportPeriod * 1000 / configTICK_RATE_HZ );
+    char cLine[ REPORT_LINE_LENGTH ];
+    BatchWriterStats_t xNowStats;
+    uint32_t ulFlushes;
+    int iLength;
+
+    vBatchWriterGetStats( &xNowStats );
+    ulFlushes = xNowStats.ulFlushes - xReported.ulFlushes;
+
+    iLength = snprintf( cLine, sizeof( cLine ), "gk,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\r\n",
+                        ( unsigned long ) ( ( uint64_t ) xNow * 1000 / configTICK_RATE_HZ ),
+                        ( unsigned long ) ( ( uint64_t ) ( xNowStats.ulBytes - xReported.ulBytes ) * 1000 / ulPeriodMs ),
+                        ( unsigned long ) ( xNowStats.ulMessages - xReported.ulMessages ),
+                        ( unsigned long ) ulFlushes,
+                        ( unsigned long ) ( xNowStats.ulFullFlushes - xReported.ulFullFlushes ),
+                        ( unsigned long ) ( ulFlushes ? ( xNowStats.ulMessages - xReported.ulMessages ) / ulFlushes : 0 ),
+                        ( unsigned long ) xNowStats.ulMaxMessagesPerFlush,
+                        ( unsigned long ) ( ulFlushes ? ( xNowStats.ulWriteUs - xReported.ulWriteUs ) / ulFlushes : 0 ) );
+    xReported = xNowStats;
+
+    /* Not a message, it is not counted */
+    if( iLength > 0 )
+    {
+        prvAppend( cLine, ( ( size_t ) iLength < sizeof( cLine ) ) ? ( size_t ) iLength : sizeof( cLine ) - 1,
+                   batchwriterMAX_SOURCES, 0 );
+    }
+}
+
+TickType_t xBatchWriterService( void )
+{
+    const TickType_t xNow = xTaskGetTickCount();
+    TickType_t xWait = portMAX_DELAY, xElapsed;
+
+    if( xReportPeriod != 0 )
+    {
+        if( ( TickType_t ) ( xNow - xLastReport ) >= xReportPeriod )
+        {
+            xLastReport += xReportPeriod;
+            if( ( TickType_t ) ( xNow - xLastReport ) >= xReportPeriod )
+            {
+                /* Blocked for periods, don't report them all at once */
+                xLastReport = xNow;
+            }
+            prvReport( xNow );
+        }
+        xWait = xReportPeriod - ( TickType_t ) ( xNow - xLastReport );
+    }
+
+    if( pxFilling->xLength > 0 )
+    {
+        xElapsed = xNow - xFirstTick;
+        if( xElapsed >= xFlushDeadline )
+        {
+            prvHandOver( pdFALSE );
+        }
+        else if( xFlushDeadline - xElapsed < xWait )
+        {
+            xWait = xFlushDeadline - xElapsed;
+        }
+    }
+    return xWait;
+}
+
+void vBatchWriterGetStats( BatchWriterStats_t *pxStats )
+{
+    taskENTER_CRITICAL();
+    {
+        *pxStats = xStats;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void vBatchWriterGetLatency( UBaseType_t uxSource, BatchWriterLatency_t *pxLatency )
+{
+    configASSERT( uxSource < batchwriterMAX_SOURCES );
+
+    taskENTER_CRITICAL();
+    {
+        *pxLatency = xLatency[ uxSource ];
+    }
+    taskEXIT_CRITICAL();
+}
+
+void vBatchWriterStart( UBaseType_t uxPriority, TickType_t xDeadline, TickType_t xPeriod )
+{
+    xFlushDeadline = xDeadline;
+    xReportPeriod = xPeriod;
+    xLastReport = xTaskGetTickCount();
+
+    xWriterIdle = xExampleSemaphoreCreateBinary();
+    configASSERT( xWriterIdle != NULL );
+    xSemaphoreGive( xWriterIdle );
+
+    xExampleTaskCreate( prvWriterTask, "Writer", WRITER_TASK_STACK_SIZE, NULL, uxPriority, &xWriterTask );
+}
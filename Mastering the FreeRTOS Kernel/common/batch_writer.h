@@ -0,0 +1,93 @@
+#ifndef BATCH_WRITER_H
+#define BATCH_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <FreeRTOS.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) Output for a gatekeeper task: instead of a putchar() per character, the
+ * gatekeeper copies each message into one of two buffers, and a writer task
+ * sends a whole buffer to stdout with a single fwrite(), one USB CDC (or
+ * host write()) transfer, while the gatekeeper fills the other one. The
+ * writer task stands in for a DMA channel: the pico-sdk's USB stdio has none.
+ *
+ * 2) A buffer is handed to the writer when it is full, or when its first
+ * message has waited xFlushDeadline, so a quiet system still prints within
+ * the deadline. The gatekeeper calls xBatchWriterService() after each
+ * message and blocks on its queue no longer than it returns.
+ *
+ * 3) Only the gatekeeper, one task, may call vBatchWriterWrite() and
+ * xBatchWriterService(). When the writer is still busy with the other buffer
+ * the gatekeeper waits for it: the output rate is then the writer's.
+ *
+ * 4) If a report period is given, xBatchWriterService() adds one line per
+ * period to the output itself, so the gatekeeper stays the only one writing:
+ *
+ *   gk,<uptime_ms>,<bytes_per_s>,<messages>,<flushes>,<full_flushes>,<msgs_per_flush>,<max_msgs_per_flush>,<write_us_per_flush>
+ *
+ * All but max_msgs_per_flush are for the period. full_flushes is how many
+ * flushes filled a buffer, the rest were due to the deadline.
+ *
+ * 5) vBatchWriterWriteTimed() also takes the time the message was sent to the
+ * gatekeeper and one of batchwriterMAX_SOURCES sources. Once the fwrite() that
+ * carries the end of the message returns, the writer task adds the latency
+ * from the send to that moment to the source's totals, so it includes the
+ * wait for the flush. Per buffer only a count, the sum and the oldest send
+ * time of each source are kept, not a time per message.
+ *******************************************************************************/
+
+#ifndef batchwriterBUFFER_SIZE
+#define batchwriterBUFFER_SIZE      512
+#endif
+#define batchwriterMAX_SOURCES      4
+
+typedef struct
+{
+    uint32_t ulMessages;
+    uint32_t ulBytes;
+    uint32_t ulFlushes;
+    uint32_t ulFullFlushes;
+    uint32_t ulMaxMessagesPerFlush;
+    uint32_t ulWriteUs;                 /* Time in fwrite(), in the writer task */
+} BatchWriterStats_t;
+
+typedef struct
+{
+    uint32_t ulWritten;                 /* Timed messages written out */
+    uint32_t ulMaxUs;
+    uint64_t ullSumUs;
+} BatchWriterLatency_t;
+
+/* Creates the writer task at uxPriority. xReportPeriod 0 for no report lines. */
+void vBatchWriterStart( UBaseType_t uxPriority, TickType_t xFlushDeadline, TickType_t xReportPeriod );
+
+/* Copies one message into the filling buffer, see note 3. */
+void vBatchWriterWrite( const char *pcData, size_t xLength );
+
+/* As vBatchWriterWrite(), timing the message from ulSentUs (time_us_32()) to
+its output for uxSource, see note 5. */
+void vBatchWriterWriteTimed( const char *pcData, size_t xLength, UBaseType_t uxSource, uint32_t ulSentUs );
+
+/* Flushes the buffer if its deadline has passed and adds a report line if
+one is due. Returns the ticks until either is next due, portMAX_DELAY if
+neither can be. */
+TickType_t xBatchWriterService( void );
+
+/* Hands the filling buffer to the writer now */
+void vBatchWriterFlush( void );
+
+void vBatchWriterGetStats( BatchWriterStats_t *pxStats );
+
+/* Totals since the start of the messages written with uxSource */
+void vBatchWriterGetLatency( UBaseType_t uxSource, BatchWriterLatency_t *pxLatency );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BATCH_WRITER_H */
@@ -0,0 +1,44 @@
+#include <stdlib.h>
+#include "bench_stats.h"
+
+void vBenchSamplesInit( BenchSamples_t *pxSamples, uint32_t *pulBuffer, size_t xCapacity )
+{
+    pxSamples->pulSamples = pulBuffer;
+    pxSamples->xCapacity = xCapacity;
+    pxSamples->xCount = 0;
+    pxSamples->xOverflow = 0;
+}
+
+static int prvCompare( const void *pvA, const void *pvB )
+{
+    uint32_t ulA = *( const uint32_t * ) pvA;
+    uint32_t ulB = *( const uint32_t * ) pvB;
+    return ( ulA > ulB ) - ( ulA < ulB );
+}
+
+void vBenchSamplesSummarise( BenchSamples_t *pxSamples, BenchSummary_t *pxSummary )
+{
+    const size_t xCount = pxSamples->xCount;
+    uint64_t ullSum = 0;
+
+    pxSummary->xCount = xCount;
+    if( xCount == 0 )
+    {
+        pxSummary->ulMin = pxSummary->ulMedian = pxSummary->ulP99 = pxSummary->ulMax = pxSummary->ulMean = 0;
+        return;
+    }
+
+    qsort( pxSamples->pulSamples, xCount, sizeof( uint32_t ), prvCompare );
+
+    for( size_t i = 0; i < xCount; i++ )
+    {
+        ullSum += pxSamples->pulSamples[ i ];
+    }
+
+    /* Nearest-rank percentiles */
+    pxSummary->ulMin = pxSamples->pulSamples[ 0 ];
+    pxSummary->ulMedian = pxSamples->pulSamples[ ( xCount - 1 ) / 2 ];
+    pxSummary->ulP99 = pxSamples->pulSamples[ ( xCount * 99 + 99 ) / 100 - 1 ];
+    pxSummary->ulMax = pxSamples->pulSamples[ xCount - 1 ];
+    pxSummary->ulMean = ( uint32_t ) ( ullSum / xCount );
+}
@@ -0,0 +1,54 @@
+#ifndef BENCH_STATS_H
+#define BENCH_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Collects up to xCapacity samples into a caller supplied buffer, so a
+benchmark decides up front how much RAM it spends. Samples past the capacity
+are counted but not stored. */
+typedef struct
+{
+    uint32_t *pulSamples;
+    size_t xCapacity;
+    size_t xCount;
+    size_t xOverflow;
+} BenchSamples_t;
+
+typedef struct
+{
+    size_t xCount;
+    uint32_t ulMin;
+    uint32_t ulMedian;
+    uint32_t ulP99;
+    uint32_t ulMax;
+    uint32_t ulMean;
+} BenchSummary_t;
+
+void vBenchSamplesInit( BenchSamples_t *pxSamples, uint32_t *pulBuffer, size_t xCapacity );
+
+/* Not thread safe, use from one task (or ISR) at a time. */
+static inline void vBenchSamplesAdd( BenchSamples_t *pxSamples, uint32_t ulSample )
+{
+    if( pxSamples->xCount < pxSamples->xCapacity )
+    {
+        pxSamples->pulSamples[ pxSamples->xCount++ ] = ulSample;
+    }
+    else
+    {
+        pxSamples->xOverflow++;
+    }
+}
+
+/* Sorts the samples in place and fills in pxSummary. */
+void vBenchSamplesSummarise( BenchSamples_t *pxSamples, BenchSummary_t *pxSummary );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_STATS_H */
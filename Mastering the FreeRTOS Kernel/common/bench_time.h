@@ -0,0 +1,61 @@
+#ifndef BENCH_TIME_H
+#define BENCH_TIME_H
+
+#include <stdint.h>
+#include "pico/stdlib.h"
+
+#if HOST_POSIX_BUILD
+#include <time.h>
+#else
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Nanosecond timestamp for the benchmarks. On the RP2040 this is the 64-bit
+microsecond timer, so the resolution is 1000 ns; on the host it is
+CLOCK_MONOTONIC. Safe to call from an ISR. */
+static inline uint64_t ullBenchTimeNs( void )
+{
+#if HOST_POSIX_BUILD
+    struct timespec xNow;
+    clock_gettime( CLOCK_MONOTONIC, &xNow );
+    return ( uint64_t ) xNow.tv_sec * 1000000000u + ( uint64_t ) xNow.tv_nsec;
+#else
+    return time_us_64() * 1000u;
+#endif
+}
+
+/* For sections far shorter than a tick, e.g. one pvPortMalloc(), where 1 us
+steps are too coarse. On the RP2040 this is the SysTick current value, which
+the port runs from clk_sys and reloads every tick, so a difference is in clk_sys
+cycles; on the host it is CLOCK_MONOTONIC. Only compare two stamps with
+ulBenchFineElapsedNs(), and only across less than one tick. */
+static inline uint32_t ulBenchFineStamp( void )
+{
+#if HOST_POSIX_BUILD
+    return ( uint32_t ) ullBenchTimeNs();
+#else
+    return systick_hw->cvr;
+#endif
+}
+
+static inline uint32_t ulBenchFineElapsedNs( uint32_t ulStart, uint32_t ulEnd )
+{
+#if HOST_POSIX_BUILD
+    return ulEnd - ulStart;
+#else
+    /* SysTick counts down from rvr to 0 */
+    uint32_t ulCycles = ( ulStart >= ulEnd ) ? ( ulStart - ulEnd ) : ( ulStart + systick_hw->rvr + 1u - ulEnd );
+    return ( uint32_t ) ( ( uint64_t ) ulCycles * 1000000000u / clock_get_hz( clk_sys ) );
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_TIME_H */
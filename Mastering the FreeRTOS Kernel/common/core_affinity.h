@@ -0,0 +1,55 @@
+#ifndef CORE_AFFINITY_H
+#define CORE_AFFINITY_H
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Restricts xTask to run on core uxCore only. Does nothing unless the kernel
+has core affinity, i.e. outside the <example>_smp targets (FreeRTOSConfig.h),
+so examples can pin their tasks unconditionally. */
+static inline void vPinTaskToCore( TaskHandle_t xTask, UBaseType_t uxCore )
+{
+#if FREE_RTOS_KERNEL_SMP && ( configUSE_CORE_AFFINITY == 1 )
+    vTaskCoreAffinitySet( xTask, ( UBaseType_t ) 1 << uxCore );
+#else
+    ( void ) xTask;
+    ( void ) uxCore;
+#endif
+}
+
+/* xTaskCreate() for a task that must only ever run on core uxCore. Once the
+scheduler runs, creating the task and then pinning it would let the other core
+pick it up in between. */
+static inline BaseType_t xTaskCreatePinned( TaskFunction_t pxTaskCode, const char *pcName,
+                                            configSTACK_DEPTH_TYPE uxStackDepth, void *pvParameters,
+                                            UBaseType_t uxPriority, UBaseType_t uxCore,
+                                            TaskHandle_t *pxCreatedTask )
+{
+#if FREE_RTOS_KERNEL_SMP && ( configUSE_CORE_AFFINITY == 1 )
+    return xTaskCreateAffinitySet( pxTaskCode, pcName, uxStackDepth, pvParameters, uxPriority,
+                                   ( UBaseType_t ) 1 << uxCore, pxCreatedTask );
+#else
+    ( void ) uxCore;
+    return xTaskCreate( pxTaskCode, pcName, uxStackDepth, pvParameters, uxPriority, pxCreatedTask );
+#endif
+}
+
+/* The number of cores tasks are scheduled on */
+static inline UBaseType_t uxSchedulerCores( void )
+{
+#if FREE_RTOS_KERNEL_SMP
+    return configNUM_CORES;
+#else
+    return 1;
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CORE_AFFINITY_H */
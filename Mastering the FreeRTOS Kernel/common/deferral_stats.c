@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "deferral_stats.h"
+#include "reporter.h"
+
+DeferralStats_t xDeferralStats;
+
+static uint32_t ulReportPeriodMs;
+static DeferralStats_t xLast;
+
+static void prvPrintTotals( void )
+{
+    printf( "deferral totals: raised=%lu dropped=%lu handled=%lu wakes=%lu\r\n",
+            ( unsigned long ) xDeferralStats.ulRaised,
+            ( unsigned long ) xDeferralStats.ulDropped,
+            ( unsigned long ) xDeferralStats.ulHandled,
+            ( unsigned long ) xDeferralStats.ulWakes );
+}
+
+static void prvReportStart( TickType_t xWakeTime )
+{
+    ( void ) xWakeTime;
+    xLast = xDeferralStats;
+}
+
+static void prvReport( TickType_t xWakeTime )
+{
+    const DeferralStats_t xNow = xDeferralStats;
+
+    ( void ) xWakeTime;
+    if( xNow.ulRaised != xLast.ulRaised )
+    {
+        /* One line per period, easy to grep/parse from a benchmark run. */
+        printf( "deferral per %lums: raised=%lu dropped=%lu handled=%lu wakes=%lu\r\n",
+                ( unsigned long ) ulReportPeriodMs,
+                ( unsigned long ) ( xNow.ulRaised - xLast.ulRaised ),
+                ( unsigned long ) ( xNow.ulDropped - xLast.ulDropped ),
+                ( unsigned long ) ( xNow.ulHandled - xLast.ulHandled ),
+                ( unsigned long ) ( xNow.ulWakes - xLast.ulWakes ) );
+    }
+    xLast = xNow;
+}
+
+void vDeferralStatsStartReporter( TickType_t xPeriod )
+{
+    ulReportPeriodMs = ( uint32_t ) ( ( uint64_t ) xPeriod * 1000 / configTICK_RATE_HZ );
+    vReporterStart( "DeferralStats", xPeriod, prvReportStart, prvReport );
+
+    /* Only ever runs on the host build, where a timed injection run ends with exit(). */
+    atexit( prvPrintTotals );
+}
@@ -0,0 +1,67 @@
+#ifndef DEFERRAL_STATS_H
+#define DEFERRAL_STATS_H
+
+#include <FreeRTOS.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) Counters for the "ISR defers to a handler task" examples, used to find
+ * the event rate at which each deferral mechanism starts losing events:
+ *
+ * ulRaised  - events seen by the ISR.
+ * ulDropped - events the ISR could not hand over (semaphore already given or
+ *             at its max count, queue full, timer command queue full).
+ * ulHandled - events processed by the handler.
+ * ulWakes   - times the handler was woken. A notification value or counting
+ *             semaphore can carry several events into one wake, so
+ *             ulHandled - ulWakes is the number of events that coalesced.
+ *
+ * 2) Each counter has a single writer (either the ISR or the handler) so they
+ * are plain increments, with no critical section on the ISR path.
+ *******************************************************************************/
+
+typedef struct
+{
+    volatile uint32_t ulRaised;
+    volatile uint32_t ulDropped;
+    volatile uint32_t ulHandled;
+    volatile uint32_t ulWakes;
+} DeferralStats_t;
+
+extern DeferralStats_t xDeferralStats;
+
+/* Call from the ISR once per event. */
+static inline void vDeferralStatsRaisedFromISR( void )
+{
+    xDeferralStats.ulRaised++;
+}
+
+/* Call from the ISR with the result of the give/send/pend that defers the event. */
+static inline void vDeferralStatsDeferredFromISR( BaseType_t xResult )
+{
+    if( xResult != pdPASS )
+    {
+        xDeferralStats.ulDropped++;
+    }
+}
+
+/* Call from the handler each time it wakes, with the number of events it
+processes in that wake. */
+static inline void vDeferralStatsHandled( uint32_t ulEvents )
+{
+    xDeferralStats.ulHandled += ulEvents;
+    xDeferralStats.ulWakes++;
+}
+
+/* Creates a task that prints the counter rates every xPeriod while events are
+arriving, and registers an exit handler that prints the totals (host build). */
+void vDeferralStatsStartReporter( TickType_t xPeriod );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DEFERRAL_STATS_H */
@@ -0,0 +1,242 @@
+#include <stdio.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "pico/stdlib.h"
+#include "dlog.h"
+#include "static_alloc.h"
+
+#if ( dlogRING_LENGTH & ( dlogRING_LENGTH - 1 ) ) != 0
+#error dlogRING_LENGTH must be a power of two
+#endif
+
+/* Provided by the linker for the section DLOG() puts the format strings in.
+Weak, so an example that links dlog without logging anything still links. */
+extern const char __start_dlog_fmt[] __attribute__( ( weak ) );
+extern const char __stop_dlog_fmt[] __attribute__( ( weak ) );
+
+/* Longest conversion prvPrintRecord() passes to printf(), e.g. "%-08lx" */
+#define dlogMAX_SPEC_LENGTH     16
+
+typedef struct
+{
+    DlogRecord_t xRecords[ dlogRING_LENGTH ];
+    /* Free running. The head is only written on the owning core with its
+    interrupts masked, the tail only by the drain task. */
+    uint32_t ulHead;
+    uint32_t ulTail;
+    volatile uint32_t ulDropped;
+} DlogRing_t;
+
+static DlogRing_t xRings[ dlogNUM_CORES ];
+static DlogSink_t xSink = NULL;
+
+void vDlogWrite( const char *pcFormat, uint32_t ulArgCount,
+                 uintptr_t uxArg1, uintptr_t uxArg2, uintptr_t uxArg3, uintptr_t uxArg4 )
+{
+    UBaseType_t uxSavedInterruptStatus;
+    DlogRing_t *pxRing;
+    DlogRecord_t *pxRecord;
+    uint32_t ulCore;
+
+    /* Masking (not a critical section) is enough: it keeps every other writer
+    on this core out, and no other core writes to this ring. */
+    uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+    {
+#if FREE_RTOS_KERNEL_SMP
+        ulCore = portGET_CORE_ID();
+#else
+        ulCore = 0;
+#endif
+        pxRing = &xRings[ ulCore ];
+
+        if( pxRing->ulHead - __atomic_load_n( &pxRing->ulTail, __ATOMIC_ACQUIRE ) >= dlogRING_LENGTH )
+        {
+            pxRing->ulDropped++;
+        }
+        else
+        {
+            pxRecord = &pxRing->xRecords[ pxRing->ulHead & ( dlogRING_LENGTH - 1 ) ];
+            pxRecord->ulTimestampUs = time_us_32();
+            pxRecord->usFormatId = ( uint16_t ) ( pcFormat - __start_dlog_fmt );
+            pxRecord->ucArgCount = ( uint8_t ) ulArgCount;
+            pxRecord->ucCore = ( uint8_t ) ulCore;
+            pxRecord->uxArgs[ 0 ] = uxArg1;
+            pxRecord->uxArgs[ 1 ] = uxArg2;
+            pxRecord->uxArgs[ 2 ] = uxArg3;
+            pxRecord->uxArgs[ 3 ] = uxArg4;
+
+            __atomic_store_n( &pxRing->ulHead, pxRing->ulHead + 1, __ATOMIC_RELEASE );
+        }
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+}
+
+/* Prints one conversion, cSpec, with uxArg cast back to the type it takes.
+Passing the stored uintptr_t where printf() reads an int is undefined where
+they differ in size, as on the 64-bit host. */
+static void prvPrintArg( const char *cSpec, char cLength, char cConversion, uintptr_t uxArg )
+{
+    switch( cConversion )
+    {
+        case 'd':
+        case 'i':
+            switch( cLength )
+            {
+                case 'l': printf( cSpec, ( long ) uxArg ); break;
+                case 'L': printf( cSpec, ( long long ) uxArg ); break;
+                case 'z':
+                case 't': printf( cSpec, ( ptrdiff_t ) uxArg ); break;
+                default: printf( cSpec, ( int ) uxArg ); break;
+            }
+            break;
+
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            switch( cLength )
+            {
+                case 'l': printf( cSpec, ( unsigned long ) uxArg ); break;
+                case 'L': printf( cSpec, ( unsigned long long ) uxArg ); break;
+                case 'z':
+                case 't': printf( cSpec, ( size_t ) uxArg ); break;
+                default: printf( cSpec, ( unsigned int ) uxArg ); break;
+            }
+            break;
+
+        case 'c':
+            printf( cSpec, ( int ) uxArg );
+            break;
+
+        case 's':
+            printf( cSpec, ( const char * ) uxArg );
+            break;
+
+        case 'p':
+            printf( cSpec, ( void * ) uxArg );
+            break;
+
+        default:
+            /* Not an integer or pointer conversion, note 4 of dlog.h */
+            fputs( cSpec, stdout );
+            break;
+    }
+}
+
+/* Prints the record as printf() would have printed the DLOG(), a conversion
+at a time, see prvPrintArg() */
+static void prvPrintRecord( const DlogRecord_t *pxRecord )
+{
+    const char *pcFormat = &__start_dlog_fmt[ pxRecord->usFormatId ];
+    char cSpec[ dlogMAX_SPEC_LENGTH ];
+    char cLength;
+    size_t xLength;
+    uint32_t ulArg = 0;
+
+    while( *pcFormat != '\0' )
+    {
+        /* Text up to the next conversion */
+        xLength = strcspn( pcFormat, "%" );
+        fwrite( pcFormat, 1, xLength, stdout );
+        pcFormat += xLength;
+        if( *pcFormat == '\0' )
+        {
+            break;
+        }
+        if( pcFormat[ 1 ] == '%' )
+        {
+            putchar( '%' );
+            pcFormat += 2;
+            continue;
+        }
+
+        /* Flags, width and precision, then the length modifier ('L' for "ll") */
+        xLength = 1 + strspn( pcFormat + 1, "-+ #0123456789." );
+        cLength = '\0';
+        if( ( pcFormat[ xLength ] == 'l' ) && ( pcFormat[ xLength + 1 ] == 'l' ) )
+        {
+            cLength = 'L';
+            xLength += 2;
+        }
+        else if( ( pcFormat[ xLength ] != '\0' ) && ( strchr( "hlzt", pcFormat[ xLength ] ) != NULL ) )
+        {
+            cLength = pcFormat[ xLength ];
+            xLength++;
+            if( ( cLength == 'h' ) && ( pcFormat[ xLength ] == 'h' ) )
+            {
+                xLength++;
+            }
+        }
+        if( ( pcFormat[ xLength ] == '\0' ) || ( xLength + 1 >= sizeof( cSpec ) ) )
+        {
+            /* Unterminated or too long, print the rest as it is */
+            fputs( pcFormat, stdout );
+            break;
+        }
+        xLength++;
+
+        memcpy( cSpec, pcFormat, xLength );
+        cSpec[ xLength ] = '\0';
+        prvPrintArg( cSpec, cLength, pcFormat[ xLength - 1 ],
+                     ( ulArg < pxRecord->ucArgCount ) ? pxRecord->uxArgs[ ulArg ] : 0 );
+        ulArg++;
+        pcFormat += xLength;
+    }
+}
+
+static void prvDlogTask( void *pvParameters )
+{
+    uint32_t ulReportedDropped[ dlogNUM_CORES ] = { 0 };
+    DlogRecord_t xRecord;
+
+    if( xSink != NULL )
+    {
+        const DlogDumpHeader_t xHeader = { { 'D', 'L', 'G', '1' }, sizeof( uintptr_t ), dlogMAX_ARGS,
+                                           sizeof( DlogRecord_t ) };
+        xSink( &xHeader, sizeof( xHeader ) );
+    }
+
+    for( ;; )
+    {
+        vTaskDelay( pdMS_TO_TICKS( dlogDRAIN_PERIOD_MS ) );
+
+        for( uint32_t ulCore = 0; ulCore < dlogNUM_CORES; ulCore++ )
+        {
+            DlogRing_t *pxRing = &xRings[ ulCore ];
+
+            while( pxRing->ulTail != __atomic_load_n( &pxRing->ulHead, __ATOMIC_ACQUIRE ) )
+            {
+                /* Copy out and free the slot before the slow part. */
+                xRecord = pxRing->xRecords[ pxRing->ulTail & ( dlogRING_LENGTH - 1 ) ];
+                __atomic_store_n( &pxRing->ulTail, pxRing->ulTail + 1, __ATOMIC_RELEASE );
+
+                if( xSink != NULL )
+                {
+                    xSink( &xRecord, sizeof( xRecord ) );
+                }
+                else
+                {
+                    prvPrintRecord( &xRecord );
+                }
+            }
+
+            /* A binary dump has no record for what was dropped, so only text mode reports it. */
+            if( ( xSink == NULL ) && ( pxRing->ulDropped != ulReportedDropped[ ulCore ] ) )
+            {
+                printf( "[dlog] core %lu: %lu records dropped, ring full\r\n", ( unsigned long ) ulCore,
+                        ( unsigned long ) ( pxRing->ulDropped - ulReportedDropped[ ulCore ] ) );
+                ulReportedDropped[ ulCore ] = pxRing->ulDropped;
+            }
+        }
+    }
+}
+
+void vDlogStartTask( UBaseType_t uxPriority, DlogSink_t xBinarySink )
+{
+    /* usFormatId is 16 bits, note 2 of dlog.h */
+    configASSERT( ( size_t ) ( __stop_dlog_fmt - __start_dlog_fmt ) <= UINT16_MAX + 1u );
+
+    xSink = xBinarySink;
+    xExampleTaskCreate( prvDlogTask, "Dlog", configMINIMAL_STACK_SIZE, NULL, uxPriority, NULL );
+}
@@ -0,0 +1,103 @@
+#ifndef DLOG_H
+#define DLOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <FreeRTOS.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) printf() from a task costs a full vsnprintf() plus the stdio lock, and
+ * with USB CDC it can block the task until the host reads. DLOG() instead
+ * stores a fixed-size binary record - timestamp, format ID and up to four raw
+ * arguments - and returns. The formatting is done later, either by a low
+ * priority task (vDlogStartTask() with no sink) or on a PC, by
+ * tools/dlog_decode reading a binary dump (vDlogStartTask() with a sink).
+ *
+ * 2) The format ID is the offset of the format string in the "dlog_fmt"
+ * section, where DLOG() places every format string. It is fixed at link time,
+ * so the PC decoder only needs that section from the ELF:
+ *      objcopy -O binary --only-section=dlog_fmt <example>.elf fmt.bin
+ * The ID is 16 bits, so the section must stay within 64 KiB, which
+ * vDlogStartTask() asserts.
+ *
+ * 3) There is one ring per core. A record is written with interrupts masked
+ * on the writing core only (a handful of instructions), so DLOG() is safe from
+ * tasks and ISRs alike and never takes a lock shared with the other core.
+ * When the ring is full the record is dropped and counted, DLOG() never blocks.
+ *
+ * 4) Arguments are stored as uintptr_t: integers, chars and pointers only, no
+ * floating point, and no '*' width or precision. The drain task casts each
+ * one back to the type its conversion takes before printing it, so a 64 bit
+ * "%llu" argument is cut to 32 bits on the RP2040. A "%s" argument is stored
+ * as a pointer, so the string must still exist when the record is formatted
+ * (string literals, task names). The PC decoder cannot follow it and prints
+ * the address instead.
+ *******************************************************************************/
+
+#define dlogMAX_ARGS            4
+
+/* Records per core, must be a power of two */
+#define dlogRING_LENGTH         128
+
+#define dlogDRAIN_PERIOD_MS     10
+
+#if FREE_RTOS_KERNEL_SMP
+#define dlogNUM_CORES           configNUM_CORES
+#else
+#define dlogNUM_CORES           1
+#endif
+
+typedef struct
+{
+    uint32_t ulTimestampUs;
+    uint16_t usFormatId;
+    uint8_t ucArgCount;
+    uint8_t ucCore;
+    uintptr_t uxArgs[ dlogMAX_ARGS ];
+} DlogRecord_t;
+
+/* Written once at the start of a binary dump, followed by DlogRecord_t's. */
+typedef struct
+{
+    char cMagic[ 4 ];           /* "DLG1" */
+    uint8_t ucPointerSize;      /* sizeof( uintptr_t ) of the target */
+    uint8_t ucMaxArgs;
+    uint16_t usRecordSize;
+} DlogDumpHeader_t;
+
+/* Receives the binary dump, e.g. a function doing fwrite() to stdout or a file. */
+typedef void ( *DlogSink_t )( const void *pvData, size_t xLength );
+
+/* Creates the task that empties the rings every dlogDRAIN_PERIOD_MS. With
+xBinarySink NULL the records are formatted and printed, otherwise they are
+passed to xBinarySink as-is for tools/dlog_decode. */
+void vDlogStartTask( UBaseType_t uxPriority, DlogSink_t xBinarySink );
+
+void vDlogWrite( const char *pcFormat, uint32_t ulArgCount,
+                 uintptr_t uxArg1, uintptr_t uxArg2, uintptr_t uxArg3, uintptr_t uxArg4 );
+
+/* DLOG( "format", up to four integer/pointer arguments ) */
+#define DLOG( pcFormat, ... )                                                              \
+    do {                                                                                   \
+        static const char pcDlogFormat[] __attribute__( ( section( "dlog_fmt" ), used ) ) = pcFormat; \
+        prvDLOG_SELECT( __VA_ARGS__ )( pcDlogFormat, ##__VA_ARGS__ );                      \
+    } while( 0 )
+
+/* Argument counting, only for the DLOG() macro above */
+#define prvDLOG_SELECT( ... )   prvDLOG_NTH( _0, ##__VA_ARGS__, prvDLOG_4, prvDLOG_3, prvDLOG_2, prvDLOG_1, prvDLOG_0 )
+#define prvDLOG_NTH( _0, _1, _2, _3, _4, N, ... )   N
+#define prvDLOG_0( f )              vDlogWrite( f, 0, 0, 0, 0, 0 )
+#define prvDLOG_1( f, a )           vDlogWrite( f, 1, ( uintptr_t ) ( a ), 0, 0, 0 )
+#define prvDLOG_2( f, a, b )        vDlogWrite( f, 2, ( uintptr_t ) ( a ), ( uintptr_t ) ( b ), 0, 0 )
+#define prvDLOG_3( f, a, b, c )     vDlogWrite( f, 3, ( uintptr_t ) ( a ), ( uintptr_t ) ( b ), ( uintptr_t ) ( c ), 0 )
+#define prvDLOG_4( f, a, b, c, d )  vDlogWrite( f, 4, ( uintptr_t ) ( a ), ( uintptr_t ) ( b ), ( uintptr_t ) ( c ), ( uintptr_t ) ( d ) )
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DLOG_H */
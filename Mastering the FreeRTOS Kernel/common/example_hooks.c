@@ -0,0 +1,19 @@
+#include <FreeRTOS.h>
+#include <task.h>
+
+#if ( configUSE_DAEMON_TASK_STARTUP_HOOK == 1 )
+
+/* configUSE_DAEMON_TASK_STARTUP_HOOK is only set for the targets built with
+one of the options below, see FreeRTOSConfig.h. Their tasks are started here,
+so the examples don't need touching. */
+void vApplicationDaemonTaskStartupHook( void )
+{
+#if EXAMPLE_RUNTIME_STATS
+    vRuntimeStatsStartTask();
+#endif
+#if EXAMPLE_TICKLESS
+    vTicklessStartReportTask();
+#endif
+}
+
+#endif /* configUSE_DAEMON_TASK_STARTUP_HOOK */
@@ -0,0 +1,40 @@
+#include <stdint.h>
+#include <FreeRTOS.h>
+
+/***************************** Important Notes *********************************
+ * 1) heap_5 manages memory it is given with vPortDefineHeapRegions(), which
+ * must be called before anything is allocated. The examples create their
+ * tasks and queues at the top of main(), so it is called from a constructor
+ * instead, which runs before main() on the RP2040 and the host alike.
+ *
+ * 2) The point of heap_5 is memory the linker doesn't otherwise place, e.g.
+ * external RAM or a spare SRAM bank. Here the regions are two separate arrays
+ * that add up to configTOTAL_HEAP_SIZE, so the examples keep the same amount
+ * of heap and the block lists span more than one region.
+ *******************************************************************************/
+
+#define REGION_0_SIZE   ( ( configTOTAL_HEAP_SIZE * 3 ) / 4 )
+#define REGION_1_SIZE   ( configTOTAL_HEAP_SIZE - REGION_0_SIZE )
+
+static uint8_t ucRegion0[ REGION_0_SIZE ] __attribute__( ( aligned( portBYTE_ALIGNMENT ) ) );
+static uint8_t ucRegion1[ REGION_1_SIZE ] __attribute__( ( aligned( portBYTE_ALIGNMENT ) ) );
+
+__attribute__( ( constructor ) ) static void prvDefineHeapRegions( void )
+{
+    /* vPortDefineHeapRegions() wants them in address order, which is up to the
+    linker */
+    HeapRegion_t xRegions[ 3 ] =
+    {
+        { ucRegion0, sizeof( ucRegion0 ) },
+        { ucRegion1, sizeof( ucRegion1 ) },
+        { NULL, 0 }
+    };
+
+    if( ( uintptr_t ) ucRegion1 < ( uintptr_t ) ucRegion0 )
+    {
+        xRegions[ 0 ] = ( HeapRegion_t ) { ucRegion1, sizeof( ucRegion1 ) };
+        xRegions[ 1 ] = ( HeapRegion_t ) { ucRegion0, sizeof( ucRegion0 ) };
+    }
+
+    vPortDefineHeapRegions( xRegions );
+}
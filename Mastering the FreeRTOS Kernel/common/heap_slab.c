@@ -0,0 +1,182 @@
+#include <stdint.h>
+
+/* heap_4 itself, under other names: the arena and every request the classes
+don't serve come from it. Its xPortGetFreeHeapSize() and friends keep their
+names. */
+#define pvPortMalloc    pvSlabHeap4Malloc
+#define vPortFree       vSlabHeap4Free
+#include "heap_4.c"
+#undef pvPortMalloc
+#undef vPortFree
+
+#include "heap_slab.h"
+
+#if ( slabARENA_SIZE % slabPAGE_SIZE ) != 0 || ( slabPAGE_SIZE % slabLARGEST_CLASS ) != 0
+#error slabARENA_SIZE must be a multiple of slabPAGE_SIZE, and that of every class size
+#endif
+
+#define slabPAGE_COUNT          ( slabARENA_SIZE / slabPAGE_SIZE )
+
+typedef struct SlabFreeBlock
+{
+    struct SlabFreeBlock *pxNext;
+} SlabFreeBlock_t;
+
+typedef struct
+{
+    SlabFreeBlock_t *pxFreeList;
+    uint8_t *pucNext;               /* Never used part of the class's newest page */
+    uint8_t *pucPageEnd;
+    SlabClassStats_t xStats;
+} SlabClass_t;
+
+static SlabClass_t xClasses[ slabNUM_CLASSES ] =
+{
+    { .xStats = { .ulBlockSize = 16 } },
+    { .xStats = { .ulBlockSize = 32 } },
+    { .xStats = { .ulBlockSize = 64 } },
+    { .xStats = { .ulBlockSize = 128 } },
+    { .xStats = { .ulBlockSize = 256 } },
+};
+
+static uint8_t *pucArena;
+static BaseType_t xArenaTaken = pdFALSE;
+static uint32_t ulPagesUsed;
+static uint8_t ucPageClass[ slabPAGE_COUNT ];
+
+/* NULL for requests no class serves */
+static SlabClass_t *prvClassFor( size_t xWantedSize )
+{
+    if( xWantedSize == 0 )
+    {
+        return NULL;
+    }
+    for( int i = 0; i < slabNUM_CLASSES; i++ )
+    {
+        if( xWantedSize <= xClasses[ i ].xStats.ulBlockSize )
+        {
+            return &xClasses[ i ];
+        }
+    }
+    return NULL;
+}
+
+/* Takes the arena from heap_4 on the first call. If heap_4 can't spare it,
+everything is left to heap_4. */
+static BaseType_t prvArenaReady( void )
+{
+    if( xArenaTaken == pdFALSE )
+    {
+        vTaskSuspendAll();
+        {
+            if( xArenaTaken == pdFALSE )
+            {
+                pucArena = ( uint8_t * ) pvSlabHeap4Malloc( slabARENA_SIZE );
+                xArenaTaken = pdTRUE;
+            }
+        }
+        ( void ) xTaskResumeAll();
+    }
+    return ( pucArena != NULL ) ? pdTRUE : pdFALSE;
+}
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+    SlabClass_t *pxClass = prvClassFor( xWantedSize );
+    SlabFreeBlock_t *pxBlock = NULL;
+
+    if( ( pxClass != NULL ) && ( prvArenaReady() != pdFALSE ) )
+    {
+        taskENTER_CRITICAL();
+        {
+            if( pxClass->pxFreeList != NULL )
+            {
+                pxBlock = pxClass->pxFreeList;
+                pxClass->pxFreeList = pxBlock->pxNext;
+            }
+            else
+            {
+                if( ( pxClass->pucNext == pxClass->pucPageEnd ) && ( ulPagesUsed < slabPAGE_COUNT ) )
+                {
+                    ucPageClass[ ulPagesUsed ] = ( uint8_t ) ( pxClass - xClasses );
+                    pxClass->pucNext = &pucArena[ ulPagesUsed * slabPAGE_SIZE ];
+                    pxClass->pucPageEnd = pxClass->pucNext + slabPAGE_SIZE;
+                    pxClass->xStats.ulPages++;
+                    ulPagesUsed++;
+                }
+                if( pxClass->pucNext != pxClass->pucPageEnd )
+                {
+                    pxBlock = ( SlabFreeBlock_t * ) pxClass->pucNext;
+                    pxClass->pucNext += pxClass->xStats.ulBlockSize;
+                }
+            }
+
+            if( pxBlock != NULL )
+            {
+                pxClass->xStats.ulAllocations++;
+                if( ++pxClass->xStats.ulInUse > pxClass->xStats.ulHighWaterMark )
+                {
+                    pxClass->xStats.ulHighWaterMark = pxClass->xStats.ulInUse;
+                }
+            }
+            else
+            {
+                pxClass->xStats.ulOverflows++;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( pxBlock != NULL )
+        {
+            traceMALLOC( pxBlock, pxClass->xStats.ulBlockSize );
+            return pxBlock;
+        }
+    }
+
+    /* Too big for a class, or the arena is full */
+    return pvSlabHeap4Malloc( xWantedSize );
+}
+
+void vPortFree( void *pv )
+{
+    const uintptr_t uxOffset = ( uintptr_t ) pv - ( uintptr_t ) pucArena;
+    SlabClass_t *pxClass;
+
+    if( ( pucArena == NULL ) || ( ( uintptr_t ) pv < ( uintptr_t ) pucArena ) || ( uxOffset >= slabARENA_SIZE ) )
+    {
+        vSlabHeap4Free( pv );
+        return;
+    }
+
+    /* Only pages already given to a class have a valid ucPageClass[] entry */
+    configASSERT( ( uxOffset / slabPAGE_SIZE ) < ulPagesUsed );
+    pxClass = &xClasses[ ucPageClass[ uxOffset / slabPAGE_SIZE ] ];
+    configASSERT( ( uxOffset % pxClass->xStats.ulBlockSize ) == 0 );
+    traceFREE( pv, pxClass->xStats.ulBlockSize );
+
+    taskENTER_CRITICAL();
+    {
+        configASSERT( pxClass->xStats.ulInUse > 0 );
+        ( ( SlabFreeBlock_t * ) pv )->pxNext = pxClass->pxFreeList;
+        pxClass->pxFreeList = ( SlabFreeBlock_t * ) pv;
+        pxClass->xStats.ulInUse--;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void vSlabGetStats( SlabClassStats_t pxStats[ slabNUM_CLASSES ] )
+{
+    taskENTER_CRITICAL();
+    {
+        for( int i = 0; i < slabNUM_CLASSES; i++ )
+        {
+            pxStats[ i ] = xClasses[ i ].xStats;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+uint32_t ulSlabGetFreePages( void )
+{
+    return ( pucArena != NULL ) ? slabPAGE_COUNT - ulPagesUsed : 0;
+}
@@ -0,0 +1,69 @@
+#ifndef HEAP_SLAB_H
+#define HEAP_SLAB_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <FreeRTOS.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) heap_slab.c is a pvPortMalloc()/vPortFree() for EXAMPLE_HEAP=slab. Every
+ * request of up to 256 bytes is rounded up to a size class, 16, 32, 64, 128
+ * or 256 bytes, and taken from that class's free list: one pop to allocate,
+ * one push to free, whatever state the heap is in. heap_4 walks its free list
+ * (first fit) and coalesces on every call instead, so its time depends on
+ * how fragmented the heap has become.
+ *
+ * 2) The classes share an arena of slabARENA_SIZE bytes, taken from heap_4 on
+ * the first allocation and cut into slabPAGE_SIZE pages. A class gets a
+ * fresh page when its free list is empty and carves blocks off it one at a
+ * time. Pages are never handed back, so the arena holds at most what the
+ * examples once needed of each class, and blocks of one class never break up
+ * space another class could have used.
+ *
+ * 3) Larger requests, and small ones once the arena has no free page left,
+ * go to heap_4 (renamed inside heap_slab.c), as do their frees. So
+ * xPortGetFreeHeapSize() and vPortGetHeapStats() are heap_4's, with the
+ * whole arena counted as allocated; vSlabGetStats() shows how it is used.
+ *
+ * 4) The free lists are threaded through the free blocks themselves, so a
+ * block has no header, and vPortFree() finds the class of a block from the
+ * page it is in. Both only touch the lists inside a critical section a few
+ * instructions long, not with the scheduler suspended like heap_4.
+ *******************************************************************************/
+
+#define slabNUM_CLASSES         5
+#define slabLARGEST_CLASS       256
+
+#ifndef slabPAGE_SIZE
+#define slabPAGE_SIZE           1024    /* A multiple of every class size */
+#endif
+
+#ifndef slabARENA_SIZE
+#define slabARENA_SIZE          ( ( configTOTAL_HEAP_SIZE / 4 ) / slabPAGE_SIZE * slabPAGE_SIZE )
+#endif
+
+typedef struct
+{
+    uint32_t ulBlockSize;
+    uint32_t ulPages;               /* Arena pages given to the class */
+    uint32_t ulInUse;
+    uint32_t ulHighWaterMark;       /* Most blocks ever in use at once */
+    uint32_t ulAllocations;         /* Served from the class */
+    uint32_t ulOverflows;           /* Sent to heap_4 as the arena was full */
+} SlabClassStats_t;
+
+/* Copies the statistics of every class, smallest first. */
+void vSlabGetStats( SlabClassStats_t pxStats[ slabNUM_CLASSES ] );
+
+/* Arena pages not yet given to a class. */
+uint32_t ulSlabGetFreePages( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HEAP_SLAB_H */
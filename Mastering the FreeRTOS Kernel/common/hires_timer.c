@@ -0,0 +1,305 @@
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include "hires_timer.h"
+#include "static_alloc.h"
+
+#if configTASK_NOTIFICATION_ARRAY_ENTRIES <= hiresNOTIFY_INDEX
+#error vHiresDelayUntil() needs configTASK_NOTIFICATION_ARRAY_ENTRIES above hiresNOTIFY_INDEX
+#endif
+
+#define SERVICE_TASK_STACK_SIZE configTIMER_TASK_STACK_DEPTH
+
+#if HOST_POSIX_BUILD
+
+/* Rounded up, and at least one, so the wake is never early */
+static TickType_t prvTicksUntil( uint64_t ullUs )
+{
+    const uint64_t ullNowUs = time_us_64();
+    uint64_t ullTicks;
+
+    if( ullUs <= ullNowUs )
+    {
+        return 1;
+    }
+    ullTicks = ( ( ullUs - ullNowUs ) * configTICK_RATE_HZ + 999999u ) / 1000000u;
+    return ( ullTicks > 0 ) ? ( TickType_t ) ullTicks : 1;
+}
+
+void vHiresDelayUntil( uint64_t *pullPreviousWakeUs, uint32_t ulPeriodUs )
+{
+    const uint64_t ullWakeUs = *pullPreviousWakeUs + ulPeriodUs;
+
+    *pullPreviousWakeUs = ullWakeUs;
+    if( ullWakeUs > time_us_64() )
+    {
+        vTaskDelay( prvTicksUntil( ullWakeUs ) );
+    }
+}
+
+/* Called from a callback, the daemon task can't wait on its own queue */
+static TickType_t prvCommandBlockTime( void )
+{
+    return ( xTaskGetCurrentTaskHandle() == xTimerGetTimerDaemonTaskHandle() ) ? 0 : portMAX_DELAY;
+}
+
+/* In the daemon task. A periodic timer is a chain of one-shots, each aimed
+at the next due time so the rounding doesn't add up. */
+static void prvTimerCallback( TimerHandle_t xTimer )
+{
+    HiresTimer_t *pxTimer = ( HiresTimer_t * ) pvTimerGetTimerID( xTimer );
+    const uint64_t ullDueUs = pxTimer->ullDueUs;
+
+    if( pxTimer->ulPeriodUs == 0 )
+    {
+        pxTimer->xRunning = pdFALSE;
+    }
+    else
+    {
+        pxTimer->ullDueUs += pxTimer->ulPeriodUs;
+
+        /* The daemon task can't wait for room on its own queue. If the timer
+        queue is full the chain ends here, counted as an overrun. */
+        if( xTimerChangePeriod( xTimer, prvTicksUntil( pxTimer->ullDueUs ), 0 ) != pdPASS )
+        {
+            pxTimer->ulOverruns++;
+            pxTimer->xRunning = pdFALSE;
+        }
+    }
+    pxTimer->pxCallback( pxTimer, ullDueUs );
+}
+
+void vHiresTimerServiceStart( UBaseType_t uxPriority )
+{
+    /* The daemon task calls the callbacks */
+    ( void ) uxPriority;
+}
+
+void vHiresTimerInit( HiresTimer_t *pxTimer, HiresTimerCallback_t pxCallback, void *pvContext )
+{
+    pxTimer->pxCallback = pxCallback;
+    pxTimer->pvContext = pvContext;
+    pxTimer->ulGeneration = 0;
+    pxTimer->ulOverruns = 0;
+    pxTimer->xRunning = pdFALSE;
+
+    /* Not xExampleTimerCreate(), which has one timer per call site */
+    pxTimer->xTimer = xTimerCreate( "Hires", 1, pdFALSE, pxTimer, prvTimerCallback );
+    configASSERT( pxTimer->xTimer != NULL );
+}
+
+BaseType_t xHiresTimerStart( HiresTimer_t *pxTimer, uint32_t ulDelayUs, uint32_t ulPeriodUs )
+{
+    vHiresTimerStop( pxTimer );
+
+    pxTimer->ulPeriodUs = ulPeriodUs;
+    pxTimer->ullDueUs = time_us_64() + ulDelayUs;
+    pxTimer->xRunning = pdTRUE;
+    return xTimerChangePeriod( pxTimer->xTimer, prvTicksUntil( pxTimer->ullDueUs ), prvCommandBlockTime() );
+}
+
+void vHiresTimerStop( HiresTimer_t *pxTimer )
+{
+    if( pxTimer->xRunning != pdFALSE )
+    {
+        pxTimer->xRunning = pdFALSE;
+        pxTimer->ulGeneration++;
+        xTimerStop( pxTimer->xTimer, prvCommandBlockTime() );
+    }
+}
+
+#else /* HOST_POSIX_BUILD */
+
+/* An expiry, from the alarm interrupt to the service task */
+typedef struct
+{
+    HiresTimer_t *pxTimer;
+    uint64_t ullDueUs;
+    uint32_t ulGeneration;          /* The timer's when it expired, see vHiresTimerStop() */
+} HiresExpiry_t;
+
+static QueueHandle_t xServiceQueue;
+
+static int64_t prvWakeTask( alarm_id_t xAlarm, void *pvTask )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    vTaskNotifyGiveIndexedFromISR( ( TaskHandle_t ) pvTask, hiresNOTIFY_INDEX, &xHigherPriorityTaskWoken );
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+    return 0;
+}
+
+void vHiresDelayUntil( uint64_t *pullPreviousWakeUs, uint32_t ulPeriodUs )
+{
+    const uint64_t ullWakeUs = *pullPreviousWakeUs + ulPeriodUs;
+    alarm_id_t xAlarm;
+
+    *pullPreviousWakeUs = ullWakeUs;
+    if( ullWakeUs <= time_us_64() )
+    {
+        return;
+    }
+
+    /* If the time has passed by now, add_alarm_at() calls prvWakeTask() itself
+    and the notification is already there */
+    xAlarm = add_alarm_at( from_us_since_boot( ullWakeUs ), prvWakeTask, xTaskGetCurrentTaskHandle(), true );
+    configASSERT( xAlarm >= 0 );
+    ( void ) xAlarm;
+
+    ulTaskNotifyTakeIndexed( hiresNOTIFY_INDEX, pdTRUE, portMAX_DELAY );
+}
+
+static int64_t prvTimerAlarm( alarm_id_t xAlarm, void *pvTimer )
+{
+    HiresTimer_t *pxTimer = ( HiresTimer_t * ) pvTimer;
+    HiresExpiry_t xExpiry = { pxTimer, pxTimer->ullDueUs, pxTimer->ulGeneration };
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    if( xQueueSendToBackFromISR( xServiceQueue, &xExpiry, &xHigherPriorityTaskWoken ) != pdPASS )
+    {
+        pxTimer->ulOverruns++;
+    }
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+
+    if( pxTimer->ulPeriodUs == 0 )
+    {
+        /* The alarm ID is freed once this returns and may be given to another
+        alarm, which a later vHiresTimerStop() must not cancel. Unless the timer
+        was stopped or restarted since, the ID is still this alarm's. */
+        const UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+        {
+            if( pxTimer->ulGeneration == xExpiry.ulGeneration )
+            {
+                pxTimer->xAlarm = 0;
+                pxTimer->xAlarmFired = pdTRUE;
+            }
+        }
+        taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+        return 0;
+    }
+
+    /* A negative value re-arms the alarm relative to the time it was due */
+    pxTimer->ullDueUs += pxTimer->ulPeriodUs;
+    return -( int64_t ) pxTimer->ulPeriodUs;
+}
+
+static void prvServiceTask( void *pvParameters )
+{
+    HiresExpiry_t xExpiry;
+
+    for( ;; )
+    {
+        xQueueReceive( xServiceQueue, &xExpiry, portMAX_DELAY );
+
+        /* Stopped or restarted since it expired */
+        if( xExpiry.ulGeneration != xExpiry.pxTimer->ulGeneration )
+        {
+            continue;
+        }
+        if( xExpiry.pxTimer->ulPeriodUs == 0 )
+        {
+            xExpiry.pxTimer->xRunning = pdFALSE;
+        }
+        xExpiry.pxTimer->pxCallback( xExpiry.pxTimer, xExpiry.ullDueUs );
+    }
+}
+
+void vHiresTimerServiceStart( UBaseType_t uxPriority )
+{
+    xServiceQueue = xExampleQueueCreate( hiresQUEUE_LENGTH, sizeof( HiresExpiry_t ) );
+    configASSERT( xServiceQueue != NULL );
+
+    xExampleTaskCreate( prvServiceTask, "Hires", SERVICE_TASK_STACK_SIZE, NULL, uxPriority, NULL );
+}
+
+void vHiresTimerInit( HiresTimer_t *pxTimer, HiresTimerCallback_t pxCallback, void *pvContext )
+{
+    pxTimer->pxCallback = pxCallback;
+    pxTimer->pvContext = pvContext;
+    pxTimer->ulGeneration = 0;
+    pxTimer->ulOverruns = 0;
+    pxTimer->xRunning = pdFALSE;
+    pxTimer->xAlarm = 0;
+    pxTimer->xAlarmFired = pdFALSE;
+}
+
+BaseType_t xHiresTimerStart( HiresTimer_t *pxTimer, uint32_t ulDelayUs, uint32_t ulPeriodUs )
+{
+    alarm_id_t xAlarm;
+    uint32_t ulGeneration;
+    BaseType_t xStale;
+
+    configASSERT( xServiceQueue != NULL );
+    vHiresTimerStop( pxTimer );
+
+    taskENTER_CRITICAL();
+    {
+        pxTimer->ulPeriodUs = ulPeriodUs;
+        pxTimer->ullDueUs = time_us_64() + ulDelayUs;
+        pxTimer->xRunning = pdTRUE;
+        pxTimer->xAlarmFired = pdFALSE;
+        ulGeneration = pxTimer->ulGeneration;
+    }
+    taskEXIT_CRITICAL();
+
+    xAlarm = add_alarm_at( from_us_since_boot( pxTimer->ullDueUs ), prvTimerAlarm, pxTimer, true );
+    if( xAlarm < 0 )
+    {
+        pxTimer->xRunning = pdFALSE;
+        return pdFAIL;
+    }
+
+    /* The alarm may have fired already, a one-shot's ID then being free again,
+    or the callback may have stopped or restarted the timer. The ID is only
+    kept while this start's alarm is still pending. */
+    taskENTER_CRITICAL();
+    {
+        xStale = ( pxTimer->ulGeneration != ulGeneration );
+        if( ( xStale == pdFALSE ) && ( pxTimer->xAlarmFired == pdFALSE ) )
+        {
+            pxTimer->xAlarm = xAlarm;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    /* A periodic alarm's ID stays its own until cancelled, and the stop that
+    replaced it couldn't see it yet */
+    if( ( xStale != pdFALSE ) && ( ulPeriodUs != 0 ) )
+    {
+        cancel_alarm( xAlarm );
+    }
+    return pdPASS;
+}
+
+void vHiresTimerStop( HiresTimer_t *pxTimer )
+{
+    alarm_id_t xAlarm;
+
+    /* A new generation first, so an expiry the alarm posts before it is
+    cancelled is dropped by the service task */
+    taskENTER_CRITICAL();
+    {
+        xAlarm = pxTimer->xAlarm;
+        pxTimer->xAlarm = 0;
+        pxTimer->xRunning = pdFALSE;
+        pxTimer->ulGeneration++;
+    }
+    taskEXIT_CRITICAL();
+
+    if( xAlarm > 0 )
+    {
+        cancel_alarm( xAlarm );
+    }
+}
+
+#endif /* HOST_POSIX_BUILD */
+
+void *pvHiresTimerGetContext( HiresTimer_t *pxTimer )
+{
+    return pxTimer->pvContext;
+}
+
+uint32_t ulHiresTimerGetOverruns( HiresTimer_t *pxTimer )
+{
+    return pxTimer->ulOverruns;
+}
@@ -0,0 +1,99 @@
+#ifndef HIRES_TIMER_H
+#define HIRES_TIMER_H
+
+#include <stdint.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "pico/time.h"
+#if HOST_POSIX_BUILD
+#include <timers.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) vTaskDelayUntil() and software timers count in ticks, 1 ms here, so a
+ * task can't run every 500 us and a 5 ms period wakes on the tick interrupt,
+ * with its jitter. These use the RP2040's 64-bit microsecond timer instead,
+ * through pico-sdk alarms (the default alarm pool, on the timer interrupt),
+ * which configSUPPORT_PICO_TIME_INTEROP already makes safe to mix with the
+ * kernel.
+ *
+ * 2) vHiresDelayUntil() is vTaskDelayUntil() in microseconds: it arms an alarm
+ * for the wake time and blocks on task notification index
+ * hiresNOTIFY_INDEX, which the alarm gives. The task still only runs when
+ * the scheduler picks it, so the wake is exact to the microsecond plus the
+ * interrupt and the context switch.
+ *
+ * 3) An HiresTimer_t calls its callback once or periodically. The alarm
+ * interrupt only posts the expiry to a service task at the priority given to
+ * vHiresTimerServiceStart(), which calls the callback in task context: like a
+ * software timer callback it must not block. A periodic timer is re-armed
+ * from its previous due time, so it does not drift; expiries that find the
+ * service task's queue full are counted as overruns and dropped.
+ *
+ * 4) The callback gets the time the timer was due, so it can tell how late
+ * it runs. benchmarks/hires_jitter.cpp compares the period jitter of
+ * vTaskDelayUntil(), vHiresDelayUntil() and a HiresTimer_t.
+ *
+ * 5) The host build has no alarm interrupt, and sleeps there are signals of
+ * the POSIX port's tick: vHiresDelayUntil() rounds up to whole ticks and the
+ * timers run on software timers in the daemon task, still without drift. A
+ * periodic timer whose next expiry doesn't fit on the timer queue stops and
+ * counts an overrun.
+ *******************************************************************************/
+
+#define hiresNOTIFY_INDEX       1
+#define hiresQUEUE_LENGTH       16
+
+typedef struct HiresTimer HiresTimer_t;
+typedef void ( *HiresTimerCallback_t )( HiresTimer_t *pxTimer, uint64_t ullDueUs );
+
+/* Only for its size, the fields are private to hires_timer.c */
+struct HiresTimer
+{
+    uint64_t ullDueUs;                  /* Next expiry, us since boot */
+    uint32_t ulPeriodUs;                /* 0 for a one-shot */
+    HiresTimerCallback_t pxCallback;
+    void *pvContext;
+    volatile uint32_t ulGeneration;     /* Changed by every start and stop */
+    volatile uint32_t ulOverruns;
+    volatile BaseType_t xRunning;
+#if HOST_POSIX_BUILD
+    TimerHandle_t xTimer;
+#else
+    alarm_id_t xAlarm;
+    volatile BaseType_t xAlarmFired;    /* A one-shot's alarm has fired, its ID is free */
+#endif
+};
+
+/* Blocks the calling task until *pullPreviousWakeUs + ulPeriodUs and sets
+*pullPreviousWakeUs to that time. Returns at once, like vTaskDelayUntil(), if
+that time has already passed. Start with *pullPreviousWakeUs = time_us_64(). */
+void vHiresDelayUntil( uint64_t *pullPreviousWakeUs, uint32_t ulPeriodUs );
+
+/* Creates the task that calls the timer callbacks. Call before starting a timer. */
+void vHiresTimerServiceStart( UBaseType_t uxPriority );
+
+void vHiresTimerInit( HiresTimer_t *pxTimer, HiresTimerCallback_t pxCallback, void *pvContext );
+
+/* (Re)starts the timer to expire ulDelayUs from now, and then every
+ulPeriodUs, or only once if ulPeriodUs is 0. pdFAIL if the alarm pool is full. */
+BaseType_t xHiresTimerStart( HiresTimer_t *pxTimer, uint32_t ulDelayUs, uint32_t ulPeriodUs );
+
+/* Once this returns no further callback starts for the timer, not even for
+an expiry already posted to the service task. */
+void vHiresTimerStop( HiresTimer_t *pxTimer );
+
+void *pvHiresTimerGetContext( HiresTimer_t *pxTimer );
+
+/* Expiries dropped because the service task fell behind */
+uint32_t ulHiresTimerGetOverruns( HiresTimer_t *pxTimer );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HIRES_TIMER_H */
@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "pico/stdlib.h"
+#include "isr_log.h"
+#include "static_alloc.h"
+
+#if ( isrLOG_RING_LENGTH & ( isrLOG_RING_LENGTH - 1 ) ) != 0
+#error isrLOG_RING_LENGTH must be a power of two
+#endif
+
+static IsrLogRecord_t xRing[ isrLOG_RING_LENGTH ];
+
+/* Free running indexes, wrapped with a mask on access. The head is only
+written by the ISR and the tail only by the log task. */
+static uint32_t ulHead = 0;
+static uint32_t ulTail = 0;
+static volatile uint32_t ulDropped = 0;
+
+void vIsrLogFromISR( const char *pcFormat, uint32_t ulArg1, uint32_t ulArg2 )
+{
+    const uint32_t ulNextHead = ulHead + 1;
+    IsrLogRecord_t *pxRecord;
+
+    /* The acquire pairs with the release in prvIsrLogTask(), the slot the
+    task has just finished reading is not overwritten. */
+    if( ulNextHead - __atomic_load_n( &ulTail, __ATOMIC_ACQUIRE ) > isrLOG_RING_LENGTH )
+    {
+        ulDropped++;
+        return;
+    }
+
+    pxRecord = &xRing[ ulHead & ( isrLOG_RING_LENGTH - 1 ) ];
+    pxRecord->ulTimestampUs = time_us_32();
+    pxRecord->pcFormat = pcFormat;
+    pxRecord->ulArg1 = ulArg1;
+    pxRecord->ulArg2 = ulArg2;
+
+    /* Publish the record only once it is complete. */
+    __atomic_store_n( &ulHead, ulNextHead, __ATOMIC_RELEASE );
+}
+
+static void prvIsrLogTask( void *pvParameters )
+{
+    uint32_t ulReportedDropped = 0;
+    IsrLogRecord_t xRecord;
+
+    for( ;; )
+    {
+        vTaskDelay( pdMS_TO_TICKS( isrLOG_DRAIN_PERIOD_MS ) );
+
+        while( ulTail != __atomic_load_n( &ulHead, __ATOMIC_ACQUIRE ) )
+        {
+            /* Copy out, then hand the slot back before the slow printf(). */
+            xRecord = xRing[ ulTail & ( isrLOG_RING_LENGTH - 1 ) ];
+            __atomic_store_n( &ulTail, ulTail + 1, __ATOMIC_RELEASE );
+
+            printf( "[isr %lu us] ", ( unsigned long ) xRecord.ulTimestampUs );
+            printf( xRecord.pcFormat, xRecord.ulArg1, xRecord.ulArg2 );
+        }
+
+        if( ulDropped != ulReportedDropped )
+        {
+            printf( "[isr] %lu records dropped, ring full\r\n", ( unsigned long ) ( ulDropped - ulReportedDropped ) );
+            ulReportedDropped = ulDropped;
+        }
+    }
+}
+
+void vIsrLogStartTask( UBaseType_t uxPriority )
+{
+    xExampleTaskCreate( prvIsrLogTask, "IsrLog", configMINIMAL_STACK_SIZE, NULL, uxPriority, NULL );
+}
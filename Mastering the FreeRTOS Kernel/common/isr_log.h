@@ -0,0 +1,57 @@
+#ifndef ISR_LOG_H
+#define ISR_LOG_H
+
+#include <FreeRTOS.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) printf() must not be used inside an ISR. Over USB CDC it can block until
+ * the host reads, which adds milliseconds to the interrupt latency of the whole
+ * system (and with stdio mutexes it is not even safe). vIsrLogFromISR() only
+ * copies a fixed-size record into a ring buffer; a low priority task formats
+ * and prints the records later.
+ *
+ * 2) The ring is single producer, single consumer, and lock-free: the ISR only
+ * ever writes the head index, the log task only ever writes the tail index.
+ * Only one ISR may log, or several ISRs that cannot preempt each other (e.g.
+ * all GPIO interrupts, which share a single IRQ on the RP2040).
+ *
+ * 3) The format string is stored as a pointer and is used after the ISR has
+ * returned, so it must be a string literal (or otherwise static). At most two
+ * arguments are stored, as uint32_t, and printf() reads them back as such:
+ * only 32-bit integer conversions (%d, %u, %x, %c) may be used, not %s, %p
+ * or %l, whose arguments are 64 bits wide on the host build.
+ *
+ * 4) When the ring is full the record is dropped and counted, the ISR never
+ * waits for the log task. The log task prints how many were dropped.
+ *******************************************************************************/
+
+/* Must be a power of two */
+#define isrLOG_RING_LENGTH      64
+
+/* How often the log task checks the ring. The ISR does not wake it, so that
+logging costs the ISR nothing more than the copy. */
+#define isrLOG_DRAIN_PERIOD_MS  10
+
+typedef struct
+{
+    uint32_t ulTimestampUs;
+    const char *pcFormat;
+    uint32_t ulArg1;
+    uint32_t ulArg2;
+} IsrLogRecord_t;
+
+/* Creates the task that prints the records. */
+void vIsrLogStartTask( UBaseType_t uxPriority );
+
+/* Queues a record for printing, may only be called from the (one) ISR. */
+void vIsrLogFromISR( const char *pcFormat, uint32_t ulArg1, uint32_t ulArg2 );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ISR_LOG_H */
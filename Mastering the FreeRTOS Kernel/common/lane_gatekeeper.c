@@ -0,0 +1,286 @@
+#include <stdio.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include "pico/time.h"
+#include "lane_gatekeeper.h"
+#include "batch_writer.h"
+#include "static_alloc.h"
+
+#define GATEKEEPER_STACK_SIZE   configMINIMAL_STACK_SIZE
+#define REPORT_LINE_LENGTH      160
+
+typedef struct
+{
+    const char *pcString;
+    uint32_t ulSentUs;
+} LaneItem_t;
+
+typedef struct
+{
+    QueueHandle_t xQueue;
+    LaneConfig_t xConfig;
+    LaneStats_t xStats;
+} LaneState_t;
+
+static const char *pcLaneNames[ laneCOUNT ] = { "urgent", "normal", "bulk" };
+
+static LaneState_t xLanes[ laneCOUNT ];
+static TaskHandle_t xGatekeeperTask;
+
+static TickType_t xReportPeriod;
+static TickType_t xLastReport;
+
+/* Counts a send that was accepted, dropped or found the lane full. Called
+inside the caller's critical section. */
+static void prvCount( LaneStats_t *pxStats, BaseType_t xSent, BaseType_t xFull, uint32_t ulDroppedOld )
+{
+    pxStats->ulSent += ( xSent != pdFALSE );
+    pxStats->ulDropped += ( xSent == pdFALSE ) + ulDroppedOld;
+    pxStats->ulFull += ( xFull != pdFALSE );
+}
+
+BaseType_t xLanePrint( Lane_t eLane, const char *pcString )
+{
+    LaneState_t *pxLane = &xLanes[ eLane ];
+    LaneItem_t xItem = { pcString, time_us_32() };
+    LaneItem_t xOldest;
+    BaseType_t xSent, xFull = pdFALSE;
+    uint32_t ulDroppedOld = 0;
+
+    configASSERT( eLane < laneCOUNT );
+
+    xSent = xQueueSendToBack( pxLane->xQueue, &xItem, 0 );
+    if( xSent == pdFAIL )
+    {
+        xFull = pdTRUE;
+
+        switch( pxLane->xConfig.eOverflow )
+        {
+            case eLaneDropOldest:
+                /* The gatekeeper may take the oldest first, then the send
+                just succeeds on the next pass */
+                while( xSent == pdFAIL )
+                {
+                    if( xQueueReceive( pxLane->xQueue, &xOldest, 0 ) == pdPASS )
+                    {
+                        ulDroppedOld++;
+                    }
+                    xSent = xQueueSendToBack( pxLane->xQueue, &xItem, 0 );
+                }
+                break;
+
+            case eLaneBlock:
+                xSent = xQueueSendToBack( pxLane->xQueue, &xItem, pxLane->xConfig.xBlockTime );
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    taskENTER_CRITICAL();
+    {
+        prvCount( &pxLane->xStats, xSent, xFull, ulDroppedOld );
+    }
+    taskEXIT_CRITICAL();
+
+    if( xSent == pdPASS )
+    {
+        xTaskNotifyGive( xGatekeeperTask );
+    }
+    return xSent;
+}
+
+BaseType_t xLanePrintFromISR( Lane_t eLane, const char *pcString, BaseType_t *pxHigherPriorityTaskWoken )
+{
+    LaneState_t *pxLane = &xLanes[ eLane ];
+    LaneItem_t xItem = { pcString, time_us_32() };
+    LaneItem_t xOldest;
+    BaseType_t xSent, xFull = pdFALSE;
+    uint32_t ulDroppedOld = 0;
+    UBaseType_t uxSavedInterruptStatus;
+
+    configASSERT( eLane < laneCOUNT );
+
+    xSent = xQueueSendToBackFromISR( pxLane->xQueue, &xItem, pxHigherPriorityTaskWoken );
+    if( xSent == pdFAIL )
+    {
+        xFull = pdTRUE;
+
+        /* No waiting here, eLaneBlock drops the new message, note 2 */
+        if( pxLane->xConfig.eOverflow == eLaneDropOldest )
+        {
+            if( xQueueReceiveFromISR( pxLane->xQueue, &xOldest, pxHigherPriorityTaskWoken ) == pdPASS )
+            {
+                ulDroppedOld++;
+            }
+            xSent = xQueueSendToBackFromISR( pxLane->xQueue, &xItem, pxHigherPriorityTaskWoken );
+        }
+    }
+
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    {
+        prvCount( &pxLane->xStats, xSent, xFull, ulDroppedOld );
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    if( xSent == pdPASS )
+    {
+        vTaskNotifyGiveFromISR( xGatekeeperTask, pxHigherPriorityTaskWoken );
+    }
+    return xSent;
+}
+
+void vLaneGetStats( Lane_t eLane, LaneStats_t *pxStats )
+{
+    BatchWriterLatency_t xLatency;
+
+    configASSERT( eLane < laneCOUNT );
+
+    taskENTER_CRITICAL();
+    {
+        *pxStats = xLanes[ eLane ].xStats;
+    }
+    taskEXIT_CRITICAL();
+
+    /* The lane is the message's batch writer source, note 3 */
+    vBatchWriterGetLatency( ( UBaseType_t ) eLane, &xLatency );
+    pxStats->ulOutput = xLatency.ulWritten;
+    pxStats->ulMaxLatencyUs = xLatency.ulMaxUs;
+    pxStats->ullLatencySumUs = xLatency.ullSumUs;
+}
+
+/* Outputs one message from the highest lane that has one, pdFALSE if all
+are empty */
+static BaseType_t prvOutputOne( void )
+{
+    LaneState_t *pxLane;
+    LaneItem_t xItem;
+    UBaseType_t uxWaiting;
+
+    for( int iLane = 0; iLane < laneCOUNT; iLane++ )
+    {
+        pxLane = &xLanes[ iLane ];
+        uxWaiting = uxQueueMessagesWaiting( pxLane->xQueue );
+
+        if( ( uxWaiting > 0 ) && ( xQueueReceive( pxLane->xQueue, &xItem, 0 ) == pdPASS ) )
+        {
+            vBatchWriterWriteTimed( xItem.pcString, strlen( xItem.pcString ), ( UBaseType_t ) iLane, xItem.ulSentUs );
+
+            taskENTER_CRITICAL();
+            {
+                if( uxWaiting > pxLane->xStats.ulMaxWaiting )
+                {
+                    pxLane->xStats.ulMaxWaiting = ( uint32_t ) uxWaiting;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if( iLane == eLaneUrgent )
+            {
+                vBatchWriterFlush();
+            }
+            return pdTRUE;
+        }
+    }
+    return pdFALSE;
+}
+
+static void prvReport( TickType_t xNow )
+{
+    char cLine[ REPORT_LINE_LENGTH ];
+    LaneStats_t xStats;
+    int iLength;
+
+    for( int iLane = 0; iLane < laneCOUNT; iLane++ )
+    {
+        vLaneGetStats( ( Lane_t ) iLane, &xStats );
+
+        iLength = snprintf( cLine, sizeof( cLine ), "lane,%lu,%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\r\n",
+                            ( unsigned long ) ( ( uint64_t ) xNow * 1000 / configTICK_RATE_HZ ),
+                            pcLaneNames[ iLane ],
+                            ( unsigned long ) xLanes[ iLane ].xConfig.uxDepth,
+                            ( unsigned long ) xStats.ulSent,
+                            ( unsigned long ) xStats.ulDropped,
+                            ( unsigned long ) xStats.ulFull,
+                            ( unsigned long ) xStats.ulMaxWaiting,
+                            ( unsigned long ) xStats.ulOutput,
+                            ( unsigned long ) ( xStats.ulOutput ? xStats.ullLatencySumUs / xStats.ulOutput : 0 ),
+                            ( unsigned long ) xStats.ulMaxLatencyUs );
+        if( iLength > 0 )
+        {
+            vBatchWriterWrite( cLine, ( ( size_t ) iLength < sizeof( cLine ) ) ? ( size_t ) iLength : sizeof( cLine ) - 1 );
+        }
+    }
+}
+
+/* Ticks until the next report, portMAX_DELAY if there are none */
+static TickType_t prvServiceReport( void )
+{
+    const TickType_t xNow = xTaskGetTickCount();
+
+    if( xReportPeriod == 0 )
+    {
+        return portMAX_DELAY;
+    }
+
+    if( ( TickType_t ) ( xNow - xLastReport ) >= xReportPeriod )
+    {
+        xLastReport += xReportPeriod;
+        if( ( TickType_t ) ( xNow - xLastReport ) >= xReportPeriod )
+        {
+            xLastReport = xNow;
+        }
+        prvReport( xNow );
+    }
+    return xReportPeriod - ( TickType_t ) ( xNow - xLastReport );
+}
+
+static void prvLaneGatekeeperTask( void *pvParameters )
+{
+    TickType_t xBlockTime = portMAX_DELAY, xReportWait;
+
+    /* The only task that writes to standard out. Each message sent gives the
+    notification once, so one take can find several messages waiting. */
+    for( ;; )
+    {
+        ulTaskNotifyTake( pdTRUE, xBlockTime );
+
+        /* Urgent is checked again before every message, note 1 */
+        while( prvOutputOne() != pdFALSE )
+        {
+        }
+
+        xReportWait = prvServiceReport();
+        xBlockTime = xBatchWriterService();
+        if( xReportWait < xBlockTime )
+        {
+            xBlockTime = xReportWait;
+        }
+    }
+}
+
+TaskHandle_t xLaneGatekeeperStart( const LaneConfig_t pxConfigs[ laneCOUNT ], UBaseType_t uxPriority,
+                           TickType_t xFlushDeadline, TickType_t xPeriod )
+{
+    configASSERT( laneCOUNT <= batchwriterMAX_SOURCES );
+    xReportPeriod = xPeriod;
+    xLastReport = xTaskGetTickCount();
+
+    for( int iLane = 0; iLane < laneCOUNT; iLane++ )
+    {
+        configASSERT( pxConfigs[ iLane ].uxDepth > 0 );
+        xLanes[ iLane ].xConfig = pxConfigs[ iLane ];
+        memset( &xLanes[ iLane ].xStats, 0, sizeof( LaneStats_t ) );
+
+        /* Not xExampleQueueCreate(), which has one queue per call site */
+        xLanes[ iLane ].xQueue = xQueueCreate( pxConfigs[ iLane ].uxDepth, sizeof( LaneItem_t ) );
+        configASSERT( xLanes[ iLane ].xQueue != NULL );
+    }
+
+    xExampleTaskCreate( prvLaneGatekeeperTask, "LaneGK", GATEKEEPER_STACK_SIZE, NULL, uxPriority, &xGatekeeperTask );
+    vBatchWriterStart( uxPriority, xFlushDeadline, xPeriod );
+    return xGatekeeperTask;
+}
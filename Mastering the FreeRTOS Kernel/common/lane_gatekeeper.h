@@ -0,0 +1,97 @@
+#ifndef LANE_GATEKEEPER_H
+#define LANE_GATEKEEPER_H
+
+#include <stdint.h>
+#include <FreeRTOS.h>
+#include <task.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) A stdout gatekeeper with three lanes, a queue each: urgent, normal and
+ * bulk. The gatekeeper always outputs from the highest lane that has a
+ * message, so urgent messages pass everything already waiting without
+ * xQueueSendToFront() reordering one shared queue. After an urgent message
+ * the output buffer (common/batch_writer.h) is flushed at once; the others
+ * wait for the batch to fill or its deadline.
+ *
+ * 2) Every lane has its own depth and overflow policy, for when a sender finds
+ * it full:
+ *
+ * eLaneDropNewest - the new message is dropped, xLanePrint() returns pdFAIL.
+ * eLaneDropOldest - the oldest waiting message is dropped to make room.
+ * eLaneBlock      - the sender waits up to the lane's xBlockTime for room,
+ *                   then drops the new message as eLaneDropNewest does.
+ *
+ * Drops are counted per lane, and so are the sends that found the lane full
+ * (ulFull), which is the backpressure a sender saw even when nothing was lost.
+ * From an ISR eLaneBlock can't wait and drops the new message.
+ *
+ * 3) Messages are pointers to strings that must outlive the output, string
+ * literals as in gatekeeperTask_printString.cpp. Each carries the time it was
+ * sent, and the latency is measured when the fwrite() that carries it
+ * returns (note 5 of batch_writer.h), so it includes the wait for the flush.
+ * output counts the messages written out by then.
+ *
+ * 4) If a report period is given, the gatekeeper adds one line per lane to
+ * its own output every period, totals since the start:
+ *
+ *   lane,<uptime_ms>,<lane>,<depth>,<sent>,<dropped>,<full>,<max_waiting>,<output>,<mean_latency_us>,<max_latency_us>
+ *
+ * 5) The senders give the gatekeeper task's notification after each send,
+ * and it drains the lanes when woken. A queue set would be the other way to
+ * wait on three queues, but eLaneDropOldest takes from a queue outside the
+ * set's select, which a queue set does not allow.
+ *******************************************************************************/
+
+typedef enum
+{
+    eLaneUrgent,
+    eLaneNormal,
+    eLaneBulk,
+    laneCOUNT
+} Lane_t;
+
+typedef enum
+{
+    eLaneDropNewest,
+    eLaneDropOldest,
+    eLaneBlock
+} LaneOverflow_t;
+
+typedef struct
+{
+    UBaseType_t uxDepth;
+    LaneOverflow_t eOverflow;
+    TickType_t xBlockTime;              /* eLaneBlock only */
+} LaneConfig_t;
+
+typedef struct
+{
+    uint32_t ulSent;                    /* Accepted into the lane */
+    uint32_t ulDropped;
+    uint32_t ulFull;
+    uint32_t ulMaxWaiting;
+    uint32_t ulOutput;                  /* Written out, with their latency */
+    uint32_t ulMaxLatencyUs;
+    uint64_t ullLatencySumUs;
+} LaneStats_t;
+
+/* Creates the lanes, the gatekeeper task and its batch writer (at the same
+priority). xReportPeriod 0 for no report lines. Returns the gatekeeper task. */
+TaskHandle_t xLaneGatekeeperStart( const LaneConfig_t pxConfigs[ laneCOUNT ], UBaseType_t uxPriority,
+                           TickType_t xFlushDeadline, TickType_t xReportPeriod );
+
+/* pdFAIL if the message was dropped */
+BaseType_t xLanePrint( Lane_t eLane, const char *pcString );
+BaseType_t xLanePrintFromISR( Lane_t eLane, const char *pcString, BaseType_t *pxHigherPriorityTaskWoken );
+
+void vLaneGetStats( Lane_t eLane, LaneStats_t *pxStats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LANE_GATEKEEPER_H */
@@ -0,0 +1,104 @@
+#include <FreeRTOS.h>
+#include <task.h>
+#include "msg_pool.h"
+
+void vMsgPoolInit( MsgPool_t *pxPool, void *pvStorage, size_t xBlockSize, uint32_t ulBlockCount )
+{
+    configASSERT( ( pvStorage != NULL ) && ( xBlockSize > 0 ) && ( ulBlockCount > 0 ) );
+    configASSERT( ( ( uintptr_t ) pvStorage % sizeof( void * ) ) == 0 );
+
+    pxPool->pucStorage = ( uint8_t * ) pvStorage;
+    pxPool->xBlockSize = msgpoolBLOCK_WORDS( xBlockSize ) * sizeof( void * );
+    pxPool->pvFreeList = NULL;
+    pxPool->xStats.ulBlockCount = ulBlockCount;
+    pxPool->xStats.ulInUse = 0;
+    pxPool->xStats.ulHighWaterMark = 0;
+    pxPool->xStats.ulAllocFailures = 0;
+
+    /* Thread the free list through the blocks, lowest address first */
+    for( uint32_t i = ulBlockCount; i > 0; i-- )
+    {
+        void **ppvBlock = ( void ** ) &pxPool->pucStorage[ ( i - 1 ) * pxPool->xBlockSize ];
+        *ppvBlock = pxPool->pvFreeList;
+        pxPool->pvFreeList = ppvBlock;
+    }
+}
+
+/* Both run inside the caller's critical section. */
+static void *prvPop( MsgPool_t *pxPool )
+{
+    void **ppvBlock = ( void ** ) pxPool->pvFreeList;
+
+    if( ppvBlock == NULL )
+    {
+        pxPool->xStats.ulAllocFailures++;
+        return NULL;
+    }
+
+    pxPool->pvFreeList = *ppvBlock;
+    if( ++pxPool->xStats.ulInUse > pxPool->xStats.ulHighWaterMark )
+    {
+        pxPool->xStats.ulHighWaterMark = pxPool->xStats.ulInUse;
+    }
+    return ppvBlock;
+}
+
+static void prvPush( MsgPool_t *pxPool, void *pvBlock )
+{
+    const size_t xOffset = ( size_t ) ( ( uint8_t * ) pvBlock - pxPool->pucStorage );
+
+    configASSERT( ( ( uint8_t * ) pvBlock >= pxPool->pucStorage ) &&
+                  ( xOffset < pxPool->xStats.ulBlockCount * pxPool->xBlockSize ) &&
+                  ( ( xOffset % pxPool->xBlockSize ) == 0 ) );
+    configASSERT( pxPool->xStats.ulInUse > 0 );
+
+    *( void ** ) pvBlock = pxPool->pvFreeList;
+    pxPool->pvFreeList = pvBlock;
+    pxPool->xStats.ulInUse--;
+}
+
+void *pvMsgPoolAlloc( MsgPool_t *pxPool )
+{
+    void *pvBlock;
+
+    taskENTER_CRITICAL();
+    pvBlock = prvPop( pxPool );
+    taskEXIT_CRITICAL();
+
+    return pvBlock;
+}
+
+void *pvMsgPoolAllocFromISR( MsgPool_t *pxPool )
+{
+    UBaseType_t uxSavedInterruptStatus;
+    void *pvBlock;
+
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    pvBlock = prvPop( pxPool );
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    return pvBlock;
+}
+
+void vMsgPoolRelease( MsgPool_t *pxPool, void *pvBlock )
+{
+    taskENTER_CRITICAL();
+    prvPush( pxPool, pvBlock );
+    taskEXIT_CRITICAL();
+}
+
+void vMsgPoolReleaseFromISR( MsgPool_t *pxPool, void *pvBlock )
+{
+    UBaseType_t uxSavedInterruptStatus;
+
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    prvPush( pxPool, pvBlock );
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+}
+
+void vMsgPoolGetStats( MsgPool_t *pxPool, MsgPoolStats_t *pxStats )
+{
+    taskENTER_CRITICAL();
+    *pxStats = pxPool->xStats;
+    taskEXIT_CRITICAL();
+}
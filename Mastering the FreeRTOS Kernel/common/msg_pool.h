@@ -0,0 +1,71 @@
+#ifndef MSG_POOL_H
+#define MSG_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <FreeRTOS.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) Sending a buffer by pointer through a queue avoids copying it, but
+ * allocating it with pvPortMalloc() per message walks heap_4's free list
+ * (first fit) with the scheduler suspended, and mixing message sizes with
+ * other allocations fragments the heap over time. A message pool is a fixed
+ * number of equally sized blocks: allocating pops the head of a free list,
+ * releasing pushes it back, both O(1) and without fragmentation.
+ *
+ * 2) The free list is threaded through the unused blocks themselves, so the
+ * pool needs no memory beyond the blocks. Each block is rounded up to a
+ * multiple of sizeof( void * ) so that every block stays pointer aligned.
+ *
+ * 3) The list is only touched inside a critical section, a handful of
+ * instructions long, so blocks can be allocated and released from tasks and
+ * ISRs alike (the FromISR variants in ISRs). Allocation never blocks: when the
+ * pool is empty NULL is returned and the failure is counted.
+ *
+ * 4) A block must go back to the pool it came from, exactly once.
+ * configASSERT() catches pointers that are not the start of one of its blocks.
+ *******************************************************************************/
+
+/* Pointer aligned storage for ulBlockCount blocks of xBlockSize bytes, to be
+passed to vMsgPoolInit() with the same sizes. */
+#define msgpoolBLOCK_WORDS( xBlockSize )    ( ( ( xBlockSize ) + sizeof( void * ) - 1 ) / sizeof( void * ) )
+#define msgpoolDEFINE_STORAGE( xName, xBlockSize, ulBlockCount ) \
+    void *xName[ msgpoolBLOCK_WORDS( xBlockSize ) * ( ulBlockCount ) ]
+
+typedef struct
+{
+    uint32_t ulBlockCount;
+    uint32_t ulInUse;
+    uint32_t ulHighWaterMark;       /* Most blocks ever in use at once */
+    uint32_t ulAllocFailures;       /* Allocations that found the pool empty */
+} MsgPoolStats_t;
+
+typedef struct
+{
+    uint8_t *pucStorage;
+    size_t xBlockSize;              /* Rounded up, see note 2 */
+    void *pvFreeList;
+    MsgPoolStats_t xStats;
+} MsgPool_t;
+
+void vMsgPoolInit( MsgPool_t *pxPool, void *pvStorage, size_t xBlockSize, uint32_t ulBlockCount );
+
+/* A block of at least xBlockSize bytes, or NULL if all are in use. */
+void *pvMsgPoolAlloc( MsgPool_t *pxPool );
+void *pvMsgPoolAllocFromISR( MsgPool_t *pxPool );
+
+void vMsgPoolRelease( MsgPool_t *pxPool, void *pvBlock );
+void vMsgPoolReleaseFromISR( MsgPool_t *pxPool, void *pvBlock );
+
+/* A consistent copy of the counters. */
+void vMsgPoolGetStats( MsgPool_t *pxPool, MsgPoolStats_t *pxStats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MSG_POOL_H */
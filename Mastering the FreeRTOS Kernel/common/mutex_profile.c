@@ -0,0 +1,232 @@
+#include <stdio.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include "pico/time.h"
+#include "mutex_profile.h"
+#include "reporter.h"
+
+static ProfiledMutex_t *volatile pxProfiledMutexes;
+static SemaphoreHandle_t xReportMutex;
+
+static uint32_t prvBucket( uint32_t ulUs )
+{
+    /* Bucket i holds [2^(i-1), 2^i) */
+    const uint32_t ulBucket = ( ulUs == 0 ) ? 0 : ( uint32_t ) ( 32 - __builtin_clz( ulUs ) );
+
+    return ( ulBucket < mutexprofileHISTOGRAM_BUCKETS ) ? ulBucket : mutexprofileHISTOGRAM_BUCKETS - 1;
+}
+
+static uint32_t prvElapsedUs( uint64_t ullSinceUs )
+{
+    const uint64_t ullElapsedUs = time_us_64() - ullSinceUs;
+
+    return ( ullElapsedUs > UINT32_MAX ) ? UINT32_MAX : ( uint32_t ) ullElapsedUs;
+}
+
+void vMutexProfileInit( ProfiledMutex_t *pxMutex, SemaphoreHandle_t xMutex, const char *pcName )
+{
+    configASSERT( xMutex != NULL );
+
+    pxMutex->xMutex = xMutex;
+    pxMutex->pcName = pcName;
+    pxMutex->ullTakenUs = 0;
+    pxMutex->xStats = ( MutexProfileStats_t ) { 0 };
+    pxMutex->xStats.pcMaxHoldOwner = "-";
+
+    taskENTER_CRITICAL();
+    {
+        pxMutex->pxNext = pxProfiledMutexes;
+        pxProfiledMutexes = pxMutex;
+    }
+    taskEXIT_CRITICAL();
+}
+
+BaseType_t xMutexProfileTake( ProfiledMutex_t *pxMutex, TickType_t xTicksToWait )
+{
+    const uint64_t ullStartUs = time_us_64();
+    BaseType_t xContended = pdFALSE, xInherits = pdFALSE, xTaken;
+    TaskHandle_t xHolder;
+    uint32_t ulWaitUs;
+
+    xTaken = xSemaphoreTake( pxMutex->xMutex, 0 );
+    if( xTaken == pdFAIL )
+    {
+        xContended = pdTRUE;
+
+        /* Note 2 */
+        xHolder = xSemaphoreGetMutexHolder( pxMutex->xMutex );
+        xInherits = ( xTicksToWait != 0 ) && ( xHolder != NULL ) &&
+                    ( uxTaskPriorityGet( xHolder ) < uxTaskPriorityGet( NULL ) );
+
+        xTaken = xSemaphoreTake( pxMutex->xMutex, xTicksToWait );
+    }
+    ulWaitUs = prvElapsedUs( ullStartUs );
+
+    taskENTER_CRITICAL();
+    {
+        MutexProfileStats_t *pxStats = &pxMutex->xStats;
+
+        pxStats->ulContended += ( xContended != pdFALSE );
+        pxStats->ulInheritances += ( xInherits != pdFALSE );
+        if( xTaken == pdFAIL )
+        {
+            pxStats->ulTimeouts++;
+        }
+        else
+        {
+            pxStats->ulTakes++;
+            pxStats->ullWaitSumUs += ulWaitUs;
+            pxStats->ulWaitHistogram[ prvBucket( ulWaitUs ) ]++;
+            if( ulWaitUs > pxStats->ulMaxWaitUs )
+            {
+                pxStats->ulMaxWaitUs = ulWaitUs;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( xTaken == pdPASS )
+    {
+        pxMutex->ullTakenUs = time_us_64();
+    }
+    return xTaken;
+}
+
+BaseType_t xMutexProfileGive( ProfiledMutex_t *pxMutex )
+{
+    /* Still the owner, no one else writes ullTakenUs */
+    const uint32_t ulHoldUs = prvElapsedUs( pxMutex->ullTakenUs );
+
+    taskENTER_CRITICAL();
+    {
+        MutexProfileStats_t *pxStats = &pxMutex->xStats;
+
+        pxStats->ullHoldSumUs += ulHoldUs;
+        pxStats->ulHoldHistogram[ prvBucket( ulHoldUs ) ]++;
+        if( ulHoldUs > pxStats->ulMaxHoldUs )
+        {
+            pxStats->ulMaxHoldUs = ulHoldUs;
+            pxStats->pcMaxHoldOwner = pcTaskGetName( NULL );
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xSemaphoreGive( pxMutex->xMutex );
+}
+
+void vMutexProfileGetStats( ProfiledMutex_t *pxMutex, MutexProfileStats_t *pxStats )
+{
+    taskENTER_CRITICAL();
+    {
+        *pxStats = pxMutex->xStats;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/* The upper bound of the bucket holding the 99th percentile */
+static uint32_t prvP99Us( const uint32_t *pulHistogram, uint32_t ulCount, uint32_t ulMaxUs )
+{
+    const uint32_t ulRank = ( uint32_t ) ( ( ( uint64_t ) ulCount * 99 + 99 ) / 100 );
+    uint32_t ulSeen = 0;
+
+    if( ulCount == 0 )
+    {
+        return 0;
+    }
+    for( uint32_t i = 0; i < mutexprofileHISTOGRAM_BUCKETS - 1; i++ )
+    {
+        ulSeen += pulHistogram[ i ];
+        if( ulSeen >= ulRank )
+        {
+            return ( ( 1u << i ) < ulMaxUs ) ? ( 1u << i ) : ulMaxUs;
+        }
+    }
+    return ulMaxUs;
+}
+
+static void prvPrintHistogram( const char *pcPrefix, const char *pcName, const uint32_t *pulHistogram )
+{
+    printf( "%s,%s", pcPrefix, pcName );
+    for( uint32_t i = 0; i < mutexprofileHISTOGRAM_BUCKETS; i++ )
+    {
+        printf( ",%lu", ( unsigned long ) pulHistogram[ i ] );
+    }
+    printf( "\r\n" );
+}
+
+void vMutexProfileDump( void )
+{
+    const unsigned long ulUptimeMs = ( unsigned long ) ( ( uint64_t ) xTaskGetTickCount() * 1000 / configTICK_RATE_HZ );
+    MutexProfileStats_t xStats;
+    uint32_t ulHolds;
+
+    for( ProfiledMutex_t *pxMutex = pxProfiledMutexes; pxMutex != NULL; pxMutex = pxMutex->pxNext )
+    {
+        vMutexProfileGetStats( pxMutex, &xStats );
+        if( xStats.ulTakes == 0 )
+        {
+            continue;
+        }
+
+        /* A take still held has no hold yet */
+        ulHolds = 0;
+        for( uint32_t i = 0; i < mutexprofileHISTOGRAM_BUCKETS; i++ )
+        {
+            ulHolds += xStats.ulHoldHistogram[ i ];
+        }
+
+        printf( "mtx,%lu,%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%s\r\n", ulUptimeMs, pxMutex->pcName,
+                ( unsigned long ) xStats.ulTakes, ( unsigned long ) xStats.ulContended,
+                ( unsigned long ) xStats.ulTimeouts, ( unsigned long ) xStats.ulInheritances,
+                ( unsigned long ) ( xStats.ullWaitSumUs / xStats.ulTakes ),
+                ( unsigned long ) prvP99Us( xStats.ulWaitHistogram, xStats.ulTakes, xStats.ulMaxWaitUs ),
+                ( unsigned long ) xStats.ulMaxWaitUs,
+                ( unsigned long ) ( ulHolds ? xStats.ullHoldSumUs / ulHolds : 0 ),
+                ( unsigned long ) prvP99Us( xStats.ulHoldHistogram, ulHolds, xStats.ulMaxHoldUs ),
+                ( unsigned long ) xStats.ulMaxHoldUs, xStats.pcMaxHoldOwner );
+
+        prvPrintHistogram( "mtxw", pxMutex->pcName, xStats.ulWaitHistogram );
+        prvPrintHistogram( "mtxh", pxMutex->pcName, xStats.ulHoldHistogram );
+    }
+}
+
+/* Taken directly, so the report's own takes are not in the stats */
+static void prvReportTake( void )
+{
+    if( xReportMutex != NULL )
+    {
+        xSemaphoreTake( xReportMutex, portMAX_DELAY );
+    }
+}
+
+static void prvReportGive( void )
+{
+    if( xReportMutex != NULL )
+    {
+        xSemaphoreGive( xReportMutex );
+    }
+}
+
+static void prvReportStart( TickType_t xWakeTime )
+{
+    ( void ) xWakeTime;
+    prvReportTake();
+    printf( "mtx,uptime_ms,mutex,takes,contended,timeouts,inheritances,mean_wait_us,p99_wait_us,max_wait_us,"
+            "mean_hold_us,p99_hold_us,max_hold_us,max_hold_owner\r\n" );
+    prvReportGive();
+}
+
+static void prvReport( TickType_t xWakeTime )
+{
+    ( void ) xWakeTime;
+    prvReportTake();
+    vMutexProfileDump();
+    prvReportGive();
+}
+
+void vMutexProfileStartReporter( TickType_t xPeriod, SemaphoreHandle_t xOutputMutex )
+{
+    xReportMutex = xOutputMutex;
+    vReporterStart( "MutexStats", xPeriod, prvReportStart, prvReport );
+}
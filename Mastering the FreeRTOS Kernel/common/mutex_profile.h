@@ -0,0 +1,94 @@
+#ifndef MUTEX_PROFILE_H
+#define MUTEX_PROFILE_H
+
+#include <stdint.h>
+#include <FreeRTOS.h>
+#include <semphr.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) xSemaphoreTake()/xSemaphoreGive() on a mutex, with the waits and holds
+ * recorded, to find the locks that cost latency:
+ *
+ *   static ProfiledMutex_t xLock;
+ *   vMutexProfileInit( &xLock, xExampleSemaphoreCreateMutex(), "stdout" );
+ *   if( xMutexProfileTake( &xLock, portMAX_DELAY ) == pdPASS ) { ...; xMutexProfileGive( &xLock ); }
+ *
+ * Every take and give of the mutex has to go through these. Recursive mutexes
+ * aren't supported: the hold is timed from one take to one give.
+ *
+ * 2) A take is contended when the mutex wasn't free straight away. The wait is
+ * from the call to the mutex being taken, so uncontended takes are in the
+ * histogram too, as its first buckets. A contended take whose holder had a
+ * lower priority than the caller is counted as a priority inheritance: the
+ * kernel raises the holder to the caller's priority until it gives the mutex.
+ * The holder and its priority are read just before blocking, so a holder
+ * that gives the mutex in between can be missed or miscounted.
+ *
+ * 3) The hold is from the take to the give, in the owner, and includes any
+ * time the owner was preempted while holding. The name of the task that held
+ * it longest is kept with the max.
+ *
+ * 4) Waits and holds go into histograms of mutexprofileHISTOGRAM_BUCKETS power
+ * of two buckets, bucket i counting times less than 2^i us and the last one
+ * everything above, so the p99 reported is the upper bound of its bucket.
+ *
+ * 5) vMutexProfileDump() prints every profiled mutex, and
+ * vMutexProfileStartReporter() does so every period, totals since the init:
+ *
+ *   mtx,<uptime_ms>,<mutex>,<takes>,<contended>,<timeouts>,<inheritances>,<mean_wait_us>,<p99_wait_us>,<max_wait_us>,<mean_hold_us>,<p99_hold_us>,<max_hold_us>,<max_hold_owner>
+ *   mtxw,<mutex>,<bucket 0>,...,<bucket mutexprofileHISTOGRAM_BUCKETS-1>
+ *   mtxh,<mutex>,<bucket 0>,...,<bucket mutexprofileHISTOGRAM_BUCKETS-1>
+ *******************************************************************************/
+
+#define mutexprofileHISTOGRAM_BUCKETS   16
+
+typedef struct
+{
+    uint32_t ulTakes;
+    uint32_t ulContended;
+    uint32_t ulTimeouts;
+    uint32_t ulInheritances;
+    uint32_t ulMaxWaitUs;
+    uint32_t ulMaxHoldUs;
+    const char *pcMaxHoldOwner;
+    uint64_t ullWaitSumUs;
+    uint64_t ullHoldSumUs;
+    uint32_t ulWaitHistogram[ mutexprofileHISTOGRAM_BUCKETS ];
+    uint32_t ulHoldHistogram[ mutexprofileHISTOGRAM_BUCKETS ];
+} MutexProfileStats_t;
+
+/* Only for its size, the fields are private to mutex_profile.c */
+typedef struct ProfiledMutex
+{
+    SemaphoreHandle_t xMutex;
+    const char *pcName;
+    uint64_t ullTakenUs;                /* Written by the owner only */
+    MutexProfileStats_t xStats;
+    struct ProfiledMutex *pxNext;       /* For the dump */
+} ProfiledMutex_t;
+
+/* xMutex is created by the caller, so it can be static, see common/static_alloc.h */
+void vMutexProfileInit( ProfiledMutex_t *pxMutex, SemaphoreHandle_t xMutex, const char *pcName );
+
+BaseType_t xMutexProfileTake( ProfiledMutex_t *pxMutex, TickType_t xTicksToWait );
+BaseType_t xMutexProfileGive( ProfiledMutex_t *pxMutex );
+
+void vMutexProfileGetStats( ProfiledMutex_t *pxMutex, MutexProfileStats_t *pxStats );
+
+/* Prints the lines of note 5 for every profiled mutex */
+void vMutexProfileDump( void );
+
+/* Creates a task that calls vMutexProfileDump() every xPeriod. If the tasks
+serialise stdout with a mutex, pass it as xOutputMutex (else NULL): the report
+then holds it, taken directly and not through the profile, while it prints. */
+void vMutexProfileStartReporter( TickType_t xPeriod, SemaphoreHandle_t xOutputMutex );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MUTEX_PROFILE_H */
@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "pico/time.h"
+#include "periodic_task.h"
+#include "reporter.h"
+
+static PeriodicTask_t *volatile pxPeriodicTasks;
+
+static uint64_t prvTicksToUs( TickType_t xTicks )
+{
+    return ( uint64_t ) xTicks * 1000000u / configTICK_RATE_HZ;
+}
+
+static uint32_t prvBucket( uint32_t ulLateUs )
+{
+    /* Bucket i holds [2^(i-1), 2^i) */
+    const uint32_t ulBucket = ( ulLateUs == 0 ) ? 0 : ( uint32_t ) ( 32 - __builtin_clz( ulLateUs ) );
+
+    return ( ulBucket < periodicHISTOGRAM_BUCKETS ) ? ulBucket : periodicHISTOGRAM_BUCKETS - 1;
+}
+
+void vPeriodicTaskInit( PeriodicTask_t *pxTask, TickType_t xPeriod )
+{
+    pxTask->xPeriod = xPeriod;
+    pxTask->xLastWake = xTaskGetTickCount();
+    pxTask->xAnchorTick = pxTask->xLastWake;
+    pxTask->ullAnchorUs = 0;
+    pxTask->pcName = pcTaskGetName( NULL );
+    pxTask->xStats = ( PeriodicJitterStats_t ) { 0 };
+    pxTask->xStats.ulMinUs = UINT32_MAX;
+
+    taskENTER_CRITICAL();
+    {
+        pxTask->pxNext = pxPeriodicTasks;
+        pxPeriodicTasks = pxTask;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void vPeriodicTaskWait( PeriodicTask_t *pxTask )
+{
+    const BaseType_t xWasDelayed = xTaskDelayUntil( &pxTask->xLastWake, pxTask->xPeriod );
+    const uint64_t ullNowUs = time_us_64();
+    const uint64_t ullTickUs = prvTicksToUs( pxTask->xLastWake - pxTask->xAnchorTick );
+    uint64_t ullExpectedUs;
+    uint32_t ulLateUs;
+
+    /* The first wake, or one earlier than any so far, is the new best case */
+    if( ( pxTask->ullAnchorUs == 0 ) || ( ullNowUs < pxTask->ullAnchorUs + ullTickUs ) )
+    {
+        pxTask->xAnchorTick = pxTask->xLastWake;
+        pxTask->ullAnchorUs = ullNowUs;
+    }
+    ullExpectedUs = ullPeriodicTaskReleaseUs( pxTask );
+    ulLateUs = ( ullNowUs - ullExpectedUs > UINT32_MAX ) ? UINT32_MAX : ( uint32_t ) ( ullNowUs - ullExpectedUs );
+
+    /* Against a reporter on the other core, a few adds */
+    taskENTER_CRITICAL();
+    {
+        PeriodicJitterStats_t *pxStats = &pxTask->xStats;
+
+        pxStats->ulWakes++;
+        if( xWasDelayed == pdFALSE )
+        {
+            pxStats->ulOverruns++;
+        }
+        if( ulLateUs < pxStats->ulMinUs )
+        {
+            pxStats->ulMinUs = ulLateUs;
+        }
+        if( ulLateUs > pxStats->ulMaxUs )
+        {
+            pxStats->ulMaxUs = ulLateUs;
+        }
+        pxStats->ullSumUs += ulLateUs;
+        pxStats->ulHistogram[ prvBucket( ulLateUs ) ]++;
+    }
+    taskEXIT_CRITICAL();
+}
+
+uint64_t ullPeriodicTaskReleaseUs( PeriodicTask_t *pxTask )
+{
+    return pxTask->ullAnchorUs + prvTicksToUs( pxTask->xLastWake - pxTask->xAnchorTick );
+}
+
+void vPeriodicTaskGetStats( PeriodicTask_t *pxTask, PeriodicJitterStats_t *pxStats )
+{
+    taskENTER_CRITICAL();
+    {
+        *pxStats = pxTask->xStats;
+    }
+    taskEXIT_CRITICAL();
+}
+
+uint32_t ulPeriodicTaskP99Us( const PeriodicJitterStats_t *pxStats )
+{
+    const uint32_t ulRank = ( uint32_t ) ( ( ( uint64_t ) pxStats->ulWakes * 99 + 99 ) / 100 );
+    uint32_t ulSeen = 0;
+
+    if( pxStats->ulWakes == 0 )
+    {
+        return 0;
+    }
+    for( uint32_t i = 0; i < periodicHISTOGRAM_BUCKETS - 1; i++ )
+    {
+        ulSeen += pxStats->ulHistogram[ i ];
+        if( ulSeen >= ulRank )
+        {
+            return ( ( 1u << i ) < pxStats->ulMaxUs ) ? ( 1u << i ) : pxStats->ulMaxUs;
+        }
+    }
+    return pxStats->ulMaxUs;
+}
+
+static void prvReportStart( TickType_t xWakeTime )
+{
+    ( void ) xWakeTime;
+    printf( "jit,uptime_ms,task,wakes,overruns,min_us,mean_us,p99_us,max_us\r\n" );
+}
+
+static void prvReport( TickType_t xWakeTime )
+{
+    PeriodicJitterStats_t xStats;
+
+    for( PeriodicTask_t *pxTask = pxPeriodicTasks; pxTask != NULL; pxTask = pxTask->pxNext )
+    {
+        vPeriodicTaskGetStats( pxTask, &xStats );
+        if( xStats.ulWakes == 0 )
+        {
+            continue;
+        }
+
+        printf( "jit,%lu,%s,%lu,%lu,%lu,%lu,%lu,%lu\r\n",
+                ( unsigned long ) ( prvTicksToUs( xWakeTime ) / 1000 ), pxTask->pcName,
+                ( unsigned long ) xStats.ulWakes, ( unsigned long ) xStats.ulOverruns,
+                ( unsigned long ) xStats.ulMinUs, ( unsigned long ) ( xStats.ullSumUs / xStats.ulWakes ),
+                ( unsigned long ) ulPeriodicTaskP99Us( &xStats ), ( unsigned long ) xStats.ulMaxUs );
+
+        printf( "jith,%s", pxTask->pcName );
+        for( uint32_t i = 0; i < periodicHISTOGRAM_BUCKETS; i++ )
+        {
+            printf( ",%lu", ( unsigned long ) xStats.ulHistogram[ i ] );
+        }
+        printf( "\r\n" );
+    }
+}
+
+void vPeriodicTaskStartReporter( TickType_t xPeriod )
+{
+    vReporterStart( "PeriodicStats", xPeriod, prvReportStart, prvReport );
+}
@@ -0,0 +1,88 @@
+#ifndef PERIODIC_TASK_H
+#define PERIODIC_TASK_H
+
+#include <stdint.h>
+#include <FreeRTOS.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) vTaskDelayUntil() for a periodic loop, with the wake time of every
+ * iteration recorded against the one expected:
+ *
+ *   PeriodicTask_t xLoop;
+ *   vPeriodicTaskInit( &xLoop, pdMS_TO_TICKS( 5 ) );
+ *   for( ;; ) { ...work...; vPeriodicTaskWait( &xLoop ); }
+ *
+ * 2) The lateness of a wake is the microsecond time (time_us_64()) at which
+ * vPeriodicTaskWait() returns, less the time of the tick it was due on. The
+ * time of a tick isn't known, so it is taken from the earliest wake seen:
+ * lateness is measured against the task's best case, and is the preemption,
+ * interrupts and critical sections between the tick and the task running.
+ *
+ * 3) An overrun is a call of vPeriodicTaskWait() after the next wake time had
+ * already passed, i.e. an iteration that took longer than the period.
+ * vTaskDelayUntil() then returns at once, and the wake is counted as late.
+ *
+ * 4) Lateness goes into a histogram of periodicHISTOGRAM_BUCKETS power of two
+ * buckets, bucket i counting wakes less than 2^i us late and the last one
+ * everything above, so the p99 reported is the upper bound of its bucket;
+ * min, max and mean are exact.
+ *
+ * 5) vPeriodicTaskStartReporter() prints, every period, one line per loop:
+ *
+ *   jit,<uptime_ms>,<task>,<wakes>,<overruns>,<min_us>,<mean_us>,<p99_us>,<max_us>
+ *   jith,<task>,<bucket 0>,...,<bucket periodicHISTOGRAM_BUCKETS-1>
+ *
+ * The counts are since vPeriodicTaskInit().
+ *******************************************************************************/
+
+#define periodicHISTOGRAM_BUCKETS   16
+
+typedef struct
+{
+    uint32_t ulWakes;
+    uint32_t ulOverruns;
+    uint32_t ulMinUs;
+    uint32_t ulMaxUs;
+    uint64_t ullSumUs;
+    uint32_t ulHistogram[ periodicHISTOGRAM_BUCKETS ];
+} PeriodicJitterStats_t;
+
+/* Only for its size, the fields are private to periodic_task.c */
+typedef struct PeriodicTask
+{
+    TickType_t xPeriod;
+    TickType_t xLastWake;
+    TickType_t xAnchorTick;             /* The tick of the earliest wake */
+    uint64_t ullAnchorUs;               /* and its time, see note 2 */
+    const char *pcName;
+    PeriodicJitterStats_t xStats;
+    struct PeriodicTask *pxNext;        /* For the reporter */
+} PeriodicTask_t;
+
+/* Call from the periodic task, before its loop. */
+void vPeriodicTaskInit( PeriodicTask_t *pxTask, TickType_t xPeriod );
+
+/* vTaskDelayUntil() by the period, then records the wake. */
+void vPeriodicTaskWait( PeriodicTask_t *pxTask );
+
+/* When the wake vPeriodicTaskWait() last returned from was due, in the
+time_us_64() time of note 2 */
+uint64_t ullPeriodicTaskReleaseUs( PeriodicTask_t *pxTask );
+
+void vPeriodicTaskGetStats( PeriodicTask_t *pxTask, PeriodicJitterStats_t *pxStats );
+
+/* The upper bound of the bucket holding the 99th percentile, in us */
+uint32_t ulPeriodicTaskP99Us( const PeriodicJitterStats_t *pxStats );
+
+/* Creates a task that prints the stats of every loop each xPeriod, see note 5. */
+void vPeriodicTaskStartReporter( TickType_t xPeriod );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PERIODIC_TASK_H */
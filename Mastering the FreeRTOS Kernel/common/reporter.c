@@ -0,0 +1,20 @@
+#include <FreeRTOS.h>
+#include <task.h>
+#include "reporter.h"
+
+void vReporterTask( void *pvParameters )
+{
+    const Reporter_t *pxReporter = ( const Reporter_t * ) pvParameters;
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+
+    if( pxReporter->pxStart != NULL )
+    {
+        pxReporter->pxStart( xLastWakeTime );
+    }
+
+    for( ;; )
+    {
+        vTaskDelayUntil( &xLastWakeTime, pxReporter->xPeriod );
+        pxReporter->pxReport( xLastWakeTime );
+    }
+}
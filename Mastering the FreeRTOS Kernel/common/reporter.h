@@ -0,0 +1,63 @@
+#ifndef REPORTER_H
+#define REPORTER_H
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include "static_alloc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) The stats modules (deferral_stats, runtime_stats, periodic_task, rm_sched
+ * and mutex_profile) print from a reporter task started with
+ * vReporterStart(). It calls the start function once, e.g. for a CSV header,
+ * and then the report function every period, on vTaskDelayUntil().
+ *
+ * 2) Reporters run at reporterTASK_PRIORITY, just below the daemon task and
+ * so above the tasks they watch: the report still comes out when those
+ * saturate the CPU, which is when it matters. Its printf() is then one of the
+ * things that delays them. An example whose timing assumes nothing runs above
+ * its own tasks builds with EXAMPLE_REPORTER_PRIORITY set below them.
+ *
+ * 3) vReporterStart() is a macro so that, with EXAMPLE_STATIC_ALLOCATION,
+ * every use has its own stack (note 3 of static_alloc.h). Each use must
+ * therefore be reached only once.
+ *******************************************************************************/
+
+#ifdef EXAMPLE_REPORTER_PRIORITY
+#define reporterTASK_PRIORITY   ( EXAMPLE_REPORTER_PRIORITY )
+#else
+#define reporterTASK_PRIORITY   ( configMAX_PRIORITIES - 2 )
+#endif
+
+/* xWakeTime is the tick the reporter woke on */
+typedef void ( *ReporterFunction_t )( TickType_t xWakeTime );
+
+typedef struct
+{
+    TickType_t xPeriod;
+    ReporterFunction_t pxStart;         /* NULL for none */
+    ReporterFunction_t pxReport;
+} Reporter_t;
+
+/* The task started by vReporterStart(), pvParameters is its Reporter_t */
+void vReporterTask( void *pvParameters );
+
+#define vReporterStart( pcName, xReportPeriod, pxStartFunction, pxReportFunction )  \
+    do                                                                              \
+    {                                                                               \
+        static Reporter_t xReporter;                                                \
+        xReporter.xPeriod = ( xReportPeriod );                                      \
+        xReporter.pxStart = ( pxStartFunction );                                    \
+        xReporter.pxReport = ( pxReportFunction );                                  \
+        ( void ) xExampleTaskCreate( vReporterTask, ( pcName ), configMINIMAL_STACK_SIZE, \
+                                     &xReporter, reporterTASK_PRIORITY, NULL );     \
+    } while( 0 )
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* REPORTER_H */
@@ -0,0 +1,265 @@
+#include <stdio.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "pico/time.h"
+#include "rm_sched.h"
+#include "reporter.h"
+
+#if rmBASE_PRIORITY + rmMAX_TASKS > configMAX_PRIORITIES - 2
+#error The rate monotonic priorities must stay below the daemon task
+#endif
+
+/* n(2^(1/n) - 1) in parts per million, for n = 1..rmMAX_TASKS */
+static const uint32_t ulLiuLaylandPpm[ rmMAX_TASKS ] =
+{
+    1000000, 828427, 779763, 756828, 743492, 734772, 728627, 724062
+};
+
+/* Admitted tasks, highest priority (shortest deadline) first */
+static RmTask_t *pxRmTasks[ rmMAX_TASKS ];
+static UBaseType_t uxRmTaskCount;
+
+static uint64_t prvTicksToUs( TickType_t xTicks )
+{
+    return ( uint64_t ) xTicks * 1000000u / configTICK_RATE_HZ;
+}
+
+static TickType_t prvDeadline( const RmTaskParams_t *pxParams )
+{
+    return ( pxParams->xDeadline != 0 ) ? pxParams->xDeadline : pxParams->xPeriod;
+}
+
+/* Budget over period, what ulRmGetUtilisationPpm() adds up */
+static uint64_t prvUtilisationPpm( const RmTaskParams_t *pxParams )
+{
+    return ( uint64_t ) pxParams->ulBudgetUs * 1000000u / prvTicksToUs( pxParams->xPeriod );
+}
+
+/* Exact test for fixed priorities: the worst case response time of each task
+is its budget plus every job released above it meanwhile. */
+static BaseType_t prvResponseTimesFit( RmTask_t *const pxTasks[], UBaseType_t uxCount )
+{
+    for( UBaseType_t i = 0; i < uxCount; i++ )
+    {
+        const uint64_t ullDeadlineUs = prvTicksToUs( prvDeadline( &pxTasks[ i ]->xParams ) );
+        uint64_t ullResponseUs = pxTasks[ i ]->xParams.ulBudgetUs;
+        uint64_t ullNextUs;
+
+        for( ;; )
+        {
+            ullNextUs = pxTasks[ i ]->xParams.ulBudgetUs;
+            for( UBaseType_t j = 0; j < i; j++ )
+            {
+                const uint64_t ullPeriodUs = prvTicksToUs( pxTasks[ j ]->xParams.xPeriod );
+
+                ullNextUs += ( ( ullResponseUs + ullPeriodUs - 1 ) / ullPeriodUs ) * pxTasks[ j ]->xParams.ulBudgetUs;
+            }
+            if( ullNextUs > ullDeadlineUs )
+            {
+                return pdFALSE;
+            }
+            if( ullNextUs == ullResponseUs )
+            {
+                break;
+            }
+            ullResponseUs = ullNextUs;
+        }
+    }
+    return pdTRUE;
+}
+
+/* The bound only holds with every deadline equal to its period */
+static BaseType_t prvAdmit( RmTask_t *const pxTasks[], UBaseType_t uxCount )
+{
+    uint64_t ullUtilisationPpm = 0;
+
+    for( UBaseType_t i = 0; i < uxCount; i++ )
+    {
+        if( prvDeadline( &pxTasks[ i ]->xParams ) != pxTasks[ i ]->xParams.xPeriod )
+        {
+            return prvResponseTimesFit( pxTasks, uxCount );
+        }
+        ullUtilisationPpm += prvUtilisationPpm( &pxTasks[ i ]->xParams );
+    }
+    if( ullUtilisationPpm <= ulLiuLaylandPpm[ uxCount - 1 ] )
+    {
+        return pdTRUE;
+    }
+    return prvResponseTimesFit( pxTasks, uxCount );
+}
+
+/* The execution time so far of the calling task, see note 4 in rm_sched.h */
+static uint32_t prvExecCounterUs( void )
+{
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+    taskYIELD();
+    return ( uint32_t ) ulTaskGetRunTimeCounter( xTaskGetCurrentTaskHandle() );
+#else
+    return time_us_32();
+#endif
+}
+
+static void prvRmTask( void *pvParameters )
+{
+    RmTask_t *pxTask = ( RmTask_t * ) pvParameters;
+    const RmTaskParams_t *pxParams = &pxTask->xParams;
+    const uint64_t ullDeadlineUs = prvTicksToUs( prvDeadline( pxParams ) );
+    uint64_t ullResponseUs;
+    uint32_t ulResponseUs, ulExecUs;
+    BaseType_t xMiss, xOverrun;
+
+    vPeriodicTaskInit( &pxTask->xLoop, pxParams->xPeriod );
+
+    for( ;; )
+    {
+        vPeriodicTaskWait( &pxTask->xLoop );
+
+        ulExecUs = prvExecCounterUs();
+        pxParams->pxJob( pxParams->pvParameters );
+        ulExecUs = prvExecCounterUs() - ulExecUs;
+
+        ullResponseUs = time_us_64() - ullPeriodicTaskReleaseUs( &pxTask->xLoop );
+        ulResponseUs = ( ullResponseUs > UINT32_MAX ) ? UINT32_MAX : ( uint32_t ) ullResponseUs;
+        xMiss = ( ullResponseUs > ullDeadlineUs );
+        xOverrun = ( ulExecUs > pxParams->ulBudgetUs );
+
+        taskENTER_CRITICAL();
+        {
+            RmTaskStats_t *pxStats = &pxTask->xStats;
+
+            pxStats->ulJobs++;
+            pxStats->ulDeadlineMisses += xMiss;
+            pxStats->ulBudgetOverruns += xOverrun;
+            if( ulResponseUs > pxStats->ulMaxResponseUs )
+            {
+                pxStats->ulMaxResponseUs = ulResponseUs;
+            }
+            if( ulExecUs > pxStats->ulMaxExecUs )
+            {
+                pxStats->ulMaxExecUs = ulExecUs;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( pxParams->pxFaultHook != NULL )
+        {
+            if( xMiss )
+            {
+                pxParams->pxFaultHook( pxTask, eRmDeadlineMiss, ulResponseUs );
+            }
+            if( xOverrun )
+            {
+                pxParams->pxFaultHook( pxTask, eRmBudgetOverrun, ulExecUs );
+            }
+        }
+    }
+}
+
+BaseType_t xRmTaskCreate( RmTask_t *pxTask, const RmTaskParams_t *pxParams )
+{
+    RmTask_t *pxCandidates[ rmMAX_TASKS ];
+    UBaseType_t uxAt = 0;
+    UBaseType_t uxCount = uxRmTaskCount + 1;
+
+    configASSERT( ( pxParams->xPeriod > 0 ) && ( prvDeadline( pxParams ) <= pxParams->xPeriod ) );
+    if( uxRmTaskCount == rmMAX_TASKS )
+    {
+        return pdFAIL;
+    }
+
+    pxTask->xParams = *pxParams;
+    pxTask->xHandle = NULL;
+    pxTask->xStats = ( RmTaskStats_t ) { 0 };
+
+    /* After those with a shorter or equal deadline */
+    while( ( uxAt < uxRmTaskCount ) && ( prvDeadline( &pxRmTasks[ uxAt ]->xParams ) <= prvDeadline( pxParams ) ) )
+    {
+        uxAt++;
+    }
+    for( UBaseType_t i = 0, j = 0; i < uxCount; i++ )
+    {
+        pxCandidates[ i ] = ( i == uxAt ) ? pxTask : pxRmTasks[ j++ ];
+    }
+
+    if( prvAdmit( pxCandidates, uxCount ) == pdFALSE )
+    {
+        return pdFAIL;
+    }
+
+    /* Not xExampleTaskCreate(), which has one task per call site */
+    pxTask->uxPriority = rmBASE_PRIORITY + ( uxCount - 1 - uxAt );
+    if( xTaskCreate( prvRmTask, pxParams->pcName, pxParams->uxStackDepth, pxTask,
+                     pxTask->uxPriority, &pxTask->xHandle ) != pdPASS )
+    {
+        return pdFAIL;
+    }
+
+    /* Those above the new task move up one */
+    for( UBaseType_t i = 0; i < uxCount; i++ )
+    {
+        pxRmTasks[ i ] = pxCandidates[ i ];
+        if( pxRmTasks[ i ]->uxPriority != rmBASE_PRIORITY + ( uxCount - 1 - i ) )
+        {
+            pxRmTasks[ i ]->uxPriority = rmBASE_PRIORITY + ( uxCount - 1 - i );
+            vTaskPrioritySet( pxRmTasks[ i ]->xHandle, pxRmTasks[ i ]->uxPriority );
+        }
+    }
+    uxRmTaskCount = uxCount;
+    return pdPASS;
+}
+
+uint32_t ulRmGetUtilisationPpm( void )
+{
+    uint64_t ullPpm = 0;
+
+    for( UBaseType_t i = 0; i < uxRmTaskCount; i++ )
+    {
+        ullPpm += prvUtilisationPpm( &pxRmTasks[ i ]->xParams );
+    }
+    return ( uint32_t ) ullPpm;
+}
+
+UBaseType_t uxRmTaskGetPriority( RmTask_t *pxTask )
+{
+    return pxTask->uxPriority;
+}
+
+const char *pcRmTaskGetName( RmTask_t *pxTask )
+{
+    return pxTask->xParams.pcName;
+}
+
+void vRmTaskGetStats( RmTask_t *pxTask, RmTaskStats_t *pxStats )
+{
+    taskENTER_CRITICAL();
+    {
+        *pxStats = pxTask->xStats;
+    }
+    taskEXIT_CRITICAL();
+}
+
+static void prvReportStart( TickType_t xWakeTime )
+{
+    ( void ) xWakeTime;
+    printf( "rm,uptime_ms,task,priority,jobs,deadline_misses,budget_overruns,max_response_us,max_exec_us\r\n" );
+}
+
+static void prvReport( TickType_t xWakeTime )
+{
+    RmTaskStats_t xStats;
+
+    for( UBaseType_t i = 0; i < uxRmTaskCount; i++ )
+    {
+        vRmTaskGetStats( pxRmTasks[ i ], &xStats );
+        printf( "rm,%lu,%s,%lu,%lu,%lu,%lu,%lu,%lu\r\n",
+                ( unsigned long ) ( prvTicksToUs( xWakeTime ) / 1000 ), pxRmTasks[ i ]->xParams.pcName,
+                ( unsigned long ) pxRmTasks[ i ]->uxPriority, ( unsigned long ) xStats.ulJobs,
+                ( unsigned long ) xStats.ulDeadlineMisses, ( unsigned long ) xStats.ulBudgetOverruns,
+                ( unsigned long ) xStats.ulMaxResponseUs, ( unsigned long ) xStats.ulMaxExecUs );
+    }
+}
+
+void vRmStartReporter( TickType_t xPeriod )
+{
+    vReporterStart( "RmStats", xPeriod, prvReportStart, prvReport );
+}
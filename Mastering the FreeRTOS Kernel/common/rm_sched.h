@@ -0,0 +1,118 @@
+#ifndef RM_SCHED_H
+#define RM_SCHED_H
+
+#include <stdint.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "periodic_task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) Periodic tasks declared by their timing instead of a priority: a period,
+ * a relative deadline (the period if 0) and a budget, the worst case
+ * execution time of one job. xRmTaskCreate() gives every task a priority from
+ * rmBASE_PRIORITY up, the shortest deadline highest. With deadlines equal to
+ * the periods that is rate monotonic, otherwise deadline monotonic, the
+ * optimal fixed priority order either way.
+ *
+ * 2) A task is only created if the set stays schedulable with it, tested at
+ * xRmTaskCreate(): first the Liu and Layland bound, total utilisation (budget
+ * over period) at most n(2^(1/n) - 1), 69% for many tasks. That bound is
+ * sufficient, not necessary, and only holds when every deadline is its
+ * period, so a set above it, or with any shorter deadline, gets the exact
+ * response time analysis: each task's budget plus the preemption by those
+ * above it must fit its deadline.
+ * Both assume the budgets hold and nothing else runs above rmBASE_PRIORITY,
+ * so the reporters (common/reporter.h) must be built to run below it.
+ *
+ * 3) The task calls the job function once a period, through a PeriodicTask_t
+ * (common/periodic_task.h), so its release lateness is reported with the
+ * other loops. Each job is measured: the response time from the tick it was
+ * released on to its end, a deadline miss if over the deadline, and the
+ * execution time, a budget overrun if over the budget. Either calls the
+ * fault hook at once, in the task after the job, and is counted.
+ *
+ * 4) The execution time is exact with run time stats (configGENERATE_RUN_TIME_STATS,
+ * see example_enable_runtime_stats()): a taskYIELD() before and after the job
+ * makes the kernel add the running slice to the task's run time counter.
+ * Without them it is the time from the start to the end of the job, which
+ * includes any preemption and so can flag an overrun the job didn't cause.
+ *
+ * 5) vRmStartReporter() prints, every period, one line per task:
+ *
+ *   rm,<uptime_ms>,<task>,<priority>,<jobs>,<deadline_misses>,<budget_overruns>,<max_response_us>,<max_exec_us>
+ *******************************************************************************/
+
+#ifndef rmBASE_PRIORITY
+#define rmBASE_PRIORITY         2
+#endif
+#define rmMAX_TASKS             8
+
+typedef enum
+{
+    eRmDeadlineMiss,
+    eRmBudgetOverrun
+} RmFault_t;
+
+typedef struct RmTask RmTask_t;
+typedef void ( *RmJobFunction_t )( void *pvParameters );
+
+/* ulUs is the response time for a miss, the execution time for an overrun */
+typedef void ( *RmFaultHook_t )( RmTask_t *pxTask, RmFault_t eFault, uint32_t ulUs );
+
+typedef struct
+{
+    const char *pcName;
+    RmJobFunction_t pxJob;              /* Called once a period, must return */
+    void *pvParameters;
+    configSTACK_DEPTH_TYPE uxStackDepth;
+    TickType_t xPeriod;
+    TickType_t xDeadline;               /* From the release, 0 for the period */
+    uint32_t ulBudgetUs;
+    RmFaultHook_t pxFaultHook;          /* NULL for none */
+} RmTaskParams_t;
+
+typedef struct
+{
+    uint32_t ulJobs;
+    uint32_t ulDeadlineMisses;
+    uint32_t ulBudgetOverruns;
+    uint32_t ulMaxResponseUs;
+    uint32_t ulMaxExecUs;
+} RmTaskStats_t;
+
+/* Only for its size, the fields are private to rm_sched.c */
+struct RmTask
+{
+    RmTaskParams_t xParams;
+    TaskHandle_t xHandle;
+    UBaseType_t uxPriority;
+    PeriodicTask_t xLoop;
+    RmTaskStats_t xStats;
+};
+
+/* Admits and creates the task, and reorders the priorities of those created
+before, see notes 1 and 2. pdFAIL, with nothing created, if the set would not
+be schedulable or is full. Call from main() or a single task. */
+BaseType_t xRmTaskCreate( RmTask_t *pxTask, const RmTaskParams_t *pxParams );
+
+/* Of the admitted tasks, in parts per million of one core */
+uint32_t ulRmGetUtilisationPpm( void );
+
+UBaseType_t uxRmTaskGetPriority( RmTask_t *pxTask );
+
+const char *pcRmTaskGetName( RmTask_t *pxTask );
+
+void vRmTaskGetStats( RmTask_t *pxTask, RmTaskStats_t *pxStats );
+
+/* Creates a task that prints the stats of every task each xPeriod, see note 5. */
+void vRmStartReporter( TickType_t xPeriod );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RM_SCHED_H */
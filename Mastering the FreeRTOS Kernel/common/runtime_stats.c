@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "pico/stdlib.h"
+#include "runtime_stats.h"
+#include "reporter.h"
+
+#define STATS_MAX_TASKS         32
+
+typedef struct
+{
+    UBaseType_t xTaskNumber;
+    uint32_t ulRunTime;
+    uint32_t ulSwitches;
+} TaskSample_t;
+
+/* Static, they are too big for the stack of a small task */
+static TaskStatus_t xStatus[ STATS_MAX_TASKS ];
+static uint32_t ulSwitches[ STATS_MAX_TASKS ];
+static TaskSample_t xLast[ STATS_MAX_TASKS ];
+static UBaseType_t uxLastCount;
+static uint32_t ulLastTotalRunTime;
+
+uint32_t ulRuntimeStatsCounter( void )
+{
+    return time_us_32();
+}
+
+void vRuntimeStatsTaskSwitchedIn( void )
+{
+    TaskHandle_t xTask = xTaskGetCurrentTaskHandle();
+    uintptr_t uxCount = ( uintptr_t ) pvTaskGetThreadLocalStoragePointer( xTask, runtimestatsTLS_INDEX );
+
+    vTaskSetThreadLocalStoragePointer( xTask, runtimestatsTLS_INDEX, ( void * ) ( uxCount + 1 ) );
+}
+
+/* The previous sample of a task, or NULL if it was created since */
+static const TaskSample_t *prvFindLast( UBaseType_t xTaskNumber )
+{
+    for( UBaseType_t i = 0; i < uxLastCount; i++ )
+    {
+        if( xLast[ i ].xTaskNumber == xTaskNumber )
+        {
+            return &xLast[ i ];
+        }
+    }
+    return NULL;
+}
+
+static void prvReportStart( TickType_t xWakeTime )
+{
+    ( void ) xWakeTime;
+    ulLastTotalRunTime = ulRuntimeStatsCounter();
+    printf( "rts,uptime_ms,task,cpu_permille,stack_free_words,switches\r\n" );
+}
+
+static void prvReport( TickType_t xWakeTime )
+{
+    uint32_t ulTotalRunTime, ulPeriod;
+    uint32_t ulRunTime, ulSwitchCount;
+    UBaseType_t uxCount;
+    const TaskSample_t *pxLast;
+
+    /* Keep the tasks from being deleted until their counters are read */
+    vTaskSuspendAll();
+    uxCount = uxTaskGetSystemState( xStatus, STATS_MAX_TASKS, &ulTotalRunTime );
+    for( UBaseType_t i = 0; i < uxCount; i++ )
+    {
+        ulSwitches[ i ] = ( xStatus[ i ].eCurrentState == eDeleted ) ? 0 :
+            ( uint32_t ) ( uintptr_t ) pvTaskGetThreadLocalStoragePointer( xStatus[ i ].xHandle, runtimestatsTLS_INDEX );
+    }
+    ( void ) xTaskResumeAll();
+
+    if( uxCount == 0 )
+    {
+        /* Raise STATS_MAX_TASKS */
+        printf( "rts,too_many_tasks\r\n" );
+        return;
+    }
+
+    /* Counters are free running 32 bit microseconds, so differences are
+    right for periods of up to 71 minutes. */
+    ulPeriod = ulTotalRunTime - ulLastTotalRunTime;
+    for( UBaseType_t i = 0; i < uxCount; i++ )
+    {
+        pxLast = prvFindLast( xStatus[ i ].xTaskNumber );
+        ulRunTime = xStatus[ i ].ulRunTimeCounter - ( pxLast ? pxLast->ulRunTime : 0 );
+        ulSwitchCount = ulSwitches[ i ] - ( pxLast ? pxLast->ulSwitches : 0 );
+
+        printf( "rts,%lu,%s,%lu,%lu,%lu\r\n",
+                ( unsigned long ) ( ( uint64_t ) xWakeTime * 1000 / configTICK_RATE_HZ ),
+                xStatus[ i ].pcTaskName,
+                ( unsigned long ) ( ulPeriod ? ( uint64_t ) ulRunTime * 1000 / ulPeriod : 0 ),
+                ( unsigned long ) xStatus[ i ].usStackHighWaterMark,
+                ( unsigned long ) ulSwitchCount );
+    }
+
+    for( UBaseType_t i = 0; i < uxCount; i++ )
+    {
+        xLast[ i ].xTaskNumber = xStatus[ i ].xTaskNumber;
+        xLast[ i ].ulRunTime = xStatus[ i ].ulRunTimeCounter;
+        xLast[ i ].ulSwitches = ulSwitches[ i ];
+    }
+    uxLastCount = uxCount;
+    ulLastTotalRunTime = ulTotalRunTime;
+}
+
+void vRuntimeStatsStartTask( void )
+{
+    vReporterStart( "RuntimeStats", pdMS_TO_TICKS( RUNTIME_STATS_PERIOD_MS ), prvReportStart, prvReport );
+}
@@ -0,0 +1,53 @@
+#ifndef RUNTIME_STATS_H
+#define RUNTIME_STATS_H
+
+#include <stdint.h>
+#include <FreeRTOS.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) Linked into the examples listed in RUNTIME_STATS_TARGETS (or ALL), and
+ * always into rate_monotonic, which needs the exact execution times, see
+ * example_enable_runtime_stats() in the top level CMakeLists.txt. Those are
+ * built with EXAMPLE_RUNTIME_STATS=1, which FreeRTOSConfig.h turns into
+ * configGENERATE_RUN_TIME_STATS with a microsecond run time counter: the
+ * RP2040's 1 MHz timer, or CLOCK_MONOTONIC on the host. The example itself is
+ * unchanged; the daemon task startup hook starts the stats task.
+ *
+ * 2) Every RUNTIME_STATS_PERIOD_MS the stats task prints one line per task:
+ *
+ *   rts,<uptime_ms>,<task>,<cpu_permille>,<stack_free_words>,<switches>
+ *
+ * cpu_permille is the task's share of the period in 1/1000 of one core (the
+ * two cores of an _smp target add up to 2000), stack_free_words is
+ * uxTaskGetStackHighWaterMark() and switches is how many times the task was
+ * switched in during the period.
+ *
+ * 3) Switches are counted by the traceTASK_SWITCHED_IN() hook in thread local
+ * storage pointer runtimestatsTLS_INDEX of each task, so that slot must not be
+ * used by the examples.
+ *******************************************************************************/
+
+#define runtimestatsTLS_INDEX       ( configNUM_THREAD_LOCAL_STORAGE_POINTERS - 1 )
+
+#ifndef RUNTIME_STATS_PERIOD_MS
+#define RUNTIME_STATS_PERIOD_MS     1000
+#endif
+
+/* portGET_RUN_TIME_COUNTER_VALUE(), in microseconds */
+uint32_t ulRuntimeStatsCounter( void );
+
+/* traceTASK_SWITCHED_IN(), called by the kernel with interrupts masked */
+void vRuntimeStatsTaskSwitchedIn( void );
+
+/* Called from the daemon task startup hook, see common/example_hooks.c */
+void vRuntimeStatsStartTask( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RUNTIME_STATS_H */
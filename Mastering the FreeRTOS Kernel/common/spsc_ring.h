@@ -0,0 +1,189 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <FreeRTOS.h>
+#include <task.h>
+
+/***************************** Important Notes *********************************
+ * 1) Ring<T, N> is a single producer, single consumer ring buffer for paths
+ * that have exactly one writer and one reader, e.g. a task feeding an ISR or
+ * an ISR feeding a task. Every queue call enters a critical section; the ring
+ * never does. The producer only ever writes the head index and the consumer
+ * only ever writes the tail, so acquire/release ordering on those two indices
+ * is all the synchronisation needed, from tasks and ISRs alike.
+ *
+ * 2) When the consumer is a task it can block in xPop() until an item arrives.
+ * It waits on its own task notification (index 0), and the producer only
+ * notifies it while it is actually waiting, so an uncontended push is a copy
+ * and two index updates. Don't use the consumer's notification for anything
+ * else while it waits on the ring.
+ *
+ * 3) Only the consumer may block. xPush() fails when the ring is full, like
+ * xQueueSendToBack() with a block time of 0.
+ *
+ * 4) N must be a power of two. The head and the tail are kept ringCACHE_LINE_SIZE
+ * apart, so on a cached multicore (the host build) the producer's and the
+ * consumer's core don't fight over one cache line. The RP2040 has no data
+ * cache, so there they only need their own word.
+ *******************************************************************************/
+
+#if HOST_POSIX_BUILD
+#define ringCACHE_LINE_SIZE     64
+#else
+#define ringCACHE_LINE_SIZE     4
+#endif
+
+template< typename T, size_t N >
+class Ring
+{
+    static_assert( ( N > 0 ) && ( ( N & ( N - 1 ) ) == 0 ), "Ring length must be a power of two" );
+
+public:
+    /* Producer side from a task, or from an ISR if the consumer never blocks.
+    Wakes the consumer task if it waits in xPop(). */
+    BaseType_t xPush( const T &xItem )
+    {
+        if( !prvPush( xItem ) )
+        {
+            return pdFAIL;
+        }
+        if( prvConsumerWaiting() )
+        {
+            xTaskNotifyGive( xConsumer );
+        }
+        return pdPASS;
+    }
+
+    /* Producer side from an ISR, when the consumer is a task that may block. */
+    BaseType_t xPushFromISR( const T &xItem, BaseType_t *pxHigherPriorityTaskWoken )
+    {
+        if( !prvPush( xItem ) )
+        {
+            return pdFAIL;
+        }
+        if( prvConsumerWaiting() )
+        {
+            vTaskNotifyGiveFromISR( xConsumer, pxHigherPriorityTaskWoken );
+        }
+        return pdPASS;
+    }
+
+    /* Consumer side. Blocks up to xTicksToWait for an item, only from a task. */
+    BaseType_t xPop( T &xItem, TickType_t xTicksToWait = 0 )
+    {
+        TimeOut_t xTimeOut;
+        BaseType_t xEntryTimeSet = pdFALSE;
+
+        for( ;; )
+        {
+            if( prvPop( xItem ) )
+            {
+                return pdPASS;
+            }
+            if( xTicksToWait == 0 )
+            {
+                return pdFAIL;
+            }
+
+            /* As in xQueueReceive(): a pass after a stale notification only
+            waits for what is left of xTicksToWait. */
+            if( xEntryTimeSet == pdFALSE )
+            {
+                vTaskSetTimeOutState( &xTimeOut );
+                xEntryTimeSet = pdTRUE;
+            }
+            else if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+            {
+                __atomic_store_n( &ulConsumerWaiting, 0, __ATOMIC_RELAXED );
+                return pdFAIL;
+            }
+
+            xConsumer = xTaskGetCurrentTaskHandle();
+            /* Release, so the producer sees xConsumer once it sees the flag */
+            __atomic_store_n( &ulConsumerWaiting, 1, __ATOMIC_RELEASE );
+            /* Pairs with the fence in prvConsumerWaiting(): either the producer
+            sees the flag or this check sees its item. */
+            __atomic_thread_fence( __ATOMIC_SEQ_CST );
+            if( xIsEmpty() == pdFALSE )
+            {
+                __atomic_store_n( &ulConsumerWaiting, 0, __ATOMIC_RELAXED );
+                continue;
+            }
+
+            if( ulTaskNotifyTake( pdTRUE, xTicksToWait ) == 0 )
+            {
+                __atomic_store_n( &ulConsumerWaiting, 0, __ATOMIC_RELAXED );
+                return prvPop( xItem ) ? pdPASS : pdFAIL;
+            }
+            /* A notification left from an earlier wait just means another pass. */
+        }
+    }
+
+    /* Consumer side from an ISR, or a task that never blocks. */
+    BaseType_t xPopFromISR( T &xItem )
+    {
+        return prvPop( xItem ) ? pdPASS : pdFAIL;
+    }
+
+    BaseType_t xIsEmpty() const
+    {
+        return ( __atomic_load_n( &ulHead, __ATOMIC_ACQUIRE ) == __atomic_load_n( &ulTail, __ATOMIC_ACQUIRE ) ) ? pdTRUE : pdFALSE;
+    }
+
+    size_t uxItemsWaiting() const
+    {
+        return __atomic_load_n( &ulHead, __ATOMIC_ACQUIRE ) - __atomic_load_n( &ulTail, __ATOMIC_ACQUIRE );
+    }
+
+private:
+    bool prvPush( const T &xItem )
+    {
+        const uint32_t ulLocalHead = ulHead;
+
+        if( ulLocalHead - __atomic_load_n( &ulTail, __ATOMIC_ACQUIRE ) >= N )
+        {
+            return false;
+        }
+        xItems[ ulLocalHead & ( N - 1 ) ] = xItem;
+        __atomic_store_n( &ulHead, ulLocalHead + 1, __ATOMIC_RELEASE );
+        return true;
+    }
+
+    bool prvPop( T &xItem )
+    {
+        const uint32_t ulLocalTail = ulTail;
+
+        if( __atomic_load_n( &ulHead, __ATOMIC_ACQUIRE ) == ulLocalTail )
+        {
+            return false;
+        }
+        xItem = xItems[ ulLocalTail & ( N - 1 ) ];
+        __atomic_store_n( &ulTail, ulLocalTail + 1, __ATOMIC_RELEASE );
+        return true;
+    }
+
+    /* Producer side, after the item is published. Plain loads and stores
+    only, the Cortex-M0+ has no atomic read-modify-write. */
+    bool prvConsumerWaiting()
+    {
+        __atomic_thread_fence( __ATOMIC_SEQ_CST );
+        if( __atomic_load_n( &ulConsumerWaiting, __ATOMIC_ACQUIRE ) == 0 )
+        {
+            return false;
+        }
+        __atomic_store_n( &ulConsumerWaiting, 0, __ATOMIC_RELAXED );
+        return true;
+    }
+
+    /* Free running, written by the producer only */
+    alignas( ringCACHE_LINE_SIZE ) uint32_t ulHead = 0;
+    /* Free running, written by the consumer only */
+    alignas( ringCACHE_LINE_SIZE ) uint32_t ulTail = 0;
+    uint32_t ulConsumerWaiting = 0;
+    TaskHandle_t xConsumer = NULL;
+    alignas( ringCACHE_LINE_SIZE ) T xItems[ N ];
+};
+
+#endif /* SPSC_RING_H */
@@ -0,0 +1,123 @@
+#ifndef STATIC_ALLOC_H
+#define STATIC_ALLOC_H
+
+#include <stdint.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <semphr.h>
+#include <event_groups.h>
+#include <timers.h>
+#include <message_buffer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) The examples create their tasks, queues, semaphores, event groups,
+ * timers and message buffers with the xExample...Create() macros below. They
+ * take the same arguments as the kernel functions they are named after.
+ * Normally they are exactly those functions, and everything comes from the
+ * heap.
+ *
+ * 2) For the examples listed in STATIC_ALLOCATION_TARGETS (or ALL), see
+ * example_enable_static_allocation() in the top level CMakeLists.txt,
+ * EXAMPLE_STATIC_ALLOCATION is set. Each macro then reserves static storage
+ * where it is used (a stack and TCB, a queue's item storage and control
+ * block, ...) and calls the ...Static() function on it. Nothing is taken from
+ * the heap at startup, and every object is its own .bss section in the
+ * <example>.elf.map, so the map shows exactly where the RAM goes.
+ *
+ * 3) Sizes must therefore be compile time constants, and one use of a macro
+ * is one object: a macro reached again, e.g. in a loop, would hand out the
+ * same storage twice. Objects sized at run time or created repeatedly (the
+ * queues of queue_batching.cpp, the benchmarks) keep using the heap.
+ *******************************************************************************/
+
+#if EXAMPLE_STATIC_ALLOCATION
+
+/* xTaskCreate() returns pass/fail and the handle through a pointer. */
+static inline BaseType_t xStaticAllocTaskResult( TaskHandle_t xTask, TaskHandle_t *pxCreatedTask )
+{
+    if( pxCreatedTask != NULL )
+    {
+        *pxCreatedTask = xTask;
+    }
+    return ( xTask != NULL ) ? pdPASS : errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+}
+
+#define xExampleTaskCreate( pxTaskCode, pcName, uxStackDepth, pvParameters, uxPriority, pxCreatedTask ) \
+    __extension__ ( {                                                                   \
+        static StackType_t uxStaticStack[ uxStackDepth ];                               \
+        static StaticTask_t xStaticTask;                                                \
+        xStaticAllocTaskResult( xTaskCreateStatic( ( pxTaskCode ), ( pcName ), ( uxStackDepth ), \
+                                                   ( pvParameters ), ( uxPriority ),    \
+                                                   uxStaticStack, &xStaticTask ),       \
+                                ( pxCreatedTask ) );                                    \
+    } )
+
+#define xExampleQueueCreate( uxQueueLength, uxItemSize )                                \
+    __extension__ ( {                                                                   \
+        static uint8_t ucStaticStorage[ ( uxQueueLength ) * ( uxItemSize ) ];           \
+        static StaticQueue_t xStaticQueue;                                              \
+        xQueueCreateStatic( ( uxQueueLength ), ( uxItemSize ), ucStaticStorage, &xStaticQueue ); \
+    } )
+
+#define xExampleSemaphoreCreateBinary()                                                 \
+    __extension__ ( {                                                                   \
+        static StaticSemaphore_t xStaticSemaphore;                                      \
+        xSemaphoreCreateBinaryStatic( &xStaticSemaphore );                              \
+    } )
+
+#define xExampleSemaphoreCreateCounting( uxMaxCount, uxInitialCount )                   \
+    __extension__ ( {                                                                   \
+        static StaticSemaphore_t xStaticSemaphore;                                      \
+        xSemaphoreCreateCountingStatic( ( uxMaxCount ), ( uxInitialCount ), &xStaticSemaphore ); \
+    } )
+
+#define xExampleSemaphoreCreateMutex()                                                  \
+    __extension__ ( {                                                                   \
+        static StaticSemaphore_t xStaticSemaphore;                                      \
+        xSemaphoreCreateMutexStatic( &xStaticSemaphore );                               \
+    } )
+
+#define xExampleEventGroupCreate()                                                      \
+    __extension__ ( {                                                                   \
+        static StaticEventGroup_t xStaticEventGroup;                                    \
+        xEventGroupCreateStatic( &xStaticEventGroup );                                  \
+    } )
+
+#define xExampleTimerCreate( pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction ) \
+    __extension__ ( {                                                                   \
+        static StaticTimer_t xStaticTimer;                                              \
+        xTimerCreateStatic( ( pcTimerName ), ( xTimerPeriodInTicks ), ( uxAutoReload ), \
+                            ( pvTimerID ), ( pxCallbackFunction ), &xStaticTimer );     \
+    } )
+
+/* A stream buffer's storage is one byte longer than its size */
+#define xExampleMessageBufferCreate( xBufferSizeBytes )                                 \
+    __extension__ ( {                                                                   \
+        static uint8_t ucStaticStorage[ ( xBufferSizeBytes ) + 1 ];                     \
+        static StaticMessageBuffer_t xStaticMessageBuffer;                              \
+        xMessageBufferCreateStatic( ( xBufferSizeBytes ), ucStaticStorage, &xStaticMessageBuffer ); \
+    } )
+
+#else /* EXAMPLE_STATIC_ALLOCATION */
+
+#define xExampleTaskCreate              xTaskCreate
+#define xExampleQueueCreate             xQueueCreate
+#define xExampleSemaphoreCreateBinary   xSemaphoreCreateBinary
+#define xExampleSemaphoreCreateCounting xSemaphoreCreateCounting
+#define xExampleSemaphoreCreateMutex    xSemaphoreCreateMutex
+#define xExampleEventGroupCreate        xEventGroupCreate
+#define xExampleTimerCreate             xTimerCreate
+#define xExampleMessageBufferCreate     xMessageBufferCreate
+
+#endif /* EXAMPLE_STATIC_ALLOCATION */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STATIC_ALLOC_H */
@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "pico/stdlib.h"
+#include "tickless_idle.h"
+#include "static_alloc.h"
+
+#if ( configUSE_TICKLESS_IDLE == 2 )
+#include "hardware/clocks.h"
+#include "hardware/structs/scb.h"
+#include "hardware/structs/systick.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#endif
+
+/* Low, the report is not urgent, but above the examples' own tasks so it
+still comes out when they keep the CPU busy */
+#define REPORT_TASK_PRIORITY    ( configMAX_PRIORITIES - 3 )
+
+static TicklessStats_t xStats;
+
+#if ( configUSE_TICKLESS_IDLE == 2 )
+
+#define TICK_US                 ( 1000000u / configTICK_RATE_HZ )
+
+/* The alarm can be at most 2^31 us ahead, see hardware_alarm_set_target() */
+#define MAX_IDLE_TICKS          ( 0x7FFFFFFFu / TICK_US )
+
+static int iAlarm = -1;
+static uint32_t ulTickReload;
+static uint64_t ullWfiStartUs;
+
+/* Only there to make the alarm interrupt wake the core, the accounting is
+done once vTicklessSuppressTicksAndSleep() is back from WFI */
+static void prvAlarmCallback( uint alarm_num )
+{
+}
+
+void vTicklessPreSleep( uint32_t *pulModifiableIdleTime )
+{
+    /* Clocks not needed while asleep could be gated here, see note 3 */
+    ullWfiStartUs = time_us_64();
+}
+
+void vTicklessPostSleep( uint32_t ulExpectedIdleTime )
+{
+    xStats.ullSleepUs += time_us_64() - ullWfiStartUs;
+}
+
+void vTicklessSuppressTicksAndSleep( uint32_t ulExpectedIdleTime )
+{
+    const uint32_t ulCyclesPerUs = clock_get_hz( clk_sys ) / 1000000u;
+    uint32_t ulModifiableIdleTime;
+    TicklessStep_t xStep;
+    uint64_t ullStopUs, ullDueUs, ullWakeUs, ullRestartUs;
+    uint32_t ulSinceTickUs, ulSavedInterrupts;
+
+    if( iAlarm < 0 )
+    {
+        /* SysTick's reload is still the port's one tick value */
+        ulTickReload = systick_hw->rvr;
+        iAlarm = hardware_alarm_claim_unused( true );
+        hardware_alarm_set_callback( ( uint ) iAlarm, prvAlarmCallback );
+    }
+
+    if( ulExpectedIdleTime > MAX_IDLE_TICKS )
+    {
+        ulExpectedIdleTime = MAX_IDLE_TICKS;
+    }
+
+    ulSavedInterrupts = save_and_disable_interrupts();
+
+    /* Stop the tick; what is left of the current period stays in CVR. A tick
+    that became pending on the way has to be taken first, so don't sleep. */
+    systick_hw->csr &= ~M0PLUS_SYST_CSR_ENABLE_BITS;
+    if( ( eTaskConfirmSleepModeStatus() == eAbortSleep ) || ( ( scb_hw->icsr & M0PLUS_ICSR_PENDSTSET_BITS ) != 0 ) )
+    {
+        systick_hw->csr |= M0PLUS_SYST_CSR_ENABLE_BITS;
+        xStats.ulAborted++;
+        restore_interrupts( ulSavedInterrupts );
+        return;
+    }
+
+    ullStopUs = time_us_64();
+    ulSinceTickUs = ( ulTickReload + 1u - systick_hw->cvr ) / ulCyclesPerUs;
+
+    /* Due at the tick that ends the idle period */
+    ullDueUs = ullStopUs + ( uint64_t ) ulExpectedIdleTime * TICK_US - ulSinceTickUs;
+    if( !hardware_alarm_set_target( ( uint ) iAlarm, from_us_since_boot( ullDueUs ) ) )
+    {
+        ulModifiableIdleTime = ulExpectedIdleTime;
+        configPRE_SLEEP_PROCESSING( ulModifiableIdleTime );
+        if( ulModifiableIdleTime > 0 )
+        {
+            __dsb();
+            __wfi();
+            __isb();
+        }
+        configPOST_SLEEP_PROCESSING( ulExpectedIdleTime );
+    }
+    ullWakeUs = time_us_64();
+    hardware_alarm_cancel( ( uint ) iAlarm );
+
+    /* As late as possible, so the instructions from here to the restart are
+    all that is not accounted for */
+    ullRestartUs = time_us_64();
+    xStep = xTicklessStep( TICK_US, ulSinceTickUs, ullRestartUs - ullStopUs, ulExpectedIdleTime );
+
+    /* One short period back onto the old phase, then whole ticks again: a
+    new reload value only takes effect at the next reload */
+    systick_hw->rvr = xStep.ulUntilTickUs * ulCyclesPerUs - 1u;
+    systick_hw->cvr = 0;
+    systick_hw->csr |= M0PLUS_SYST_CSR_ENABLE_BITS;
+    systick_hw->rvr = ulTickReload;
+    if( xStep.ulTickPending != 0u )
+    {
+        scb_hw->icsr = M0PLUS_ICSR_PENDSTSET_BITS;
+    }
+
+    vTaskStepTick( xStep.ulStepTicks );
+
+    xStats.ulSleeps++;
+    xStats.ullTicksSuppressed += xStep.ulStepTicks;
+    if( ullWakeUs >= ullDueUs )
+    {
+        const uint32_t ulLatencyUs = ( uint32_t ) ( ullWakeUs - ullDueUs );
+
+        xStats.ulTimerWakes++;
+        xStats.ullWakeLatencySumUs += ulLatencyUs;
+        if( ulLatencyUs > xStats.ulWakeLatencyMaxUs )
+        {
+            xStats.ulWakeLatencyMaxUs = ulLatencyUs;
+        }
+    }
+    else
+    {
+        xStats.ulEarlyWakes++;
+    }
+
+    /* The interrupt that woke the core runs now */
+    restore_interrupts( ulSavedInterrupts );
+}
+
+#endif /* configUSE_TICKLESS_IDLE == 2 */
+
+void vTicklessGetStats( TicklessStats_t *pxStats )
+{
+    /* The idle task updates them with interrupts disabled */
+    taskENTER_CRITICAL();
+    {
+        *pxStats = xStats;
+    }
+    taskEXIT_CRITICAL();
+}
+
+static void prvReportTask( void *pvParameters )
+{
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+    TicklessStats_t xNow, xLast;
+    uint64_t ullLastUs = time_us_64(), ullNowUs;
+    uint32_t ulTimerWakes, ulMaxLatencyUs;
+
+    vTicklessGetStats( &xLast );
+    printf( "tickless,uptime_ms,sleeps,aborted,ticks_suppressed,sleep_permille,"
+            "timer_wakes,early_wakes,wake_latency_mean_us,wake_latency_max_us\r\n" );
+
+    for( ;; )
+    {
+        vTaskDelayUntil( &xLastWakeTime, pdMS_TO_TICKS( TICKLESS_REPORT_PERIOD_MS ) );
+
+        vTicklessGetStats( &xNow );
+        ullNowUs = time_us_64();
+
+        /* The maximum is since boot, the rest for the period */
+        ulTimerWakes = xNow.ulTimerWakes - xLast.ulTimerWakes;
+        ulMaxLatencyUs = xNow.ulWakeLatencyMaxUs;
+        printf( "tickless,%lu,%lu,%lu,%llu,%lu,%lu,%lu,%lu,%lu\r\n",
+                ( unsigned long ) ( ullNowUs / 1000u ),
+                ( unsigned long ) ( xNow.ulSleeps - xLast.ulSleeps ),
+                ( unsigned long ) ( xNow.ulAborted - xLast.ulAborted ),
+                ( unsigned long long ) ( xNow.ullTicksSuppressed - xLast.ullTicksSuppressed ),
+                ( unsigned long ) ( ( xNow.ullSleepUs - xLast.ullSleepUs ) * 1000u / ( ullNowUs - ullLastUs ) ),
+                ( unsigned long ) ulTimerWakes,
+                ( unsigned long ) ( xNow.ulEarlyWakes - xLast.ulEarlyWakes ),
+                ( unsigned long ) ( ulTimerWakes ? ( xNow.ullWakeLatencySumUs - xLast.ullWakeLatencySumUs ) / ulTimerWakes : 0 ),
+                ( unsigned long ) ulMaxLatencyUs );
+
+        xLast = xNow;
+        ullLastUs = ullNowUs;
+    }
+}
+
+void vTicklessStartReportTask( void )
+{
+    xExampleTaskCreate( prvReportTask, "Tickless", configMINIMAL_STACK_SIZE, NULL, REPORT_TASK_PRIORITY, NULL );
+}
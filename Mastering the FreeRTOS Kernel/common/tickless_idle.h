@@ -0,0 +1,88 @@
+#ifndef TICKLESS_IDLE_H
+#define TICKLESS_IDLE_H
+
+#include <stdint.h>
+#include "tickless_step.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) Linked into the examples listed in TICKLESS_TARGETS (or ALL), see
+ * example_enable_tickless() in the top level CMakeLists.txt. Those are built
+ * with EXAMPLE_TICKLESS=1, which FreeRTOSConfig.h turns into
+ * configUSE_TICKLESS_IDLE 2 with portSUPPRESS_TICKS_AND_SLEEP() being
+ * vTicklessSuppressTicksAndSleep(). The examples themselves are unchanged.
+ *
+ * 2) When every task is blocked for at least configEXPECTED_IDLE_TIME_BEFORE_SLEEP
+ * ticks, the idle task stops SysTick, arms an RP2040 timer alarm for the tick
+ * at which the kernel next has to run, and sleeps in WFI. Any interrupt wakes
+ * it, the alarm or e.g. a GPIO edge; either way the ticks that passed are
+ * added with vTaskStepTick() and SysTick restarts on its old phase. The 1 MHz
+ * timer keeps running while the core sleeps, so no time is lost.
+ *
+ * 3) Sleep here is the RP2040's light sleep: WFI with the clocks running. The
+ * dormant state stops the crystal and with it the timer, so it can only be
+ * left by a GPIO or RTC edge and the ticks slept through can't be counted to
+ * the microsecond; it suits sleeping until an event, not a tick based kernel.
+ * configPRE_SLEEP_PROCESSING() is where clocks could be gated further
+ * (clocks_hw->sleep_en0/1 with SLEEPDEEP), at the cost of the peripherals
+ * that use them - including USB stdio.
+ *
+ * 4) Every TICKLESS_REPORT_PERIOD_MS a report task started from the daemon
+ * task startup hook prints:
+ *
+ *   tickless,<uptime_ms>,<sleeps>,<aborted>,<ticks_suppressed>,<sleep_permille>,
+ *            <timer_wakes>,<early_wakes>,<wake_latency_mean_us>,<wake_latency_max_us>
+ *
+ * for the period, except wake_latency_max_us which is since boot.
+ * sleep_permille is the residency, the share of the period spent in WFI. A
+ * timer wake is the alarm ending the sleep as planned, and its wake latency
+ * the time from the alarm being due to the core running again.
+ * An early wake is any other interrupt, e.g. the 1 ms USB stdio service
+ * interrupt of the pico-sdk, which caps how long a USB connected Pico sleeps.
+ *
+ * 5) Not on the _smp targets, where FreeRTOSConfig.h keeps the tick, nor on
+ * the host: the POSIX port has no tickless idle. tools/tickless_sim.cpp runs
+ * the tick accounting of tickless_step.h against simulated wake ups instead.
+ *******************************************************************************/
+
+#ifndef TICKLESS_REPORT_PERIOD_MS
+#define TICKLESS_REPORT_PERIOD_MS   5000
+#endif
+
+typedef struct
+{
+    uint32_t ulSleeps;
+    uint32_t ulAborted;             /* eTaskConfirmSleepModeStatus() or a pending tick said no */
+    uint32_t ulTimerWakes;
+    uint32_t ulEarlyWakes;
+    uint64_t ullTicksSuppressed;    /* Passed to vTaskStepTick() */
+    uint64_t ullSleepUs;            /* In WFI */
+    uint64_t ullWakeLatencySumUs;   /* Timer wakes only */
+    uint32_t ulWakeLatencyMaxUs;
+} TicklessStats_t;
+
+/* FreeRTOSConfig.h includes this before TickType_t is defined, so the tick
+counts are uint32_t, which TickType_t is without configUSE_16_BIT_TICKS. */
+
+/* portSUPPRESS_TICKS_AND_SLEEP(), called by the idle task with the scheduler
+suspended */
+void vTicklessSuppressTicksAndSleep( uint32_t ulExpectedIdleTime );
+
+/* configPRE_SLEEP_PROCESSING() and configPOST_SLEEP_PROCESSING() */
+void vTicklessPreSleep( uint32_t *pulModifiableIdleTime );
+void vTicklessPostSleep( uint32_t ulExpectedIdleTime );
+
+/* Totals since boot */
+void vTicklessGetStats( TicklessStats_t *pxStats );
+
+/* Called from the daemon task startup hook, see common/example_hooks.c */
+void vTicklessStartReportTask( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TICKLESS_IDLE_H */
@@ -0,0 +1,52 @@
+#ifndef TICKLESS_STEP_H
+#define TICKLESS_STEP_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The tick accounting of a tickless sleep, kept free of any hardware so that
+tools/tickless_sim.cpp runs exactly this on the host. All times are in the
+same unit, microseconds in tickless_idle.c. */
+typedef struct
+{
+    uint32_t ulStepTicks;       /* For vTaskStepTick() */
+    uint32_t ulUntilTickUs;     /* Restart the tick timer so it next fires after this long */
+    uint32_t ulTickPending;     /* Woken after the idle period ended: pend its last tick now */
+} TicklessStep_t;
+
+/* ulSinceTickUs:        from the last tick to stopping the tick timer
+   ullStoppedUs:         from stopping the tick timer to restarting it
+   ulExpectedIdleTicks:  what the kernel passed to portSUPPRESS_TICKS_AND_SLEEP() */
+static inline TicklessStep_t xTicklessStep( uint32_t ulTickUs, uint32_t ulSinceTickUs, uint64_t ullStoppedUs,
+                                            uint32_t ulExpectedIdleTicks )
+{
+    const uint64_t ullElapsedUs = ( uint64_t ) ulSinceTickUs + ullStoppedUs;
+    uint64_t ullTicks = ullElapsedUs / ulTickUs;
+    TicklessStep_t xStep;
+
+    /* The tick that ends the idle period is left to the tick interrupt, so the
+    kernel unblocks the waiting task from there as usual, and the kernel never
+    steps past the time it expected to wake (vTaskStepTick() asserts that).
+    Woken later than that tick, it is pended to run straight away. */
+    xStep.ulTickPending = ( ullTicks >= ulExpectedIdleTicks ) ? 1u : 0u;
+    if( xStep.ulTickPending != 0u )
+    {
+        ullTicks = ulExpectedIdleTicks - 1u;
+    }
+
+    /* Either way the next tick is on the original grid. A wake more than a
+    whole tick late loses the ticks in between, like a masked tick interrupt
+    would. */
+    xStep.ulStepTicks = ( uint32_t ) ullTicks;
+    xStep.ulUntilTickUs = ulTickUs - ( uint32_t ) ( ullElapsedUs % ulTickUs );
+    return xStep;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TICKLESS_STEP_H */
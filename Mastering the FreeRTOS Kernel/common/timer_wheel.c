@@ -0,0 +1,483 @@
+#include <FreeRTOS.h>
+#include <task.h>
+#include "timer_wheel.h"
+#include "static_alloc.h"
+
+#define wheelSLOT_MASK          ( wheelSLOTS - 1u )
+#define wheelRANGE              ( 1u << ( wheelSLOT_BITS * wheelLEVELS ) )
+#define wheelNOT_RUNNING        0xFFFFu
+
+#define SERVICE_TASK_STACK_SIZE configTIMER_TASK_STACK_DEPTH
+
+static struct
+{
+    WheelLink_t xSlots[ wheelLEVELS * wheelSLOTS ];
+    uint32_t ulOccupied[ wheelLEVELS ];     /* A bit per slot with timers in it */
+    WheelLink_t xExpired;                   /* Waiting for their callbacks */
+    WheelLink_t xCascade;                   /* Being spread over the lower levels */
+    uint32_t ulNow;                         /* The first tick not yet processed */
+    uint32_t ulWakeAt;
+    BaseType_t xSleeping;                   /* Blocked, see prvStart() */
+    BaseType_t xWakeSet;                    /* Blocked until ulWakeAt, not for good */
+    TaskHandle_t xTask;
+    TimerWheelStats_t xStats;
+} xWheel;
+
+/* From here to prvStart(), inside the caller's critical section */
+
+static void prvListInit( WheelLink_t *pxHead )
+{
+    pxHead->pxNext = pxHead;
+    pxHead->pxPrev = pxHead;
+}
+
+static void prvListAppend( WheelLink_t *pxHead, WheelLink_t *pxLink )
+{
+    pxLink->pxNext = pxHead;
+    pxLink->pxPrev = pxHead->pxPrev;
+    pxHead->pxPrev->pxNext = pxLink;
+    pxHead->pxPrev = pxLink;
+}
+
+static void prvListUnlink( WheelLink_t *pxLink )
+{
+    pxLink->pxPrev->pxNext = pxLink->pxNext;
+    pxLink->pxNext->pxPrev = pxLink->pxPrev;
+}
+
+/* Moves all of pxFrom to the end of pxTo, whatever its length */
+static void prvListSplice( WheelLink_t *pxTo, WheelLink_t *pxFrom )
+{
+    if( pxFrom->pxNext != pxFrom )
+    {
+        pxFrom->pxNext->pxPrev = pxTo->pxPrev;
+        pxTo->pxPrev->pxNext = pxFrom->pxNext;
+        pxFrom->pxPrev->pxNext = pxTo;
+        pxTo->pxPrev = pxFrom->pxPrev;
+        prvListInit( pxFrom );
+    }
+}
+
+static uint32_t prvRotateRight( uint32_t ulBits, uint32_t ulBy )
+{
+    return ( ulBy == 0 ) ? ulBits : ( ulBits >> ulBy ) | ( ulBits << ( 32u - ulBy ) );
+}
+
+/* The tick in [ ulDue, ulDue + xSlack ] with the most trailing zero bits,
+so that the windows of different timers meet on the same tick */
+static uint32_t prvApplySlack( uint32_t ulDue, TickType_t xSlack )
+{
+    const uint32_t ulLimit = ulDue + ( uint32_t ) xSlack;
+    uint32_t ulExpiry;
+
+    if( ( xSlack == 0 ) || ( ( int32_t ) ( ulLimit - ulDue ) < 0 ) )
+    {
+        return ulDue;
+    }
+
+    /* Clear every bit below the highest one that differs between the two */
+    ulExpiry = ulLimit & ~( ( 1u << ( 31 - __builtin_clz( ulDue ^ ulLimit ) ) ) - 1u );
+
+    /* Only when the window wraps at 2^32 */
+    return ( ( int32_t ) ( ulExpiry - ulDue ) < 0 ) ? ulDue : ulExpiry;
+}
+
+static void prvInsert( WheelTimer_t *pxTimer )
+{
+    uint32_t ulDelta = pxTimer->ulExpiry - xWheel.ulNow;
+    uint32_t ulExpiry = pxTimer->ulExpiry;
+    uint32_t ulLevel = 0, ulIndex;
+
+    if( ( int32_t ) ulDelta < 0 )
+    {
+        /* Reloaded after it was already due again: next tick */
+        ulDelta = 0;
+        ulExpiry = xWheel.ulNow;
+    }
+    else if( ulDelta >= wheelRANGE )
+    {
+        /* Too far out for the wheel, see note 2 */
+        ulDelta = wheelRANGE - 1u;
+        ulExpiry = xWheel.ulNow + ulDelta;
+    }
+
+    while( ulDelta >= ( 1u << ( wheelSLOT_BITS * ( ulLevel + 1u ) ) ) )
+    {
+        ulLevel++;
+    }
+
+    ulIndex = ( ulExpiry >> ( wheelSLOT_BITS * ulLevel ) ) & wheelSLOT_MASK;
+    prvListAppend( &xWheel.xSlots[ ulLevel * wheelSLOTS + ulIndex ], &pxTimer->xLink );
+    xWheel.ulOccupied[ ulLevel ] |= 1u << ulIndex;
+    pxTimer->usSlot = ( uint16_t ) ( ulLevel * wheelSLOTS + ulIndex );
+}
+
+static void prvRemove( WheelTimer_t *pxTimer )
+{
+    WheelLink_t *pxSlot = &xWheel.xSlots[ pxTimer->usSlot ];
+
+    /* Whether it is still in that slot or already on the cascade or expired
+    list, the slot's bit stays right */
+    prvListUnlink( &pxTimer->xLink );
+    if( pxSlot->pxNext == pxSlot )
+    {
+        xWheel.ulOccupied[ pxTimer->usSlot / wheelSLOTS ] &= ~( 1u << ( pxTimer->usSlot % wheelSLOTS ) );
+    }
+    pxTimer->usSlot = wheelNOT_RUNNING;
+    xWheel.xStats.ulRunning--;
+}
+
+/* Ticks from ulNow to the next tick with a timer due or a slot to spread, or
+wheelRANGE if the wheel is empty */
+static uint32_t prvTicksToNextEvent( void )
+{
+    uint32_t ulBest = wheelRANGE;
+
+    for( uint32_t ulLevel = 0; ulLevel < wheelLEVELS; ulLevel++ )
+    {
+        const uint32_t ulShift = wheelSLOT_BITS * ulLevel;
+        const uint32_t ulSlotTicks = 1u << ulShift;
+        uint32_t ulStart, ulBits, ulTicks;
+
+        if( xWheel.ulOccupied[ ulLevel ] == 0 )
+        {
+            continue;
+        }
+
+        /* Level 0 is due slot by slot, higher levels are spread at the start
+        of theirs */
+        ulStart = ( xWheel.ulNow + ulSlotTicks - 1u ) & ~( ulSlotTicks - 1u );
+        ulBits = prvRotateRight( xWheel.ulOccupied[ ulLevel ], ( ulStart >> ulShift ) & wheelSLOT_MASK );
+        ulTicks = ( ulStart - xWheel.ulNow ) + ( ( uint32_t ) __builtin_ctz( ulBits ) << ulShift );
+        if( ulTicks < ulBest )
+        {
+            ulBest = ulTicks;
+        }
+    }
+
+    return ulBest;
+}
+
+static void prvStart( WheelTimer_t *pxTimer, TickType_t xNow, BaseType_t *pxWakeService )
+{
+    if( pxTimer->usSlot != wheelNOT_RUNNING )
+    {
+        prvRemove( pxTimer );
+    }
+    pxTimer->ulDue = ( uint32_t ) xNow + ( uint32_t ) pxTimer->xPeriod;
+    pxTimer->ulExpiry = prvApplySlack( pxTimer->ulDue, pxTimer->xSlack );
+    prvInsert( pxTimer );
+    xWheel.xStats.ulRunning++;
+
+    /* Only when the service task would sleep past it */
+    *pxWakeService = ( xWheel.xSleeping != pdFALSE ) &&
+                     ( ( xWheel.xWakeSet == pdFALSE ) || ( ( int32_t ) ( pxTimer->ulExpiry - xWheel.ulWakeAt ) < 0 ) );
+    if( *pxWakeService != pdFALSE )
+    {
+        xWheel.xSleeping = pdFALSE;
+    }
+}
+
+/* Processes ulNow, which the service task made the next event. Spreads
+the slots due at it in short critical sections, see note 3. */
+static void prvProcessTick( void )
+{
+    WheelLink_t *pxLink;
+    uint32_t ulIndex;
+
+    taskENTER_CRITICAL();
+    {
+        if( ( xWheel.ulNow & wheelSLOT_MASK ) == 0 )
+        {
+            for( uint32_t ulLevel = 1; ulLevel < wheelLEVELS; ulLevel++ )
+            {
+                ulIndex = ( xWheel.ulNow >> ( wheelSLOT_BITS * ulLevel ) ) & wheelSLOT_MASK;
+                prvListSplice( &xWheel.xCascade, &xWheel.xSlots[ ulLevel * wheelSLOTS + ulIndex ] );
+                xWheel.ulOccupied[ ulLevel ] &= ~( 1u << ulIndex );
+                if( ulIndex != 0 )
+                {
+                    break;
+                }
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    for( ;; )
+    {
+        taskENTER_CRITICAL();
+        pxLink = xWheel.xCascade.pxNext;
+        if( pxLink != &xWheel.xCascade )
+        {
+            prvListUnlink( pxLink );
+            prvInsert( ( WheelTimer_t * ) pxLink );
+            xWheel.xStats.ulCascaded++;
+        }
+        taskEXIT_CRITICAL();
+
+        if( pxLink == &xWheel.xCascade )
+        {
+            break;
+        }
+    }
+
+    taskENTER_CRITICAL();
+    {
+        ulIndex = xWheel.ulNow & wheelSLOT_MASK;
+        if( xWheel.xSlots[ ulIndex ].pxNext != &xWheel.xSlots[ ulIndex ] )
+        {
+            xWheel.xStats.ulExpiryTicks++;
+        }
+        prvListSplice( &xWheel.xExpired, &xWheel.xSlots[ ulIndex ] );
+        xWheel.ulOccupied[ 0 ] &= ~( 1u << ulIndex );
+        xWheel.ulNow++;
+    }
+    taskEXIT_CRITICAL();
+}
+
+static void prvCallExpired( void )
+{
+    WheelTimer_t *pxTimer;
+    WheelTimerCallbackFunction_t pxCallback;
+    uint32_t ulLateTicks;
+
+    for( ;; )
+    {
+        taskENTER_CRITICAL();
+        {
+            pxTimer = NULL;
+            if( xWheel.xExpired.pxNext != &xWheel.xExpired )
+            {
+                pxTimer = ( WheelTimer_t * ) xWheel.xExpired.pxNext;
+                ulLateTicks = ( uint32_t ) xTaskGetTickCount() - pxTimer->ulDue;
+                if( ulLateTicks > xWheel.xStats.ulMaxLateTicks )
+                {
+                    xWheel.xStats.ulMaxLateTicks = ulLateTicks;
+                }
+                if( ulLateTicks > pxTimer->usMaxLateTicks )
+                {
+                    pxTimer->usMaxLateTicks = ( ulLateTicks > 0xFFFFu ) ? 0xFFFFu : ( uint16_t ) ulLateTicks;
+                }
+                if( pxTimer->ulExpiry != pxTimer->ulDue )
+                {
+                    xWheel.xStats.ulDeferred++;
+                }
+
+                prvRemove( pxTimer );
+                if( pxTimer->ucAutoReload != 0 )
+                {
+                    /* From the due tick, not from now or the slack, so the
+                    period doesn't drift */
+                    pxTimer->ulDue += ( uint32_t ) pxTimer->xPeriod;
+                    pxTimer->ulExpiry = prvApplySlack( pxTimer->ulDue, pxTimer->xSlack );
+                    prvInsert( pxTimer );
+                    xWheel.xStats.ulRunning++;
+                }
+                pxCallback = pxTimer->pxCallback;
+                xWheel.xStats.ulExpired++;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( pxTimer == NULL )
+        {
+            break;
+        }
+        pxCallback( pxTimer );
+    }
+}
+
+static void prvServiceTask( void *pvParameters )
+{
+    uint32_t ulTicks, ulNowTick;
+    int32_t lTicksToWait;
+
+    for( ;; )
+    {
+        /* Every event up to the current tick. Past the last of them ulNow
+        jumps straight to the tick after the current one. */
+        ulNowTick = ( uint32_t ) xTaskGetTickCount();
+        for( ;; )
+        {
+            taskENTER_CRITICAL();
+            ulTicks = prvTicksToNextEvent();
+            if( ( ulTicks == wheelRANGE ) || ( ( int32_t ) ( xWheel.ulNow + ulTicks - ulNowTick ) > 0 ) )
+            {
+                xWheel.ulNow = ulNowTick + 1u;
+                taskEXIT_CRITICAL();
+                break;
+            }
+            xWheel.ulNow += ulTicks;
+            taskEXIT_CRITICAL();
+
+            prvProcessTick();
+        }
+
+        prvCallExpired();
+
+        /* Until the next event, which includes the timers the callbacks
+        started, or for good with the wheel empty. A timer started for earlier
+        than that notifies the task. */
+        taskENTER_CRITICAL();
+        {
+            ulTicks = prvTicksToNextEvent();
+            xWheel.xWakeSet = ( ulTicks != wheelRANGE ) ? pdTRUE : pdFALSE;
+            xWheel.ulWakeAt = xWheel.ulNow + ulTicks;
+            xWheel.xSleeping = pdTRUE;
+            lTicksToWait = ( int32_t ) ( xWheel.ulWakeAt - ( uint32_t ) xTaskGetTickCount() );
+        }
+        taskEXIT_CRITICAL();
+
+        if( xWheel.xWakeSet == pdFALSE )
+        {
+            ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        }
+        else if( lTicksToWait > 0 )
+        {
+            ulTaskNotifyTake( pdTRUE, ( TickType_t ) lTicksToWait );
+        }
+
+        taskENTER_CRITICAL();
+        xWheel.xSleeping = pdFALSE;
+        xWheel.xStats.ulServiceWakes++;
+        taskEXIT_CRITICAL();
+    }
+}
+
+void vTimerWheelStart( UBaseType_t uxPriority )
+{
+    for( uint32_t i = 0; i < wheelLEVELS * wheelSLOTS; i++ )
+    {
+        prvListInit( &xWheel.xSlots[ i ] );
+    }
+    prvListInit( &xWheel.xExpired );
+    prvListInit( &xWheel.xCascade );
+    xWheel.ulNow = ( uint32_t ) xTaskGetTickCount();
+
+    xExampleTaskCreate( prvServiceTask, "TmrWheel", SERVICE_TASK_STACK_SIZE, NULL, uxPriority, &xWheel.xTask );
+}
+
+WheelTimerHandle_t xWheelTimerInit( WheelTimer_t *pxTimer, TickType_t xPeriod, UBaseType_t uxAutoReload,
+                                    void *pvTimerID, WheelTimerCallbackFunction_t pxCallback )
+{
+    configASSERT( ( xPeriod > 0 ) && ( pxCallback != NULL ) );
+
+    pxTimer->xPeriod = xPeriod;
+    pxTimer->ucAutoReload = ( uxAutoReload != pdFALSE ) ? 1u : 0u;
+    pxTimer->pvTimerID = pvTimerID;
+    pxTimer->pxCallback = pxCallback;
+    pxTimer->usSlot = wheelNOT_RUNNING;
+    pxTimer->xSlack = 0;
+    pxTimer->usMaxLateTicks = 0;
+    return pxTimer;
+}
+
+BaseType_t xWheelTimerStart( WheelTimerHandle_t xTimer )
+{
+    BaseType_t xWakeService;
+
+    taskENTER_CRITICAL();
+    prvStart( xTimer, xTaskGetTickCount(), &xWakeService );
+    taskEXIT_CRITICAL();
+
+    if( xWakeService != pdFALSE )
+    {
+        xTaskNotifyGive( xWheel.xTask );
+    }
+    return pdPASS;
+}
+
+BaseType_t xWheelTimerStartFromISR( WheelTimerHandle_t xTimer, BaseType_t *pxHigherPriorityTaskWoken )
+{
+    UBaseType_t uxSavedInterruptStatus;
+    BaseType_t xWakeService;
+
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    prvStart( xTimer, xTaskGetTickCountFromISR(), &xWakeService );
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    if( xWakeService != pdFALSE )
+    {
+        vTaskNotifyGiveFromISR( xWheel.xTask, pxHigherPriorityTaskWoken );
+    }
+    return pdPASS;
+}
+
+BaseType_t xWheelTimerStop( WheelTimerHandle_t xTimer )
+{
+    /* A timer left on the wheel only wakes the service task for nothing, so
+    the task is not told about it */
+    taskENTER_CRITICAL();
+    if( xTimer->usSlot != wheelNOT_RUNNING )
+    {
+        prvRemove( xTimer );
+    }
+    taskEXIT_CRITICAL();
+    return pdPASS;
+}
+
+BaseType_t xWheelTimerStopFromISR( WheelTimerHandle_t xTimer )
+{
+    UBaseType_t uxSavedInterruptStatus;
+
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    if( xTimer->usSlot != wheelNOT_RUNNING )
+    {
+        prvRemove( xTimer );
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+    return pdPASS;
+}
+
+BaseType_t xWheelTimerChangePeriod( WheelTimerHandle_t xTimer, TickType_t xNewPeriod )
+{
+    configASSERT( xNewPeriod > 0 );
+
+    taskENTER_CRITICAL();
+    xTimer->xPeriod = xNewPeriod;
+    taskEXIT_CRITICAL();
+    return xWheelTimerStart( xTimer );
+}
+
+BaseType_t xWheelTimerIsTimerActive( WheelTimerHandle_t xTimer )
+{
+    return ( xTimer->usSlot != wheelNOT_RUNNING ) ? pdTRUE : pdFALSE;
+}
+
+void vWheelTimerSetSlack( WheelTimerHandle_t xTimer, TickType_t xSlack )
+{
+    taskENTER_CRITICAL();
+    xTimer->xSlack = xSlack;
+    taskEXIT_CRITICAL();
+}
+
+TickType_t xWheelTimerGetMaxLateness( WheelTimerHandle_t xTimer )
+{
+    return xTimer->usMaxLateTicks;
+}
+
+void *pvWheelTimerGetTimerID( WheelTimerHandle_t xTimer )
+{
+    void *pvID;
+
+    taskENTER_CRITICAL();
+    pvID = xTimer->pvTimerID;
+    taskEXIT_CRITICAL();
+    return pvID;
+}
+
+void vWheelTimerSetTimerID( WheelTimerHandle_t xTimer, void *pvNewID )
+{
+    taskENTER_CRITICAL();
+    xTimer->pvTimerID = pvNewID;
+    taskEXIT_CRITICAL();
+}
+
+void vTimerWheelGetStats( TimerWheelStats_t *pxStats )
+{
+    taskENTER_CRITICAL();
+    *pxStats = xWheel.xStats;
+    taskEXIT_CRITICAL();
+
+    pxStats->ulWakesSaved = pxStats->ulExpired - pxStats->ulExpiryTicks;
+}
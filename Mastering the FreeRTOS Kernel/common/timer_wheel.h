@@ -0,0 +1,136 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <FreeRTOS.h>
+#include <task.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) FreeRTOS software timers keep the running timers in a list sorted by
+ * expiry time, so starting or resetting one walks the list: O(n) in the timers
+ * running. Every start, stop and reset is also a command through a queue of
+ * configTIMER_QUEUE_LENGTH items to the daemon task, which does the walk. With
+ * hundreds of per-connection timeouts that are reset on every packet, that
+ * walk is most of the cost. The timer wheel does the same job in O(1).
+ *
+ * 2) The wheel has wheelLEVELS levels of 32 slots. A slot of level 0 holds the
+ * timers expiring at one tick, a slot of level 1 those of 32 ticks, of level 2
+ * 1024 ticks, and so on: a timer goes into the level whose slots are just fine
+ * enough for how far away it expires. Starting a timer links it into its slot,
+ * stopping it unlinks it, both a few instructions in a critical section and
+ * done by the calling task itself, so they can't fail and never block. Each
+ * time level 0 comes round, the next slot of level 1 is spread over level 0
+ * (and so on up), so every timer is moved at most wheelLEVELS - 1 times.
+ * Timers expiring more than 2^25 ticks away wait in the last level and are
+ * put back there until they come close enough.
+ *
+ * 3) The wheel's own service task, vTimerWheelStart(), takes the place of the
+ * daemon task. It sleeps until the next tick with a timer due or a slot to
+ * spread, worked out from a bit per slot, so no tick is spent on an empty
+ * wheel. Woken, it moves the whole slot due at each passed tick onto the list
+ * of expired timers in one step, then calls their callbacks one after the
+ * other. As with the daemon task, callbacks must not block.
+ *
+ * 4) The API mirrors timers.h: the callback has the shape of
+ * TimerCallbackFunction_t, taking the WheelTimerHandle_t of the timer that
+ * expired, with pvWheelTimerGetTimerID()/vWheelTimerSetTimerID() for per timer
+ * storage. Reset is the same as start, and changing the period restarts the
+ * timer. The caller provides the WheelTimer_t, like xTimerCreateStatic(), and
+ * must stop a timer before reusing its storage.
+ *
+ * 5) A timer can be given a slack with vWheelTimerSetSlack(): it may then
+ * expire up to that many ticks late. Its expiry is moved within the slack to
+ * the tick with the most trailing zero bits, so timers with overlapping
+ * windows land on the same tick and their callbacks share one wake of the
+ * service task instead of waking it each. Auto-reload timers keep their
+ * period from the tick they were due, not from the moved one, so they don't
+ * drift. The lateness, against the due tick, is kept per timer
+ * (xWheelTimerGetMaxLateness()) and can only exceed the slack by the time the
+ * service task waits for the CPU.
+ *******************************************************************************/
+
+#define wheelSLOT_BITS          5
+#define wheelSLOTS              ( 1u << wheelSLOT_BITS )
+#define wheelLEVELS             5
+
+typedef struct WheelLink
+{
+    struct WheelLink *pxNext;
+    struct WheelLink *pxPrev;
+} WheelLink_t;
+
+typedef struct WheelTimer *WheelTimerHandle_t;
+typedef void ( *WheelTimerCallbackFunction_t )( WheelTimerHandle_t xTimer );
+
+/* Only for its size, the fields are private to timer_wheel.c */
+typedef struct WheelTimer
+{
+    WheelLink_t xLink;              /* First, the lists link timers through it */
+    uint32_t ulExpiry;              /* Tick count, modulo 2^32, moved within the slack */
+    uint32_t ulDue;                 /* Tick count, as started */
+    TickType_t xPeriod;
+    TickType_t xSlack;
+    WheelTimerCallbackFunction_t pxCallback;
+    void *pvTimerID;
+    uint16_t usSlot;                /* Level * wheelSLOTS + slot, or not running */
+    uint8_t ucAutoReload;
+    uint16_t usMaxLateTicks;        /* Saturates at 0xFFFF */
+} WheelTimer_t;
+
+typedef struct
+{
+    uint32_t ulRunning;             /* Timers started and not yet stopped or expired */
+    uint32_t ulExpired;             /* Callbacks called */
+    uint32_t ulCascaded;            /* Timers moved down a level */
+    uint32_t ulServiceWakes;
+    uint32_t ulExpiryTicks;         /* Ticks with at least one callback */
+    uint32_t ulWakesSaved;          /* Callbacks that shared their tick with another, see note 5 */
+    uint32_t ulDeferred;            /* Expiries the slack moved to a later tick */
+    uint32_t ulMaxLateTicks;        /* From the due tick to calling the callback */
+} TimerWheelStats_t;
+
+/* Creates the service task, with the priority the daemon task would have.
+Call once, before any timer is started. */
+void vTimerWheelStart( UBaseType_t uxPriority );
+
+/* Initialises a timer in the dormant state and returns its handle. */
+WheelTimerHandle_t xWheelTimerInit( WheelTimer_t *pxTimer, TickType_t xPeriod, UBaseType_t uxAutoReload,
+                                    void *pvTimerID, WheelTimerCallbackFunction_t pxCallback );
+
+/* (Re)starts the timer to expire xPeriod ticks from now. Always pdPASS. */
+BaseType_t xWheelTimerStart( WheelTimerHandle_t xTimer );
+BaseType_t xWheelTimerStartFromISR( WheelTimerHandle_t xTimer, BaseType_t *pxHigherPriorityTaskWoken );
+#define xWheelTimerReset( xTimer )                                  xWheelTimerStart( xTimer )
+#define xWheelTimerResetFromISR( xTimer, pxHigherPriorityTaskWoken ) xWheelTimerStartFromISR( xTimer, pxHigherPriorityTaskWoken )
+
+BaseType_t xWheelTimerStop( WheelTimerHandle_t xTimer );
+BaseType_t xWheelTimerStopFromISR( WheelTimerHandle_t xTimer );
+
+BaseType_t xWheelTimerChangePeriod( WheelTimerHandle_t xTimer, TickType_t xNewPeriod );
+
+BaseType_t xWheelTimerIsTimerActive( WheelTimerHandle_t xTimer );
+
+/* How late the timer may expire, from its next start on. 0, the default,
+expires it on the tick it is due. */
+void vWheelTimerSetSlack( WheelTimerHandle_t xTimer, TickType_t xSlack );
+
+/* The latest the callback ran after the tick the timer was due, since the
+timer was initialised */
+TickType_t xWheelTimerGetMaxLateness( WheelTimerHandle_t xTimer );
+
+/* Like the timers.h ones, these access the timer directly. */
+void *pvWheelTimerGetTimerID( WheelTimerHandle_t xTimer );
+void vWheelTimerSetTimerID( WheelTimerHandle_t xTimer, void *pvNewID );
+
+/* A consistent copy of the counters. */
+void vTimerWheelGetStats( TimerWheelStats_t *pxStats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIMER_WHEEL_H */
@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "bench_time.h"
+#include "trace_recorder.h"
+
+#if HOST_POSIX_BUILD
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+#if ( traceEVENTS_PER_CORE & ( traceEVENTS_PER_CORE - 1 ) ) != 0
+#error traceEVENTS_PER_CORE must be a power of two
+#endif
+
+TraceBuffer_t xTraceBuffer =
+{
+    .cMagic = { 'T', 'R', 'C', '1' },
+#if HOST_POSIX_BUILD
+    .ulResolutionNs = 1,
+#else
+    .ulResolutionNs = 1000,
+#endif
+    .ulEventsPerCore = traceEVENTS_PER_CORE,
+    .usCores = traceNUM_CORES,
+    .usMaxTasks = traceMAX_TASKS,
+    .usMaxObjects = traceMAX_OBJECTS,
+    .usNameLength = traceNAME_LENGTH,
+    .usEventSize = sizeof( TraceEvent_t ),
+};
+
+static volatile BaseType_t xStopped = pdFALSE;
+
+/* uxTaskGetTaskNumber() is 0 until vTaskSetTaskNumber() is called, so each
+task is numbered here as it is created */
+static UBaseType_t uxNextTaskNumber = 0;
+
+static uint32_t prvCoreId( void )
+{
+#if FREE_RTOS_KERNEL_SMP
+    return portGET_CORE_ID();
+#else
+    return 0;
+#endif
+}
+
+static void prvCopyName( char *pcDest, const char *pcName )
+{
+    if( pcName != NULL )
+    {
+        strncpy( pcDest, pcName, traceNAME_LENGTH - 1 );
+    }
+}
+
+void vTraceRecord( TraceEventType_t xEvent, const void *pvObject, uint32_t ulArg, uint32_t ulArg2 )
+{
+    UBaseType_t uxSavedInterruptStatus;
+    TraceCore_t *pxCore;
+    TraceEvent_t *pxEvent;
+
+    if( xStopped != pdFALSE )
+    {
+        return;
+    }
+
+    /* Masking (not a critical section) is enough: it keeps every other writer
+    on this core out, and no other core writes to this ring. */
+    uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+    {
+        const uint32_t ulCore = prvCoreId();
+
+        pxCore = &xTraceBuffer.xCores[ ulCore ];
+        pxEvent = &pxCore->xEvents[ pxCore->ulWritten & ( traceEVENTS_PER_CORE - 1 ) ];
+        pxEvent->ullTimestampNs = ullBenchTimeNs();
+        pxEvent->ucEvent = ( uint8_t ) xEvent;
+        pxEvent->ucCore = ( uint8_t ) ulCore;
+        pxEvent->usTask = ( uint16_t ) uxTaskGetTaskNumber( xTaskGetCurrentTaskHandle() );
+        pxEvent->ulObject = ( uint32_t ) ( uintptr_t ) pvObject;
+        pxEvent->ulArg = ulArg;
+        pxEvent->ulArg2 = ulArg2;
+        pxCore->ulWritten++;
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+}
+
+void vTraceAddObject( const void *pvObject, uint8_t ucType, const char *pcName )
+{
+    const uint32_t ulObject = ( uint32_t ) ( uintptr_t ) pvObject;
+    TraceObject_t *pxObject = NULL;
+
+    taskENTER_CRITICAL();
+    {
+        /* A new object at the address of a deleted one takes over its entry */
+        for( uint32_t i = 0; i < xTraceBuffer.ulObjectCount; i++ )
+        {
+            if( xTraceBuffer.xObjects[ i ].ulObject == ulObject )
+            {
+                pxObject = &xTraceBuffer.xObjects[ i ];
+                break;
+            }
+        }
+        if( ( pxObject == NULL ) && ( xTraceBuffer.ulObjectCount < traceMAX_OBJECTS ) )
+        {
+            pxObject = &xTraceBuffer.xObjects[ xTraceBuffer.ulObjectCount++ ];
+        }
+
+        /* Past traceMAX_OBJECTS objects are shown by address only */
+        if( pxObject != NULL )
+        {
+            memset( pxObject, 0, sizeof( *pxObject ) );
+            pxObject->ulObject = ulObject;
+            pxObject->ucType = ucType;
+            prvCopyName( pxObject->cName, pcName );
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+void vTraceTaskCreate( void *pvTask )
+{
+    /* Called by traceTASK_CREATE() inside a critical section. Task numbers
+    start at 1 and are never reused. */
+    const UBaseType_t uxTaskNumber = ++uxNextTaskNumber;
+
+    vTaskSetTaskNumber( ( TaskHandle_t ) pvTask, uxTaskNumber );
+    if( uxTaskNumber < traceMAX_TASKS )
+    {
+        prvCopyName( xTraceBuffer.cTaskNames[ uxTaskNumber ], pcTaskGetName( ( TaskHandle_t ) pvTask ) );
+    }
+    vTraceRecord( traceEVENT_TASK_CREATE, NULL, ( uint32_t ) uxTaskNumber, 0 );
+}
+
+void vTraceTaskSwitchedIn( void )
+{
+    vTraceRecord( traceEVENT_TASK_SWITCHED_IN, NULL, 0, 0 );
+}
+
+void vTraceDump( TraceSink_t xSink )
+{
+    xStopped = pdTRUE;
+    xSink( &xTraceBuffer, sizeof( xTraceBuffer ) );
+}
+
+#if HOST_POSIX_BUILD
+
+static void prvWriteFile( const void *pvData, size_t xLength )
+{
+    const char *pcPath = getenv( "HOST_TRACE_FILE" );
+    FILE *pxFile;
+
+    if( pcPath == NULL )
+    {
+        pcPath = "trace.bin";
+    }
+    pxFile = fopen( pcPath, "wb" );
+    if( ( pxFile == NULL ) || ( fwrite( pvData, 1, xLength, pxFile ) != xLength ) )
+    {
+        perror( pcPath );
+    }
+    else
+    {
+        fprintf( stderr, "trace written to %s\n", pcPath );
+    }
+    if( pxFile != NULL )
+    {
+        fclose( pxFile );
+    }
+}
+
+static void prvDumpAtExit( void )
+{
+    vTraceDump( prvWriteFile );
+}
+
+/* A plain pthread, not a task, so it doesn't appear in the trace */
+static void *prvDurationThread( void *pvParameters )
+{
+    usleep( ( useconds_t ) ( uintptr_t ) pvParameters * 1000u );
+    exit( EXIT_SUCCESS );
+    return NULL;
+}
+
+/* Runs before main(), so the examples need no changes */
+__attribute__( ( constructor ) ) static void prvHostTraceInit( void )
+{
+    const char *pcDuration = getenv( "HOST_TRACE_DURATION_MS" );
+    sigset_t xAllSignals, xSavedSignals;
+    pthread_t xThread;
+
+    atexit( prvDumpAtExit );
+
+    if( pcDuration != NULL )
+    {
+        /* Created with every signal blocked, so the POSIX port's tick signal
+        is never delivered to it */
+        sigfillset( &xAllSignals );
+        pthread_sigmask( SIG_SETMASK, &xAllSignals, &xSavedSignals );
+        pthread_create( &xThread, NULL, prvDurationThread, ( void * ) ( uintptr_t ) strtoul( pcDuration, NULL, 10 ) );
+        pthread_detach( xThread );
+        pthread_sigmask( SIG_SETMASK, &xSavedSignals, NULL );
+    }
+}
+
+#endif /* HOST_POSIX_BUILD */
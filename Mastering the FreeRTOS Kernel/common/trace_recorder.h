@@ -0,0 +1,196 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Important Notes *********************************
+ * 1) Included by FreeRTOSConfig.h for the examples listed in TRACE_TARGETS (or
+ * ALL), see example_enable_trace() in the top level CMakeLists.txt. It
+ * implements the kernel's trace hooks for task switches, queues (and so
+ * semaphores and mutexes), software timers and event groups, and records each
+ * one as a 24 byte event in xTraceBuffer. The example itself is unchanged.
+ *
+ * 2) There is one ring per core, written with interrupts masked on that core
+ * only, like common/dlog.h. A full ring overwrites its oldest events, so the
+ * buffer always holds the last traceEVENTS_PER_CORE events of each core.
+ *
+ * 3) Timestamps are ullBenchTimeNs(): CLOCK_MONOTONIC on the host and the
+ * 1 MHz timer on the RP2040, whose Cortex-M0+ cores have no cycle counter
+ * (SysTick is per core and reloads every tick). The timer is shared by both
+ * cores, so events of the two cores of an _smp target can be merged.
+ *
+ * 4) xTraceBuffer is self-describing, so getting it out is a plain memory dump:
+ *      RP2040:  (gdb) dump binary value trace.bin xTraceBuffer
+ *      host:    written to trace.bin (or $HOST_TRACE_FILE) on exit(), and
+ *               $HOST_TRACE_DURATION_MS ends the run after that long
+ * or vTraceDump() from the example. tools/trace_to_chrome converts it to a
+ * Chrome trace JSON file, to open in chrome://tracing or ui.perfetto.dev.
+ *******************************************************************************/
+
+#if HOST_POSIX_BUILD
+#define traceEVENTS_PER_CORE    65536
+#else
+#define traceEVENTS_PER_CORE    512
+#endif
+#define traceMAX_TASKS          32
+#define traceMAX_OBJECTS        32
+#define traceNAME_LENGTH        16
+
+#if FREE_RTOS_KERNEL_SMP
+#define traceNUM_CORES          configNUM_CORES
+#else
+#define traceNUM_CORES          1
+#endif
+
+/* Object types. Queues use the kernel's queueQUEUE_TYPE_* values. */
+#define traceOBJECT_TIMER       16
+#define traceOBJECT_EVENT_GROUP 17
+
+typedef enum
+{
+    traceEVENT_TASK_CREATE = 1,         /* ulArg: task number */
+    traceEVENT_TASK_SWITCHED_IN,
+    traceEVENT_QUEUE_CREATE,            /* ulArg: queue type */
+    traceEVENT_QUEUE_SEND,
+    traceEVENT_QUEUE_SEND_FAILED,
+    traceEVENT_QUEUE_SEND_FROM_ISR,
+    traceEVENT_QUEUE_RECEIVE,
+    traceEVENT_QUEUE_RECEIVE_FAILED,
+    traceEVENT_QUEUE_RECEIVE_FROM_ISR,
+    traceEVENT_BLOCKING_ON_QUEUE_SEND,
+    traceEVENT_BLOCKING_ON_QUEUE_RECEIVE,
+    traceEVENT_BLOCKING_ON_QUEUE_PEEK,
+    traceEVENT_TIMER_CREATE,
+    traceEVENT_TIMER_COMMAND_SEND,      /* ulArg: command, ulArg2: value */
+    traceEVENT_TIMER_COMMAND_RECEIVED,  /* ulArg: command, ulArg2: value */
+    traceEVENT_TIMER_EXPIRED,
+    traceEVENT_EVENT_GROUP_CREATE,
+    traceEVENT_EVENT_GROUP_SYNC_BLOCK,  /* ulArg: bits set, ulArg2: bits waited for */
+    traceEVENT_EVENT_GROUP_SYNC_END,    /* ulArg: bits waited for, ulArg2: timed out */
+    traceEVENT_EVENT_GROUP_WAIT_BITS_BLOCK, /* ulArg: bits waited for */
+    traceEVENT_EVENT_GROUP_WAIT_BITS_END,   /* ulArg: bits waited for, ulArg2: timed out */
+    traceEVENT_EVENT_GROUP_CLEAR_BITS,  /* ulArg: bits */
+    traceEVENT_EVENT_GROUP_SET_BITS,    /* ulArg: bits */
+    traceEVENT_EVENT_GROUP_SET_BITS_FROM_ISR, /* ulArg: bits */
+    traceEVENT_EVENT_GROUP_DELETE
+} TraceEventType_t;
+
+typedef struct
+{
+    uint64_t ullTimestampNs;
+    uint8_t ucEvent;
+    uint8_t ucCore;
+    uint16_t usTask;            /* Task number of the running task, 0 before the scheduler starts */
+    uint32_t ulObject;          /* Low 32 bits of the queue, timer or event group handle */
+    uint32_t ulArg;
+    uint32_t ulArg2;
+} TraceEvent_t;
+
+typedef struct
+{
+    uint32_t ulObject;
+    uint8_t ucType;
+    uint8_t ucReserved[ 3 ];
+    char cName[ traceNAME_LENGTH ];
+} TraceObject_t;
+
+typedef struct
+{
+    uint32_t ulWritten;         /* Free running, the newest event is ulWritten - 1 */
+    uint32_t ulReserved;
+    TraceEvent_t xEvents[ traceEVENTS_PER_CORE ];
+} TraceCore_t;
+
+/* Everything tools/trace_to_chrome needs, in one block of memory */
+typedef struct
+{
+    char cMagic[ 4 ];           /* "TRC1" */
+    uint32_t ulResolutionNs;
+    uint32_t ulEventsPerCore;
+    uint16_t usCores;
+    uint16_t usMaxTasks;
+    uint16_t usMaxObjects;
+    uint16_t usNameLength;
+    uint16_t usEventSize;
+    uint16_t usReserved;
+    uint32_t ulObjectCount;
+    TraceObject_t xObjects[ traceMAX_OBJECTS ];
+    char cTaskNames[ traceMAX_TASKS ][ traceNAME_LENGTH ];  /* By task number */
+    TraceCore_t xCores[ traceNUM_CORES ];
+} TraceBuffer_t;
+
+extern TraceBuffer_t xTraceBuffer;
+
+/* Receives the dump, e.g. a function doing fwrite() to a file. */
+typedef void ( *TraceSink_t )( const void *pvData, size_t xLength );
+
+/* Stops recording and passes xTraceBuffer to xSink. */
+void vTraceDump( TraceSink_t xSink );
+
+void vTraceRecord( TraceEventType_t xEvent, const void *pvObject, uint32_t ulArg, uint32_t ulArg2 );
+void vTraceAddObject( const void *pvObject, uint8_t ucType, const char *pcName );
+void vTraceTaskCreate( void *pvTask );
+void vTraceTaskSwitchedIn( void );
+
+/* The kernel's trace hooks. traceTASK_SWITCHED_IN() is defined by
+FreeRTOSConfig.h, as common/runtime_stats.h uses it too. */
+#define traceTASK_CREATE( pxNewTCB )                vTraceTaskCreate( pxNewTCB )
+
+#define traceQUEUE_CREATE( pxNewQueue )                                             \
+    do {                                                                            \
+        vTraceAddObject( pxNewQueue, ucQueueGetQueueType( pxNewQueue ), NULL );     \
+        vTraceRecord( traceEVENT_QUEUE_CREATE, pxNewQueue, ucQueueGetQueueType( pxNewQueue ), 0 ); \
+    } while( 0 )
+#define traceQUEUE_REGISTRY_ADD( xQueue, pcQueueName )  vTraceAddObject( xQueue, ucQueueGetQueueType( xQueue ), pcQueueName )
+#define traceQUEUE_SEND( pxQueue )                  vTraceRecord( traceEVENT_QUEUE_SEND, pxQueue, 0, 0 )
+#define traceQUEUE_SEND_FAILED( pxQueue )           vTraceRecord( traceEVENT_QUEUE_SEND_FAILED, pxQueue, 0, 0 )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue )         vTraceRecord( traceEVENT_QUEUE_SEND_FROM_ISR, pxQueue, 0, 0 )
+#define traceQUEUE_RECEIVE( pxQueue )               vTraceRecord( traceEVENT_QUEUE_RECEIVE, pxQueue, 0, 0 )
+#define traceQUEUE_RECEIVE_FAILED( pxQueue )        vTraceRecord( traceEVENT_QUEUE_RECEIVE_FAILED, pxQueue, 0, 0 )
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue )      vTraceRecord( traceEVENT_QUEUE_RECEIVE_FROM_ISR, pxQueue, 0, 0 )
+#define traceBLOCKING_ON_QUEUE_SEND( pxQueue )      vTraceRecord( traceEVENT_BLOCKING_ON_QUEUE_SEND, pxQueue, 0, 0 )
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )   vTraceRecord( traceEVENT_BLOCKING_ON_QUEUE_RECEIVE, pxQueue, 0, 0 )
+#define traceBLOCKING_ON_QUEUE_PEEK( pxQueue )      vTraceRecord( traceEVENT_BLOCKING_ON_QUEUE_PEEK, pxQueue, 0, 0 )
+
+#define traceTIMER_CREATE( pxNewTimer )                                             \
+    do {                                                                            \
+        vTraceAddObject( pxNewTimer, traceOBJECT_TIMER, pcTimerGetName( pxNewTimer ) ); \
+        vTraceRecord( traceEVENT_TIMER_CREATE, pxNewTimer, 0, 0 );                  \
+    } while( 0 )
+#define traceTIMER_COMMAND_SEND( xTimer, xMessageID, xMessageValueValue, xReturn ) \
+    vTraceRecord( traceEVENT_TIMER_COMMAND_SEND, xTimer, ( uint32_t ) ( xMessageID ), ( uint32_t ) ( xMessageValueValue ) )
+#define traceTIMER_COMMAND_RECEIVED( pxTimer, xMessageID, xMessageValue ) \
+    vTraceRecord( traceEVENT_TIMER_COMMAND_RECEIVED, pxTimer, ( uint32_t ) ( xMessageID ), ( uint32_t ) ( xMessageValue ) )
+#define traceTIMER_EXPIRED( pxTimer )               vTraceRecord( traceEVENT_TIMER_EXPIRED, pxTimer, 0, 0 )
+
+#define traceEVENT_GROUP_CREATE( xEventGroup )                                      \
+    do {                                                                            \
+        vTraceAddObject( xEventGroup, traceOBJECT_EVENT_GROUP, NULL );              \
+        vTraceRecord( traceEVENT_EVENT_GROUP_CREATE, xEventGroup, 0, 0 );           \
+    } while( 0 )
+#define traceEVENT_GROUP_SYNC_BLOCK( xEventGroup, uxBitsToSet, uxBitsToWaitFor ) \
+    vTraceRecord( traceEVENT_EVENT_GROUP_SYNC_BLOCK, xEventGroup, ( uint32_t ) ( uxBitsToSet ), ( uint32_t ) ( uxBitsToWaitFor ) )
+#define traceEVENT_GROUP_SYNC_END( xEventGroup, uxBitsToSet, uxBitsToWaitFor, xTimeoutOccurred ) \
+    vTraceRecord( traceEVENT_EVENT_GROUP_SYNC_END, xEventGroup, ( uint32_t ) ( uxBitsToWaitFor ), ( uint32_t ) ( xTimeoutOccurred ) )
+#define traceEVENT_GROUP_WAIT_BITS_BLOCK( xEventGroup, uxBitsToWaitFor ) \
+    vTraceRecord( traceEVENT_EVENT_GROUP_WAIT_BITS_BLOCK, xEventGroup, ( uint32_t ) ( uxBitsToWaitFor ), 0 )
+#define traceEVENT_GROUP_WAIT_BITS_END( xEventGroup, uxBitsToWaitFor, xTimeoutOccurred ) \
+    vTraceRecord( traceEVENT_EVENT_GROUP_WAIT_BITS_END, xEventGroup, ( uint32_t ) ( uxBitsToWaitFor ), ( uint32_t ) ( xTimeoutOccurred ) )
+#define traceEVENT_GROUP_CLEAR_BITS( xEventGroup, uxBitsToClear ) \
+    vTraceRecord( traceEVENT_EVENT_GROUP_CLEAR_BITS, xEventGroup, ( uint32_t ) ( uxBitsToClear ), 0 )
+#define traceEVENT_GROUP_SET_BITS( xEventGroup, uxBitsToSet ) \
+    vTraceRecord( traceEVENT_EVENT_GROUP_SET_BITS, xEventGroup, ( uint32_t ) ( uxBitsToSet ), 0 )
+#define traceEVENT_GROUP_SET_BITS_FROM_ISR( xEventGroup, uxBitsToSet ) \
+    vTraceRecord( traceEVENT_EVENT_GROUP_SET_BITS_FROM_ISR, xEventGroup, ( uint32_t ) ( uxBitsToSet ), 0 )
+#define traceEVENT_GROUP_DELETE( xEventGroup )      vTraceRecord( traceEVENT_EVENT_GROUP_DELETE, xEventGroup, 0, 0 )
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_RECORDER_H */
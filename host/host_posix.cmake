@@ -0,0 +1,97 @@
+# Builds the FreeRTOS kernel against its GCC POSIX port and provides host
+# stand-ins for the pico-sdk libraries and CMake functions used by the
+# examples, so every chapter's CMakeLists.txt builds unchanged on Linux.
+
+if (DEFINED ENV{FREERTOS_KERNEL_PATH} AND (NOT FREERTOS_KERNEL_PATH))
+    set(FREERTOS_KERNEL_PATH $ENV{FREERTOS_KERNEL_PATH})
+    message("Using FREERTOS_KERNEL_PATH from environment ('${FREERTOS_KERNEL_PATH}')")
+endif ()
+
+if (NOT FREERTOS_KERNEL_PATH)
+    message(FATAL_ERROR "FreeRTOS location was not specified. Please set FREERTOS_KERNEL_PATH.")
+endif()
+
+get_filename_component(FREERTOS_KERNEL_PATH "${FREERTOS_KERNEL_PATH}" REALPATH BASE_DIR "${CMAKE_BINARY_DIR}")
+set(FREERTOS_KERNEL_POSIX_PATH ${FREERTOS_KERNEL_PATH}/portable/ThirdParty/GCC/Posix)
+if (NOT EXISTS ${FREERTOS_KERNEL_POSIX_PATH}/port.c)
+    message(FATAL_ERROR "Directory '${FREERTOS_KERNEL_PATH}' does not contain a POSIX port here: ${FREERTOS_KERNEL_POSIX_PATH}")
+endif()
+set(FREERTOS_KERNEL_PATH ${FREERTOS_KERNEL_PATH} CACHE PATH "Path to the FreeRTOS_KERNEL" FORCE)
+
+find_package(Threads REQUIRED)
+
+# Edges closer together than one tick are injected back to back, raise this to
+# resolve high GPIO interrupt rates (see host/include/host/gpio_injector.h)
+set(HOST_TICK_RATE_HZ 1000 CACHE STRING "configTICK_RATE_HZ of the host build")
+
+# Same target names as the RP2040 port so the examples link them unchanged:
+# FreeRTOS-Kernel is the kernel without a heap, FreeRTOS-Kernel-Heap<n> adds
+# portable/MemMang/heap_<n>.c. Like the pico-sdk libraries these are INTERFACE
+# libraries: the kernel is compiled as part of each example, with that
+# example's compile definitions, so the per-example FreeRTOSConfig.h options
+# (e.g. example_enable_runtime_stats()) work the same on the host.
+add_library(FreeRTOS-Kernel INTERFACE)
+target_sources(FreeRTOS-Kernel INTERFACE
+        ${FREERTOS_KERNEL_PATH}/croutine.c
+        ${FREERTOS_KERNEL_PATH}/event_groups.c
+        ${FREERTOS_KERNEL_PATH}/list.c
+        ${FREERTOS_KERNEL_PATH}/queue.c
+        ${FREERTOS_KERNEL_PATH}/stream_buffer.c
+        ${FREERTOS_KERNEL_PATH}/tasks.c
+        ${FREERTOS_KERNEL_PATH}/timers.c
+        ${FREERTOS_KERNEL_POSIX_PATH}/port.c
+        ${FREERTOS_KERNEL_POSIX_PATH}/utils/wait_for_event.c
+        )
+
+target_include_directories(FreeRTOS-Kernel INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/port   # Wraps the POSIX port's portmacro.h, so must come first
+        ${FREERTOS_KERNEL_PATH}/include
+        ${FREERTOS_KERNEL_POSIX_PATH}
+        ${FREERTOS_KERNEL_POSIX_PATH}/utils
+        "${CMAKE_CURRENT_LIST_DIR}/../Mastering the FreeRTOS Kernel" # For FreeRTOSConfig.h
+        )
+
+# Lets FreeRTOSConfig.h and the examples tell the host build apart
+target_compile_definitions(FreeRTOS-Kernel INTERFACE
+        HOST_POSIX_BUILD=1
+        HOST_TICK_RATE_HZ=${HOST_TICK_RATE_HZ}
+        )
+
+target_link_libraries(FreeRTOS-Kernel INTERFACE Threads::Threads)
+
+foreach(HEAP 1 2 4 5)
+    add_library(FreeRTOS-Kernel-Heap${HEAP} INTERFACE)
+    target_sources(FreeRTOS-Kernel-Heap${HEAP} INTERFACE ${FREERTOS_KERNEL_PATH}/portable/MemMang/heap_${HEAP}.c)
+    target_link_libraries(FreeRTOS-Kernel-Heap${HEAP} INTERFACE FreeRTOS-Kernel)
+endforeach()
+
+# pico-sdk stand-ins. Only the calls the examples make are provided.
+add_library(pico_stdlib INTERFACE)
+target_sources(pico_stdlib INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/src/stdlib.c
+        ${CMAKE_CURRENT_LIST_DIR}/src/gpio.c
+        ${CMAKE_CURRENT_LIST_DIR}/src/gpio_injector.c
+        )
+target_include_directories(pico_stdlib INTERFACE ${CMAKE_CURRENT_LIST_DIR}/include)
+target_link_libraries(pico_stdlib INTERFACE
+        FreeRTOS-Kernel         # GPIO interrupts are delivered by a task
+        m                       # Poisson edge injection
+        )
+
+add_library(pico_rand INTERFACE)
+target_sources(pico_rand INTERFACE ${CMAKE_CURRENT_LIST_DIR}/src/rand.c)
+target_link_libraries(pico_rand INTERFACE pico_stdlib)
+
+add_library(pico_cyw43_arch_none INTERFACE)
+target_sources(pico_cyw43_arch_none INTERFACE ${CMAKE_CURRENT_LIST_DIR}/src/cyw43_arch.c)
+target_link_libraries(pico_cyw43_arch_none INTERFACE pico_stdlib)
+
+# There is no USB/UART selection or uf2/map generation on the host
+function(pico_enable_stdio_usb TARGET ENABLED)
+endfunction()
+
+function(pico_enable_stdio_uart TARGET ENABLED)
+endfunction()
+
+function(pico_add_extra_outputs TARGET)
+endfunction()
@@ -0,0 +1,52 @@
+/*
+ * Host stand-in for the pico-sdk's hardware/gpio.h.
+ *
+ * There are no pins on the host. A registered callback is run by the "GPIO IRQ"
+ * task, created at configMAX_PRIORITIES - 1 so it preempts the examples the way
+ * the real interrupt would. Each line read from stdin is delivered as a falling
+ * edge to every pin that has GPIO_IRQ_EDGE_FALL enabled, unless
+ * host/gpio_injector.h has been configured to generate them.
+ *
+ * As on the RP2040, a pin driven as an output still sees its own level, so
+ * gpio_put() raises the edge interrupts enabled on that pin. The callback then
+ * runs straight away in the calling task, as if the interrupt had preempted it.
+ */
+
+#ifndef _HARDWARE_GPIO_H
+#define _HARDWARE_GPIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned int uint;
+
+#define NUM_BANK0_GPIOS 30
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+
+enum gpio_irq_level {
+    GPIO_IRQ_LEVEL_LOW = 0x1u,
+    GPIO_IRQ_LEVEL_HIGH = 0x2u,
+    GPIO_IRQ_EDGE_FALL = 0x4u,
+    GPIO_IRQ_EDGE_RISE = 0x8u,
+};
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_pull_up(uint gpio);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
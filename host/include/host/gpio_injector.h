@@ -0,0 +1,55 @@
+/*
+ * Host only: drives the GPIO interrupt callback at a programmable edge rate,
+ * in place of pressing Enter (see hardware/gpio.h).
+ *
+ * With no explicit configuration the injector reads the environment, so the
+ * examples need no changes:
+ *
+ *   HOST_GPIO_IRQ_MODE         fixed | poisson | burst (unset: use stdin)
+ *   HOST_GPIO_IRQ_RATE         average falling edges per second, up to 1000000 (default 1000)
+ *   HOST_GPIO_IRQ_BURST        edges per burst in burst mode (default 10)
+ *   HOST_GPIO_IRQ_DURATION_MS  exit() after this long, 0 = forever (default 0)
+ *
+ * Edges are delivered by the "GPIO IRQ" task, so their timing resolution is
+ * one tick: edges due within the same tick arrive back to back. Configure with
+ * a larger HOST_TICK_RATE_HZ to resolve rates above a few kHz.
+ */
+
+#ifndef _HOST_GPIO_INJECTOR_H
+#define _HOST_GPIO_INJECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    HOST_GPIO_INJECT_NONE,      // stdin, one edge per line
+    HOST_GPIO_INJECT_FIXED,     // evenly spaced edges
+    HOST_GPIO_INJECT_POISSON,   // exponentially distributed gaps
+    HOST_GPIO_INJECT_BURST,     // back to back bursts, spaced to give the average rate
+} host_gpio_inject_mode_t;
+
+typedef struct {
+    host_gpio_inject_mode_t mode;
+    uint32_t rate_hz;
+    uint32_t burst_len;
+    uint32_t duration_ms;
+} host_gpio_injector_config_t;
+
+/* Fills config from the HOST_GPIO_IRQ_* environment variables. */
+void host_gpio_injector_config_from_env(host_gpio_injector_config_t *config);
+
+/* Overrides the environment. Call before vTaskStartScheduler(). */
+void host_gpio_injector_configure(const host_gpio_injector_config_t *config);
+
+/* Number of edges delivered so far. */
+uint64_t host_gpio_injector_edges(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,26 @@
+/*
+ * Host stand-in for the pico-sdk's pico/cyw43_arch.h. There is no wireless
+ * chip, so the LED state is only remembered.
+ */
+
+#ifndef _PICO_CYW43_ARCH_H
+#define _PICO_CYW43_ARCH_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CYW43_WL_GPIO_LED_PIN 0
+
+int cyw43_arch_init(void);
+void cyw43_arch_deinit(void);
+void cyw43_arch_gpio_put(unsigned int wl_gpio, bool value);
+bool cyw43_arch_gpio_get(unsigned int wl_gpio);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
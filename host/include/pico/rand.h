@@ -0,0 +1,21 @@
+/*
+ * Host stand-in for the pico-sdk's pico/rand.h.
+ */
+
+#ifndef _PICO_RAND_H
+#define _PICO_RAND_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t get_rand_32(void);
+uint64_t get_rand_64(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,32 @@
+/*
+ * Host stand-in for the pico-sdk's pico/stdlib.h. Only the functions the
+ * examples call are provided; see host/readme.md.
+ */
+
+#ifndef _PICO_STDLIB_H
+#define _PICO_STDLIB_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "pico/time.h"
+#include "hardware/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool stdio_init_all(void);
+
+/* There is no USB CDC on the host, stdout is always "connected". */
+static inline bool stdio_usb_connected(void) { return true; }
+
+static inline void tight_loop_contents(void) {}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
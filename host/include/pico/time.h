@@ -0,0 +1,28 @@
+/*
+ * Host stand-in for the pico-sdk's pico/time.h. The 64-bit microsecond timer
+ * is backed by CLOCK_MONOTONIC.
+ */
+
+#ifndef _PICO_TIME_H
+#define _PICO_TIME_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint64_t time_us_64(void);
+
+static inline uint32_t time_us_32(void) { return (uint32_t)time_us_64(); }
+
+/* As with configSUPPORT_PICO_TIME_INTEROP, these block the calling task
+   (vTaskDelay) once the scheduler is running, and sleep the thread before. */
+void sleep_ms(uint32_t ms);
+void sleep_us(uint64_t us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,27 @@
+/*
+ * Found before the POSIX port's own portmacro.h (see host_posix.cmake), which
+ * it includes and then adjusts for the examples.
+ */
+
+#ifndef HOST_PORTMACRO_H
+#define HOST_PORTMACRO_H
+
+#include_next <portmacro.h>
+
+#if configGENERATE_RUN_TIME_STATS
+/* The POSIX port counts run time with times(), the CPU time of the whole
+process in clock ticks, which says nothing about individual tasks. Use the
+same microsecond counter as the RP2040 build instead (CLOCK_MONOTONIC here). */
+#undef portCONFIGURE_TIMER_FOR_RUN_TIME_STATS
+#undef portGET_RUN_TIME_COUNTER_VALUE
+
+#ifdef __cplusplus
+extern "C"
+#endif
+uint32_t ulRuntimeStatsCounter( void );
+
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()            ulRuntimeStatsCounter()
+#endif
+
+#endif /* HOST_PORTMACRO_H */
@@ -0,0 +1,29 @@
+/*
+ * Host implementation of the pico/cyw43_arch.h stand-in.
+ */
+
+#include "pico/cyw43_arch.h"
+
+static bool led_state;
+
+int cyw43_arch_init(void)
+{
+    return 0;
+}
+
+void cyw43_arch_deinit(void)
+{
+}
+
+void cyw43_arch_gpio_put(unsigned int wl_gpio, bool value)
+{
+    if (wl_gpio == CYW43_WL_GPIO_LED_PIN)
+    {
+        led_state = value;
+    }
+}
+
+bool cyw43_arch_gpio_get(unsigned int wl_gpio)
+{
+    return (wl_gpio == CYW43_WL_GPIO_LED_PIN) ? led_state : false;
+}
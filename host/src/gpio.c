@@ -0,0 +1,147 @@
+/*
+ * Host implementation of the hardware/gpio.h stand-in.
+ *
+ * The POSIX port has no real interrupts, so the registered callback is run
+ * from a task at configMAX_PRIORITIES - 1. The "FromISR" API functions and
+ * portYIELD_FROM_ISR() behave correctly when called from that task.
+ */
+
+#include <poll.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "hardware/gpio.h"
+#include "gpio_internal.h"
+
+#define GPIO_IRQ_TASK_PRIORITY  ( configMAX_PRIORITIES - 1 )
+#define GPIO_IRQ_POLL_MS        10
+
+static gpio_irq_callback_t xIrqCallback = NULL;
+static uint32_t ulIrqEventMask[ NUM_BANK0_GPIOS ];
+static bool xLevel[ NUM_BANK0_GPIOS ];
+static TaskHandle_t xIrqTask = NULL;
+
+static void prvRaisePinIrq( uint gpio, uint32_t ulEvents )
+{
+    uint32_t ulPending = ulIrqEventMask[ gpio ] & ulEvents;
+    if( ( ulPending != 0 ) && ( xIrqCallback != NULL ) )
+    {
+        xIrqCallback( gpio, ulPending );
+    }
+}
+
+/* Calls the registered callback for every pin that listens to one of the
+events in ulEvents, just like the shared GPIO interrupt on the RP2040. */
+void host_gpio_raise_irq( uint32_t ulEvents )
+{
+    for( uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++ )
+    {
+        prvRaisePinIrq( gpio, ulEvents );
+    }
+}
+
+static void prvGpioIrqTask( void *pvParameters )
+{
+    struct pollfd xStdin = { STDIN_FILENO, POLLIN, 0 };
+    char cBuffer[ 64 ];
+    ssize_t xRead;
+
+    ( void ) pvParameters;
+
+    if( host_gpio_injector_config()->mode != HOST_GPIO_INJECT_NONE )
+    {
+        host_gpio_injector_run( host_gpio_injector_config() );
+    }
+
+    for( ;; )
+    {
+        vTaskDelay( pdMS_TO_TICKS( GPIO_IRQ_POLL_MS ) );
+
+        /* Never block in read(), that would stall the whole scheduler. */
+        if( poll( &xStdin, 1, 0 ) <= 0 )
+        {
+            continue;
+        }
+
+        xRead = read( STDIN_FILENO, cBuffer, sizeof( cBuffer ) );
+        if( xRead <= 0 )
+        {
+            /* stdin closed (e.g. </dev/null in CI), nothing more will arrive. */
+            vTaskDelete( NULL );
+        }
+
+        /* Each line is one press of the button pulling the pin low. */
+        for( ssize_t i = 0; i < xRead; i++ )
+        {
+            if( cBuffer[ i ] == '\n' )
+            {
+                host_gpio_raise_irq( GPIO_IRQ_EDGE_FALL | GPIO_IRQ_LEVEL_LOW );
+            }
+        }
+    }
+}
+
+void gpio_init( uint gpio )
+{
+    configASSERT( gpio < NUM_BANK0_GPIOS );
+    xLevel[ gpio ] = false;
+}
+
+void gpio_set_dir( uint gpio, bool out )
+{
+    ( void ) gpio;
+    ( void ) out;
+}
+
+void gpio_put( uint gpio, bool value )
+{
+    configASSERT( gpio < NUM_BANK0_GPIOS );
+
+    bool xWas = xLevel[ gpio ];
+    xLevel[ gpio ] = value;
+
+    if( xWas && !value )
+    {
+        prvRaisePinIrq( gpio, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_LEVEL_LOW );
+    }
+    else if( !xWas && value )
+    {
+        prvRaisePinIrq( gpio, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_LEVEL_HIGH );
+    }
+}
+
+bool gpio_get( uint gpio )
+{
+    configASSERT( gpio < NUM_BANK0_GPIOS );
+    return xLevel[ gpio ];
+}
+
+void gpio_pull_up( uint gpio )
+{
+    configASSERT( gpio < NUM_BANK0_GPIOS );
+    xLevel[ gpio ] = true;
+}
+
+void gpio_set_irq_enabled_with_callback( uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback )
+{
+    configASSERT( gpio < NUM_BANK0_GPIOS );
+
+    /* As on the RP2040 there is a single callback shared by all pins. */
+    xIrqCallback = callback;
+
+    if( enabled )
+    {
+        ulIrqEventMask[ gpio ] |= event_mask;
+    }
+    else
+    {
+        ulIrqEventMask[ gpio ] &= ~event_mask;
+    }
+
+    if( xIrqTask == NULL )
+    {
+        xTaskCreate( prvGpioIrqTask, "GPIO IRQ", configMINIMAL_STACK_SIZE, NULL,
+                     GPIO_IRQ_TASK_PRIORITY, &xIrqTask );
+    }
+}
@@ -0,0 +1,156 @@
+/*
+ * Host implementation of host/gpio_injector.h.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+#include "gpio_internal.h"
+
+/* One edge per microsecond, the resolution of the edge times */
+#define injectorMAX_RATE_HZ     1000000u
+
+static host_gpio_injector_config_t xConfig;
+static bool xConfigured = false;
+static volatile uint64_t ullEdges = 0;
+
+static uint32_t prvEnvU32( const char *pcName, uint32_t ulDefault )
+{
+    const char *pcValue = getenv( pcName );
+    return ( pcValue != NULL ) ? ( uint32_t ) strtoul( pcValue, NULL, 0 ) : ulDefault;
+}
+
+void host_gpio_injector_config_from_env( host_gpio_injector_config_t *config )
+{
+    const char *pcMode = getenv( "HOST_GPIO_IRQ_MODE" );
+
+    config->mode = HOST_GPIO_INJECT_NONE;
+    if( pcMode != NULL )
+    {
+        if( strcmp( pcMode, "fixed" ) == 0 )        config->mode = HOST_GPIO_INJECT_FIXED;
+        else if( strcmp( pcMode, "poisson" ) == 0 ) config->mode = HOST_GPIO_INJECT_POISSON;
+        else if( strcmp( pcMode, "burst" ) == 0 )   config->mode = HOST_GPIO_INJECT_BURST;
+        else printf( "HOST_GPIO_IRQ_MODE '%s' unknown, using stdin\r\n", pcMode );
+    }
+    config->rate_hz = prvEnvU32( "HOST_GPIO_IRQ_RATE", 1000 );
+    if( ( config->rate_hz == 0 ) || ( config->rate_hz > injectorMAX_RATE_HZ ) )
+    {
+        printf( "HOST_GPIO_IRQ_RATE %lu not in 1..%lu, using 1000\r\n", ( unsigned long ) config->rate_hz,
+                ( unsigned long ) injectorMAX_RATE_HZ );
+        config->rate_hz = 1000;
+    }
+    config->burst_len = prvEnvU32( "HOST_GPIO_IRQ_BURST", 10 );
+    config->duration_ms = prvEnvU32( "HOST_GPIO_IRQ_DURATION_MS", 0 );
+}
+
+void host_gpio_injector_configure( const host_gpio_injector_config_t *config )
+{
+    xConfig = *config;
+    xConfigured = true;
+}
+
+const host_gpio_injector_config_t *host_gpio_injector_config( void )
+{
+    if( !xConfigured )
+    {
+        host_gpio_injector_config_from_env( &xConfig );
+        xConfigured = true;
+    }
+    return &xConfig;
+}
+
+uint64_t host_gpio_injector_edges( void )
+{
+    return ullEdges;
+}
+
+/* xorshift64, the injector must not disturb the examples' own rand() sequence. */
+static double prvUniform( void )
+{
+    static uint64_t ullState = 0;
+    if( ullState == 0 )
+    {
+        ullState = time_us_64() | 1;
+    }
+    ullState ^= ullState << 13;
+    ullState ^= ullState >> 7;
+    ullState ^= ullState << 17;
+    /* (0, 1], so log() below never sees 0 */
+    return ( ( ullState >> 11 ) + 1 ) * ( 1.0 / 9007199254740992.0 );
+}
+
+/* Microseconds from one edge to the next, fractional so that the average
+rate comes out exact. Only the edges within a burst are less than 1 us apart,
+so the catch-up loop in host_gpio_injector_run() always moves on. */
+static double prvNextGapUs( const host_gpio_injector_config_t *config, uint32_t *pulInBurst )
+{
+    const double dMeanUs = 1e6 / config->rate_hz;
+
+    switch( config->mode )
+    {
+        case HOST_GPIO_INJECT_POISSON:
+            return fmax( -log( prvUniform() ) * dMeanUs, 1.0 );
+
+        case HOST_GPIO_INJECT_BURST:
+            /* burst_len edges back to back, then a gap that keeps the average rate */
+            if( ++( *pulInBurst ) < config->burst_len )
+            {
+                return 0;
+            }
+            *pulInBurst = 0;
+            return fmax( dMeanUs * config->burst_len, 1.0 );
+
+        case HOST_GPIO_INJECT_FIXED:
+        default:
+            return fmax( dMeanUs, 1.0 );
+    }
+}
+
+void host_gpio_injector_run( const host_gpio_injector_config_t *config )
+{
+    static const char *pcModeNames[] = { "stdin", "fixed", "poisson", "burst" };
+    const uint64_t ullStartUs = time_us_64();
+    const uint64_t ullEndUs = ullStartUs + ( uint64_t ) config->duration_ms * 1000u;
+    const uint64_t ullUsPerTick = 1000000u / configTICK_RATE_HZ;
+    double dNextUs = 0.0;               /* From ullStartUs, small enough to keep the fractions */
+    uint64_t ullNextUs;
+    uint64_t ullNowUs;
+    uint32_t ulInBurst = 0;
+
+    configASSERT( ( config->rate_hz > 0 ) && ( config->rate_hz <= injectorMAX_RATE_HZ ) );
+    configASSERT( config->burst_len > 0 );
+
+    printf( "gpio injector: %s, %lu edges/s, burst %lu, %lu ms\r\n", pcModeNames[ config->mode ],
+            ( unsigned long ) config->rate_hz, ( unsigned long ) config->burst_len,
+            ( unsigned long ) config->duration_ms );
+
+    for( ;; )
+    {
+        ullNowUs = time_us_64();
+
+        if( ( config->duration_ms != 0 ) && ( ullNowUs >= ullEndUs ) )
+        {
+            printf( "gpio injector: %llu edges in %llu us\r\n", ( unsigned long long ) ullEdges,
+                    ( unsigned long long ) ( ullNowUs - ullStartUs ) );
+            exit( EXIT_SUCCESS );
+        }
+
+        /* Deliver every edge that has come due since the last tick. */
+        while( dNextUs <= ( double ) ( ullNowUs - ullStartUs ) )
+        {
+            host_gpio_raise_irq( GPIO_IRQ_EDGE_FALL | GPIO_IRQ_LEVEL_LOW );
+            ullEdges++;
+            dNextUs += prvNextGapUs( config, &ulInBurst );
+        }
+        ullNextUs = ullStartUs + ( uint64_t ) ceil( dNextUs );
+
+        /* Sleep until the tick the next edge falls in. */
+        vTaskDelay( ( TickType_t ) ( ( ullNextUs - ullNowUs + ullUsPerTick - 1 ) / ullUsPerTick ) );
+    }
+}
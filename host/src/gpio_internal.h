@@ -0,0 +1,21 @@
+/*
+ * Shared between gpio.c and gpio_injector.c, not part of the shim's API.
+ */
+
+#ifndef _HOST_GPIO_INTERNAL_H
+#define _HOST_GPIO_INTERNAL_H
+
+#include <stdint.h>
+#include "host/gpio_injector.h"
+
+/* Runs the callback for every pin listening to one of ulEvents. Only call
+from the "GPIO IRQ" task. */
+void host_gpio_raise_irq(uint32_t ulEvents);
+
+/* The configuration the "GPIO IRQ" task will run with. */
+const host_gpio_injector_config_t *host_gpio_injector_config(void);
+
+/* Body of the "GPIO IRQ" task when injecting, never returns. */
+void host_gpio_injector_run(const host_gpio_injector_config_t *config);
+
+#endif
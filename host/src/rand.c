@@ -0,0 +1,32 @@
+/*
+ * Host implementation of the pico/rand.h stand-in. Not cryptographic, but the
+ * examples only use it to pick delays.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pico/rand.h"
+
+static void prvSeed(void)
+{
+    static int seeded = 0;
+    if (!seeded)
+    {
+        srandom((unsigned int)time(NULL) ^ (unsigned int)getpid());
+        seeded = 1;
+    }
+}
+
+uint32_t get_rand_32(void)
+{
+    prvSeed();
+    /* random() only yields 31 bits */
+    return ((uint32_t)random() << 16) ^ (uint32_t)random();
+}
+
+uint64_t get_rand_64(void)
+{
+    return ((uint64_t)get_rand_32() << 32) | get_rand_32();
+}
@@ -0,0 +1,43 @@
+/*
+ * Host implementation of the pico/stdlib.h and pico/time.h stand-ins.
+ */
+
+#include <errno.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico/stdlib.h"
+
+bool stdio_init_all(void)
+{
+    /* Unbuffered stdout so output interleaves like it does over USB CDC. */
+    setvbuf(stdout, NULL, _IONBF, 0);
+    return true;
+}
+
+uint64_t time_us_64(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+void sleep_us(uint64_t us)
+{
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+    {
+        /* Round up so a short sleep still yields at least one tick. */
+        vTaskDelay((TickType_t)((us * configTICK_RATE_HZ + 999999u) / 1000000u));
+        return;
+    }
+
+    struct timespec ts = { (time_t)(us / 1000000u), (long)(us % 1000000u) * 1000 };
+    /* The POSIX port's tick signal interrupts nanosleep, carry on with what is left. */
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {}
+}
+
+void sleep_ms(uint32_t ms)
+{
+    sleep_us((uint64_t)ms * 1000u);
+}
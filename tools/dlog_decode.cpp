@@ -0,0 +1,253 @@
+/*
+ * Formats a binary dump written by "Mastering the FreeRTOS Kernel/common/dlog.h"
+ * on the PC.
+ *
+ *      objcopy -O binary --only-section=dlog_fmt <example>.elf fmt.bin
+ *      dlog_decode fmt.bin dump.bin
+ *
+ * Every record is printed as "[core] timestamp_us: text". The conversions
+ * printf() supports for integers are reproduced with the target's sizes; "%s"
+ * arguments point into the target's memory and are printed as addresses.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ARGS 4
+
+typedef struct
+{
+    char cMagic[ 4 ];
+    uint8_t ucPointerSize;
+    uint8_t ucMaxArgs;
+    uint16_t usRecordSize;
+} DumpHeader_t;
+
+static char *prvReadFile( const char *pcPath, size_t *pxLength )
+{
+    FILE *pxFile = fopen( pcPath, "rb" );
+    char *pcData;
+    long lLength;
+
+    if( pxFile == NULL )
+    {
+        perror( pcPath );
+        exit( EXIT_FAILURE );
+    }
+    fseek( pxFile, 0, SEEK_END );
+    lLength = ftell( pxFile );
+    fseek( pxFile, 0, SEEK_SET );
+
+    /* One extra zero, so a truncated section still ends in a terminator */
+    pcData = ( char * ) calloc( 1, ( size_t ) lLength + 1 );
+    if( ( pcData == NULL ) || ( fread( pcData, 1, ( size_t ) lLength, pxFile ) != ( size_t ) lLength ) )
+    {
+        fprintf( stderr, "%s: read failed\n", pcPath );
+        exit( EXIT_FAILURE );
+    }
+    fclose( pxFile );
+
+    *pxLength = ( size_t ) lLength;
+    return pcData;
+}
+
+/* Little endian, both the RP2040 and the host build */
+static uint64_t prvReadLE( const uint8_t *pucData, size_t xSize )
+{
+    uint64_t ullValue = 0;
+    for( size_t i = 0; i < xSize; i++ )
+    {
+        ullValue |= ( uint64_t ) pucData[ i ] << ( 8 * i );
+    }
+    return ullValue;
+}
+
+/* Width in bytes of an integer conversion on the target, from its length modifier */
+static size_t prvArgumentSize( const char *pcLength, size_t xPointerSize )
+{
+    if( ( strcmp( pcLength, "ll" ) == 0 ) || ( strcmp( pcLength, "j" ) == 0 ) )
+    {
+        return 8;
+    }
+    if( ( strcmp( pcLength, "l" ) == 0 ) || ( strcmp( pcLength, "z" ) == 0 ) || ( strcmp( pcLength, "t" ) == 0 ) )
+    {
+        return xPointerSize;
+    }
+    if( strcmp( pcLength, "hh" ) == 0 )
+    {
+        return 1;
+    }
+    if( strcmp( pcLength, "h" ) == 0 )
+    {
+        return 2;
+    }
+    return 4;
+}
+
+/* Formats one record the way printf() on the target would have. */
+static void prvFormat( const char *pcFormat, const uint64_t *pullArgs, uint32_t ulArgCount,
+                       size_t xPointerSize )
+{
+    const char *pc = pcFormat;
+    uint32_t ulArg = 0;
+
+    while( *pc != '\0' )
+    {
+        char cSpec[ 32 ];
+        char cLength[ 3 ] = { 0 };
+        const char *pcStart = pc;
+        size_t xSpecLength;
+        uint64_t ullValue;
+        size_t xSize;
+
+        if( *pc != '%' )
+        {
+            putchar( *pc++ );
+            continue;
+        }
+        pc++;
+        if( *pc == '%' )
+        {
+            putchar( '%' );
+            pc++;
+            continue;
+        }
+
+        /* Flags, width and precision are passed on as they are, '*' is not supported */
+        pc += strspn( pc, "-+ #0123456789." );
+        xSpecLength = ( size_t ) ( pc - pcStart );
+        while( ( strchr( "hljzt", *pc ) != NULL ) && ( *pc != '\0' ) && ( strlen( cLength ) < 2 ) )
+        {
+            cLength[ strlen( cLength ) ] = *pc++;
+        }
+
+        if( ( *pc == '\0' ) || ( xSpecLength + 3 > sizeof( cSpec ) ) )
+        {
+            fputs( pcStart, stdout );
+            return;
+        }
+        if( ulArg >= ulArgCount )
+        {
+            printf( "<missing argument>" );
+            pc++;
+            continue;
+        }
+
+        memcpy( cSpec, pcStart, xSpecLength );
+        ullValue = pullArgs[ ulArg++ ];
+        xSize = prvArgumentSize( cLength, xPointerSize );
+        if( xSize < 8 )
+        {
+            ullValue &= ( 1ull << ( 8 * xSize ) ) - 1;
+        }
+
+        switch( *pc )
+        {
+            case 'd':
+            case 'i':
+            {
+                int64_t llValue = ( int64_t ) ullValue;
+                if( ( xSize < 8 ) && ( ullValue & ( 1ull << ( 8 * xSize - 1 ) ) ) )
+                {
+                    llValue = ( int64_t ) ( ullValue | ~( ( 1ull << ( 8 * xSize ) ) - 1 ) );
+                }
+                strcpy( &cSpec[ xSpecLength ], "lld" );
+                printf( cSpec, ( long long ) llValue );
+                break;
+            }
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                cSpec[ xSpecLength ] = 'l';
+                cSpec[ xSpecLength + 1 ] = 'l';
+                cSpec[ xSpecLength + 2 ] = *pc;
+                cSpec[ xSpecLength + 3 ] = '\0';
+                printf( cSpec, ( unsigned long long ) ullValue );
+                break;
+            case 'c':
+                strcpy( &cSpec[ xSpecLength ], "c" );
+                printf( cSpec, ( int ) ullValue );
+                break;
+            case 'p':
+                printf( "0x%0*llx", ( int ) xPointerSize * 2, ( unsigned long long ) ullValue );
+                break;
+            case 's':
+                printf( "<str@0x%0*llx>", ( int ) xPointerSize * 2, ( unsigned long long ) ullValue );
+                break;
+            default:
+                /* Floating point never makes it into a record, see dlog.h */
+                printf( "<%%%c?>", *pc );
+                break;
+        }
+        pc++;
+    }
+}
+
+int main( int argc, char **argv )
+{
+    size_t xFormatsLength, xDumpLength, xOffset;
+    const char *pcFormats;
+    const uint8_t *pucDump;
+    DumpHeader_t xHeader;
+    uint64_t ullArgs[ MAX_ARGS ];
+
+    if( argc != 3 )
+    {
+        fprintf( stderr, "usage: %s <fmt.bin> <dump.bin>\n", argv[ 0 ] );
+        return EXIT_FAILURE;
+    }
+    pcFormats = prvReadFile( argv[ 1 ], &xFormatsLength );
+    pucDump = ( const uint8_t * ) prvReadFile( argv[ 2 ], &xDumpLength );
+
+    if( xDumpLength < sizeof( xHeader ) )
+    {
+        fprintf( stderr, "%s: too short for a dump header\n", argv[ 2 ] );
+        return EXIT_FAILURE;
+    }
+    memcpy( xHeader.cMagic, pucDump, 4 );
+    xHeader.ucPointerSize = pucDump[ 4 ];
+    xHeader.ucMaxArgs = pucDump[ 5 ];
+    xHeader.usRecordSize = ( uint16_t ) prvReadLE( &pucDump[ 6 ], 2 );
+
+    if( ( memcmp( xHeader.cMagic, "DLG1", 4 ) != 0 ) || ( xHeader.ucMaxArgs > MAX_ARGS ) ||
+        ( ( xHeader.ucPointerSize != 4 ) && ( xHeader.ucPointerSize != 8 ) ) ||
+        ( xHeader.usRecordSize < 8 + xHeader.ucPointerSize * xHeader.ucMaxArgs ) )
+    {
+        fprintf( stderr, "%s: not a dlog dump\n", argv[ 2 ] );
+        return EXIT_FAILURE;
+    }
+
+    /* DlogRecord_t: timestamp, format ID, argument count, core, then the
+    arguments, which start 8 bytes in for both 4 and 8 byte pointers. */
+    for( xOffset = sizeof( xHeader ); xOffset + xHeader.usRecordSize <= xDumpLength;
+         xOffset += xHeader.usRecordSize )
+    {
+        const uint8_t *pucRecord = &pucDump[ xOffset ];
+        const uint32_t ulTimestampUs = ( uint32_t ) prvReadLE( &pucRecord[ 0 ], 4 );
+        const uint16_t usFormatId = ( uint16_t ) prvReadLE( &pucRecord[ 4 ], 2 );
+        const uint32_t ulArgCount = pucRecord[ 6 ];
+
+        for( uint32_t i = 0; i < xHeader.ucMaxArgs; i++ )
+        {
+            ullArgs[ i ] = prvReadLE( &pucRecord[ 8 + i * xHeader.ucPointerSize ], xHeader.ucPointerSize );
+        }
+
+        printf( "[%u] %10lu: ", pucRecord[ 7 ], ( unsigned long ) ulTimestampUs );
+        if( usFormatId >= xFormatsLength )
+        {
+            printf( "<unknown format %u>\n", usFormatId );
+            continue;
+        }
+        prvFormat( &pcFormats[ usFormatId ], ullArgs, ( ulArgCount < xHeader.ucMaxArgs ) ? ulArgCount : xHeader.ucMaxArgs,
+                   xHeader.ucPointerSize );
+    }
+
+    if( xOffset != xDumpLength )
+    {
+        fprintf( stderr, "%s: %lu trailing bytes ignored\n", argv[ 2 ], ( unsigned long ) ( xDumpLength - xOffset ) );
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+/*
+ * Runs the tick accounting of tickless idle ("Mastering the FreeRTOS
+ * Kernel/common/tickless_step.h") against simulated sleeps, as the host build
+ * has no tickless idle of its own.
+ *
+ *      tickless_sim [sleeps] [seed]
+ *
+ * Every sleep starts at a random point of a tick period with a random expected
+ * idle time, and ends either with the alarm, a few microseconds late, or with
+ * some other interrupt at a random earlier time. After each one the kernel's
+ * tick count is checked against the simulated time: never stepped past the
+ * expected idle time, the next tick on the original grid, and after that tick
+ * the count equal to the ticks that really passed. Prints a summary and exits
+ * with a failure on the first sleep that gets any of it wrong.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tickless_step.h"
+
+#define TICK_US                 1000u
+#define MAX_EXPECTED_IDLE       500u
+#define MAX_WAKE_LATENCY_US     50u
+#define MAX_RESTART_US          20u     /* From the wake to restarting the tick timer */
+#define EARLY_WAKE_PERCENT      30u
+
+static uint32_t ulRandomState;
+
+static uint32_t prvRandom( void )
+{
+    ulRandomState ^= ulRandomState << 13;
+    ulRandomState ^= ulRandomState >> 17;
+    ulRandomState ^= ulRandomState << 5;
+    return ulRandomState;
+}
+
+/* ulLow to ulHigh inclusive */
+static uint32_t prvRandomIn( uint32_t ulLow, uint32_t ulHigh )
+{
+    return ulLow + prvRandom() % ( ulHigh - ulLow + 1u );
+}
+
+int main( int argc, char *argv[] )
+{
+    const unsigned long ulSleeps = ( argc > 1 ) ? strtoul( argv[ 1 ], NULL, 0 ) : 1000000ul;
+    uint64_t ullNowUs = 0, ullTickCount = 0, ullSuppressed = 0;
+    unsigned long ulEarly = 0, ulPended = 0;
+
+    ulRandomState = ( argc > 2 ) ? ( uint32_t ) strtoul( argv[ 2 ], NULL, 0 ) : 0x2545F491u;
+    if( ulRandomState == 0 )
+    {
+        ulRandomState = 1;
+    }
+
+    for( unsigned long i = 0; i < ulSleeps; i++ )
+    {
+        const uint32_t ulExpected = prvRandomIn( 2u, MAX_EXPECTED_IDLE );
+        const uint32_t ulSinceTickUs = ( uint32_t ) ( ullNowUs % TICK_US );
+        const uint64_t ullDueUs = ( ullTickCount + ulExpected ) * TICK_US;
+        uint64_t ullWakeUs, ullRestartUs, ullTickUs;
+        TicklessStep_t xStep;
+
+        if( prvRandomIn( 1u, 100u ) <= EARLY_WAKE_PERCENT )
+        {
+            ullWakeUs = ullNowUs + prvRandom() % ( ullDueUs - ullNowUs );
+            ulEarly++;
+        }
+        else
+        {
+            ullWakeUs = ullDueUs + prvRandomIn( 0u, MAX_WAKE_LATENCY_US );
+        }
+        ullRestartUs = ullWakeUs + prvRandomIn( 1u, MAX_RESTART_US );
+
+        xStep = xTicklessStep( TICK_US, ulSinceTickUs, ullRestartUs - ullNowUs, ulExpected );
+        if( xStep.ulStepTicks > ulExpected - 1u )
+        {
+            fprintf( stderr, "sleep %lu: stepped %lu ticks, expected idle %lu\n", i,
+                     ( unsigned long ) xStep.ulStepTicks, ( unsigned long ) ulExpected );
+            return EXIT_FAILURE;
+        }
+        ullTickCount += xStep.ulStepTicks;
+        ullSuppressed += xStep.ulStepTicks;
+
+        ullTickUs = ullRestartUs + xStep.ulUntilTickUs;
+        if( ( xStep.ulUntilTickUs == 0u ) || ( xStep.ulUntilTickUs > TICK_US ) || ( ( ullTickUs % TICK_US ) != 0u ) )
+        {
+            fprintf( stderr, "sleep %lu: next tick at %llu us, off the %u us grid\n", i,
+                     ( unsigned long long ) ullTickUs, TICK_US );
+            return EXIT_FAILURE;
+        }
+
+        /* The pended tick, then the one the tick timer was restarted for */
+        if( xStep.ulTickPending != 0u )
+        {
+            ullTickCount++;
+            ulPended++;
+        }
+        ullTickCount++;
+        if( ullTickCount != ullTickUs / TICK_US )
+        {
+            fprintf( stderr, "sleep %lu: tick count %llu at %llu us\n", i,
+                     ( unsigned long long ) ullTickCount, ( unsigned long long ) ullTickUs );
+            return EXIT_FAILURE;
+        }
+
+        /* The tasks run for a while before the next sleep */
+        ullNowUs = ullTickUs + prvRandomIn( 0u, TICK_US - 1u );
+    }
+
+    printf( "sleeps,early_wakes,pended_ticks,ticks_suppressed,simulated_s\n" );
+    printf( "%lu,%lu,%lu,%llu,%llu\n", ulSleeps, ulEarly, ulPended, ( unsigned long long ) ullSuppressed,
+            ( unsigned long long ) ( ullNowUs / 1000000u ) );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,452 @@
+/*
+ * Converts xTraceBuffer, dumped from an example built with the trace recorder
+ * ("Mastering the FreeRTOS Kernel/common/trace_recorder.h"), to a Chrome trace
+ * JSON file for chrome://tracing or ui.perfetto.dev.
+ *
+ *      trace_to_chrome trace.bin > trace.json
+ *
+ * The "cores" process has one track per core showing which task ran when.
+ * The "tasks" process has one track per task, with the time it spent blocked
+ * on a queue, semaphore, mutex or event group as slices and every other
+ * kernel event as an instant. Events from ISRs are instants on the core track.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAGIC "TRC1"
+
+/* The event codes of trace_recorder.h */
+enum
+{
+    evTaskCreate = 1,
+    evTaskSwitchedIn,
+    evQueueCreate,
+    evQueueSend,
+    evQueueSendFailed,
+    evQueueSendFromISR,
+    evQueueReceive,
+    evQueueReceiveFailed,
+    evQueueReceiveFromISR,
+    evBlockingOnQueueSend,
+    evBlockingOnQueueReceive,
+    evBlockingOnQueuePeek,
+    evTimerCreate,
+    evTimerCommandSend,
+    evTimerCommandReceived,
+    evTimerExpired,
+    evEventGroupCreate,
+    evEventGroupSyncBlock,
+    evEventGroupSyncEnd,
+    evEventGroupWaitBitsBlock,
+    evEventGroupWaitBitsEnd,
+    evEventGroupClearBits,
+    evEventGroupSetBits,
+    evEventGroupSetBitsFromISR,
+    evEventGroupDelete,
+    evCount
+};
+
+static const char *pcEventNames[ evCount ] =
+{
+    "", "task_create", "switched_in", "create", "send", "send_failed", "send_from_isr",
+    "receive", "receive_failed", "receive_from_isr", "blocked_send", "blocked_receive",
+    "blocked_peek", "create", "command_send", "command_received", "expired", "create",
+    "sync_block", "sync_end", "wait_bits_block", "wait_bits_end", "clear_bits", "set_bits",
+    "set_bits_from_isr", "delete"
+};
+
+typedef struct
+{
+    uint64_t ullTimestampNs;
+    uint8_t ucEvent;
+    uint8_t ucCore;
+    uint16_t usTask;
+    uint32_t ulObject;
+    uint32_t ulArg;
+    uint32_t ulArg2;
+    uint32_t ulSequence;        /* Position in its core's ring, keeps equal timestamps in order */
+} Event_t;
+
+typedef struct
+{
+    uint32_t ulObject;
+    uint8_t ucType;
+    char cName[ 64 ];
+} Object_t;
+
+typedef struct
+{
+    uint32_t ulResolutionNs;
+    uint32_t ulEventsPerCore;
+    uint16_t usCores;
+    uint16_t usMaxTasks;
+    uint16_t usMaxObjects;
+    uint16_t usNameLength;
+    uint16_t usEventSize;
+} Layout_t;
+
+static Object_t *pxObjects;
+static uint32_t ulObjectCount;
+static char ( *pcTaskNames )[ 64 ];
+static uint16_t usTaskNameCount;
+
+/* Little endian, both the RP2040 and the host build */
+static uint64_t prvReadLE( const uint8_t *pucData, size_t xSize )
+{
+    uint64_t ullValue = 0;
+    for( size_t i = 0; i < xSize; i++ )
+    {
+        ullValue |= ( uint64_t ) pucData[ i ] << ( 8 * i );
+    }
+    return ullValue;
+}
+
+static uint8_t *prvReadFile( const char *pcPath, size_t *pxLength )
+{
+    FILE *pxFile = fopen( pcPath, "rb" );
+    uint8_t *pucData;
+    long lLength;
+
+    if( pxFile == NULL )
+    {
+        perror( pcPath );
+        exit( EXIT_FAILURE );
+    }
+    fseek( pxFile, 0, SEEK_END );
+    lLength = ftell( pxFile );
+    fseek( pxFile, 0, SEEK_SET );
+
+    pucData = ( uint8_t * ) malloc( ( size_t ) lLength + 1 );
+    if( ( pucData == NULL ) || ( fread( pucData, 1, ( size_t ) lLength, pxFile ) != ( size_t ) lLength ) )
+    {
+        fprintf( stderr, "%s: read failed\n", pcPath );
+        exit( EXIT_FAILURE );
+    }
+    fclose( pxFile );
+
+    *pxLength = ( size_t ) lLength;
+    return pucData;
+}
+
+/* A name from the target, which may fill its field without a terminator */
+static void prvCopyName( char *pcDest, const uint8_t *pucName, size_t xLength )
+{
+    size_t i;
+    for( i = 0; ( i < xLength ) && ( i < 63 ) && ( pucName[ i ] != '\0' ); i++ )
+    {
+        /* Keep the JSON valid whatever the name holds */
+        pcDest[ i ] = ( ( pucName[ i ] == '"' ) || ( pucName[ i ] == '\\' ) || ( pucName[ i ] < ' ' ) ) ? '_' : ( char ) pucName[ i ];
+    }
+    pcDest[ i ] = '\0';
+}
+
+static const char *prvTypeName( uint8_t ucType )
+{
+    switch( ucType )
+    {
+        case 0: return "queue";
+        case 1: return "mutex";
+        case 2: return "counting_semaphore";
+        case 3: return "binary_semaphore";
+        case 4: return "recursive_mutex";
+        case 16: return "timer";
+        case 17: return "event_group";
+        default: return "object";
+    }
+}
+
+static const char *prvObjectName( uint32_t ulObject )
+{
+    static char cName[ 96 ];
+
+    for( uint32_t i = 0; i < ulObjectCount; i++ )
+    {
+        if( pxObjects[ i ].ulObject == ulObject )
+        {
+            if( pxObjects[ i ].cName[ 0 ] != '\0' )
+            {
+                return pxObjects[ i ].cName;
+            }
+            snprintf( cName, sizeof( cName ), "%s 0x%08lx", prvTypeName( pxObjects[ i ].ucType ),
+                      ( unsigned long ) ulObject );
+            return cName;
+        }
+    }
+    snprintf( cName, sizeof( cName ), "0x%08lx", ( unsigned long ) ulObject );
+    return cName;
+}
+
+static const char *prvTaskName( uint16_t usTask )
+{
+    static char cName[ 32 ];
+
+    if( ( usTask < usTaskNameCount ) && ( pcTaskNames[ usTask ][ 0 ] != '\0' ) )
+    {
+        return pcTaskNames[ usTask ];
+    }
+    snprintf( cName, sizeof( cName ), "task %u", ( unsigned ) usTask );
+    return cName;
+}
+
+static int prvCompareEvents( const void *pvA, const void *pvB )
+{
+    const Event_t *pxA = ( const Event_t * ) pvA;
+    const Event_t *pxB = ( const Event_t * ) pvB;
+
+    if( pxA->ullTimestampNs != pxB->ullTimestampNs )
+    {
+        return ( pxA->ullTimestampNs < pxB->ullTimestampNs ) ? -1 : 1;
+    }
+    if( pxA->ucCore != pxB->ucCore )
+    {
+        return ( pxA->ucCore < pxB->ucCore ) ? -1 : 1;
+    }
+    return ( pxA->ulSequence < pxB->ulSequence ) ? -1 : ( pxA->ulSequence > pxB->ulSequence );
+}
+
+static bool xFirst = true;
+
+/* Starts the next object of the traceEvents array */
+static void prvNext( void )
+{
+    printf( xFirst ? "\n" : ",\n" );
+    xFirst = false;
+}
+
+static void prvSlice( int iPid, uint32_t ulTid, const char *pcName, uint64_t ullStartNs, uint64_t ullEndNs )
+{
+    prvNext();
+    printf( "{\"ph\":\"X\",\"pid\":%d,\"tid\":%lu,\"name\":\"%s\",\"ts\":%.3f,\"dur\":%.3f}", iPid,
+            ( unsigned long ) ulTid, pcName, ullStartNs / 1000.0, ( ullEndNs - ullStartNs ) / 1000.0 );
+}
+
+static void prvInstant( int iPid, uint32_t ulTid, const char *pcName, const char *pcObject,
+                        const Event_t *pxEvent, uint64_t ullTimeNs )
+{
+    prvNext();
+    printf( "{\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%lu,\"name\":\"%s %s\",\"ts\":%.3f,"
+            "\"args\":{\"task\":\"%s\",\"arg\":\"0x%lx\",\"arg2\":\"0x%lx\"}}",
+            iPid, ( unsigned long ) ulTid, pcName, pcObject, ullTimeNs / 1000.0, prvTaskName( pxEvent->usTask ),
+            ( unsigned long ) pxEvent->ulArg, ( unsigned long ) pxEvent->ulArg2 );
+}
+
+static void prvMetadata( int iPid, int64_t llTid, const char *pcWhat, const char *pcName )
+{
+    prvNext();
+    if( llTid < 0 )
+    {
+        printf( "{\"ph\":\"M\",\"pid\":%d,\"name\":\"%s\",\"args\":{\"name\":\"%s\"}}", iPid, pcWhat, pcName );
+    }
+    else
+    {
+        printf( "{\"ph\":\"M\",\"pid\":%d,\"tid\":%lld,\"name\":\"%s\",\"args\":{\"name\":\"%s\"}}", iPid,
+                ( long long ) llTid, pcWhat, pcName );
+    }
+}
+
+int main( int argc, char **argv )
+{
+    const int iCoresPid = 0, iTasksPid = 1;
+    size_t xLength, xEnd;
+    uint8_t *pucDump;
+    Layout_t xLayout;
+    Event_t *pxEvents;
+    uint32_t ulEventCount = 0;
+    uint64_t ullOriginNs;
+
+    if( argc != 2 )
+    {
+        fprintf( stderr, "usage: %s <trace.bin> > trace.json\n", argv[ 0 ] );
+        return EXIT_FAILURE;
+    }
+
+    pucDump = prvReadFile( argv[ 1 ], &xLength );
+    if( ( xLength < 28 ) || ( memcmp( pucDump, MAGIC, 4 ) != 0 ) )
+    {
+        fprintf( stderr, "%s: not a trace recorder dump\n", argv[ 1 ] );
+        return EXIT_FAILURE;
+    }
+
+    /* TraceBuffer_t, field by field, see trace_recorder.h */
+    xLayout.ulResolutionNs = ( uint32_t ) prvReadLE( &pucDump[ 4 ], 4 );
+    xLayout.ulEventsPerCore = ( uint32_t ) prvReadLE( &pucDump[ 8 ], 4 );
+    xLayout.usCores = ( uint16_t ) prvReadLE( &pucDump[ 12 ], 2 );
+    xLayout.usMaxTasks = ( uint16_t ) prvReadLE( &pucDump[ 14 ], 2 );
+    xLayout.usMaxObjects = ( uint16_t ) prvReadLE( &pucDump[ 16 ], 2 );
+    xLayout.usNameLength = ( uint16_t ) prvReadLE( &pucDump[ 18 ], 2 );
+    xLayout.usEventSize = ( uint16_t ) prvReadLE( &pucDump[ 20 ], 2 );
+    ulObjectCount = ( uint32_t ) prvReadLE( &pucDump[ 24 ], 4 );
+
+    const size_t xObjectSize = 8 + xLayout.usNameLength;
+    const size_t xObjectsOffset = 28;
+    const size_t xNamesOffset = xObjectsOffset + xLayout.usMaxObjects * xObjectSize;
+    /* TraceCore_t starts with a uint64_t, so it is 8 byte aligned */
+    const size_t xCoresOffset = ( xNamesOffset + ( size_t ) xLayout.usMaxTasks * xLayout.usNameLength + 7 ) & ~( size_t ) 7;
+    const size_t xCoreSize = 8 + ( size_t ) xLayout.ulEventsPerCore * xLayout.usEventSize;
+
+    xEnd = xCoresOffset + xLayout.usCores * xCoreSize;
+    if( ( xLayout.usEventSize != 24 ) || ( ulObjectCount > xLayout.usMaxObjects ) || ( xEnd > xLength ) )
+    {
+        fprintf( stderr, "%s: truncated or from an incompatible recorder (%zu bytes, expected %zu)\n", argv[ 1 ],
+                 xLength, xEnd );
+        return EXIT_FAILURE;
+    }
+
+    pxObjects = ( Object_t * ) calloc( ulObjectCount + 1, sizeof( Object_t ) );
+    for( uint32_t i = 0; i < ulObjectCount; i++ )
+    {
+        const uint8_t *pucObject = &pucDump[ xObjectsOffset + i * xObjectSize ];
+        pxObjects[ i ].ulObject = ( uint32_t ) prvReadLE( pucObject, 4 );
+        pxObjects[ i ].ucType = pucObject[ 4 ];
+        prvCopyName( pxObjects[ i ].cName, &pucObject[ 8 ], xLayout.usNameLength );
+    }
+
+    usTaskNameCount = xLayout.usMaxTasks;
+    pcTaskNames = ( char ( * )[ 64 ] ) calloc( usTaskNameCount + 1, 64 );
+    for( uint16_t i = 0; i < usTaskNameCount; i++ )
+    {
+        prvCopyName( pcTaskNames[ i ], &pucDump[ xNamesOffset + ( size_t ) i * xLayout.usNameLength ],
+                     xLayout.usNameLength );
+    }
+
+    /* Each ring from its oldest event, then all cores merged by time */
+    pxEvents = ( Event_t * ) calloc( ( size_t ) xLayout.usCores * xLayout.ulEventsPerCore + 1, sizeof( Event_t ) );
+    for( uint16_t usCore = 0; usCore < xLayout.usCores; usCore++ )
+    {
+        const uint8_t *pucCore = &pucDump[ xCoresOffset + usCore * xCoreSize ];
+        const uint32_t ulWritten = ( uint32_t ) prvReadLE( pucCore, 4 );
+        const uint32_t ulCount = ( ulWritten < xLayout.ulEventsPerCore ) ? ulWritten : xLayout.ulEventsPerCore;
+
+        for( uint32_t i = ulWritten - ulCount; i != ulWritten; i++ )
+        {
+            const uint8_t *pucEvent = &pucCore[ 8 + ( size_t ) ( i % xLayout.ulEventsPerCore ) * xLayout.usEventSize ];
+            Event_t *pxEvent = &pxEvents[ ulEventCount++ ];
+
+            pxEvent->ullTimestampNs = prvReadLE( &pucEvent[ 0 ], 8 );
+            pxEvent->ucEvent = pucEvent[ 8 ];
+            pxEvent->ucCore = pucEvent[ 9 ];
+            pxEvent->usTask = ( uint16_t ) prvReadLE( &pucEvent[ 10 ], 2 );
+            pxEvent->ulObject = ( uint32_t ) prvReadLE( &pucEvent[ 12 ], 4 );
+            pxEvent->ulArg = ( uint32_t ) prvReadLE( &pucEvent[ 16 ], 4 );
+            pxEvent->ulArg2 = ( uint32_t ) prvReadLE( &pucEvent[ 20 ], 4 );
+            pxEvent->ulSequence = i - ( ulWritten - ulCount );
+        }
+    }
+    qsort( pxEvents, ulEventCount, sizeof( Event_t ), prvCompareEvents );
+
+    if( ulEventCount == 0 )
+    {
+        fprintf( stderr, "%s: no events recorded\n", argv[ 1 ] );
+        return EXIT_FAILURE;
+    }
+    ullOriginNs = pxEvents[ 0 ].ullTimestampNs;
+
+    printf( "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"resolution_ns\":%lu},\"traceEvents\":[",
+            ( unsigned long ) xLayout.ulResolutionNs );
+
+    prvMetadata( iCoresPid, -1, "process_name", "cores" );
+    prvMetadata( iTasksPid, -1, "process_name", "tasks" );
+    for( uint16_t usCore = 0; usCore < xLayout.usCores; usCore++ )
+    {
+        char cName[ 16 ];
+        snprintf( cName, sizeof( cName ), "core %u", ( unsigned ) usCore );
+        prvMetadata( iCoresPid, usCore, "thread_name", cName );
+    }
+
+    {
+        /* What runs on each core since when, and what each task blocks on since when */
+        uint16_t *pusRunning = ( uint16_t * ) calloc( xLayout.usCores, sizeof( uint16_t ) );
+        uint64_t *pullRunningSince = ( uint64_t * ) calloc( xLayout.usCores, sizeof( uint64_t ) );
+        bool *pxHasRunning = ( bool * ) calloc( xLayout.usCores, sizeof( bool ) );
+        const uint32_t ulMaxTask = 65536;
+        uint32_t *pulBlockedOn = ( uint32_t * ) calloc( ulMaxTask, sizeof( uint32_t ) );
+        uint64_t *pullBlockedSince = ( uint64_t * ) calloc( ulMaxTask, sizeof( uint64_t ) );
+        bool *pxBlocked = ( bool * ) calloc( ulMaxTask, sizeof( bool ) );
+        bool *pxNamed = ( bool * ) calloc( ulMaxTask, sizeof( bool ) );
+
+        for( uint32_t i = 0; i < ulEventCount; i++ )
+        {
+            const Event_t *pxEvent = &pxEvents[ i ];
+            const uint64_t ullTimeNs = pxEvent->ullTimestampNs - ullOriginNs;
+            const uint16_t usCore = ( pxEvent->ucCore < xLayout.usCores ) ? pxEvent->ucCore : 0;
+            const uint16_t usTask = pxEvent->usTask;
+            const char *pcName = ( pxEvent->ucEvent < evCount ) ? pcEventNames[ pxEvent->ucEvent ] : "unknown";
+
+            if( !pxNamed[ usTask ] )
+            {
+                prvMetadata( iTasksPid, usTask, "thread_name", prvTaskName( usTask ) );
+                pxNamed[ usTask ] = true;
+            }
+
+            switch( pxEvent->ucEvent )
+            {
+                case evTaskSwitchedIn:
+                    if( pxHasRunning[ usCore ] && ( pusRunning[ usCore ] == usTask ) )
+                    {
+                        /* Switched back to the task that was already running */
+                        break;
+                    }
+                    if( pxHasRunning[ usCore ] )
+                    {
+                        prvSlice( iCoresPid, usCore, prvTaskName( pusRunning[ usCore ] ), pullRunningSince[ usCore ], ullTimeNs );
+                        prvSlice( iTasksPid, pusRunning[ usCore ], "running", pullRunningSince[ usCore ], ullTimeNs );
+                    }
+                    pusRunning[ usCore ] = usTask;
+                    pullRunningSince[ usCore ] = ullTimeNs;
+                    pxHasRunning[ usCore ] = true;
+
+                    if( pxBlocked[ usTask ] )
+                    {
+                        char cName[ 128 ];
+                        snprintf( cName, sizeof( cName ), "blocked on %s", prvObjectName( pulBlockedOn[ usTask ] ) );
+                        prvSlice( iTasksPid, usTask, cName, pullBlockedSince[ usTask ], ullTimeNs );
+                        pxBlocked[ usTask ] = false;
+                    }
+                    break;
+
+                case evBlockingOnQueueSend:
+                case evBlockingOnQueueReceive:
+                case evBlockingOnQueuePeek:
+                case evEventGroupSyncBlock:
+                case evEventGroupWaitBitsBlock:
+                    pulBlockedOn[ usTask ] = pxEvent->ulObject;
+                    pullBlockedSince[ usTask ] = ullTimeNs;
+                    pxBlocked[ usTask ] = true;
+                    break;
+
+                case evTaskCreate:
+                    prvInstant( iTasksPid, usTask, pcName, prvTaskName( ( uint16_t ) pxEvent->ulArg ), pxEvent, ullTimeNs );
+                    break;
+
+                case evQueueSendFromISR:
+                case evQueueReceiveFromISR:
+                case evEventGroupSetBitsFromISR:
+                    prvInstant( iCoresPid, usCore, pcName, prvObjectName( pxEvent->ulObject ), pxEvent, ullTimeNs );
+                    break;
+
+                default:
+                    prvInstant( iTasksPid, usTask, pcName, prvObjectName( pxEvent->ulObject ), pxEvent, ullTimeNs );
+                    break;
+            }
+        }
+
+        /* Close what is still running at the last event */
+        for( uint16_t usCore = 0; usCore < xLayout.usCores; usCore++ )
+        {
+            if( pxHasRunning[ usCore ] )
+            {
+                const uint64_t ullEndNs = pxEvents[ ulEventCount - 1 ].ullTimestampNs - ullOriginNs;
+                prvSlice( iCoresPid, usCore, prvTaskName( pusRunning[ usCore ] ), pullRunningSince[ usCore ], ullEndNs );
+                prvSlice( iTasksPid, pusRunning[ usCore ], "running", pullRunningSince[ usCore ], ullEndNs );
+            }
+        }
+    }
+
+    printf( "\n]}\n" );
+    fprintf( stderr, "%lu events, %lu cores, %lu ns resolution\n", ( unsigned long ) ulEventCount,
+             ( unsigned long ) xLayout.usCores, ( unsigned long ) xLayout.ulResolutionNs );
+    return EXIT_SUCCESS;
+}